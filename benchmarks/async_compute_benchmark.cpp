@@ -0,0 +1,179 @@
+// Runs the same frame twice on a headless device: a compute job handed to LveComputeScheduler, and graphics-queue
+// work that stands in for the frame's rendering, with the graphics submission waiting on the compute at the
+// compute shader stage. First with the scheduler forced onto the graphics queue, then on the dedicated compute
+// family when the device has one. Prints average GPU time of both parts and how much of the compute overlapped
+// graphics, measured with timestamps.
+// Usage: async_compute_benchmark [frames] [computeIterations] [graphicsIterations]
+
+#include "../lve_buffer.hpp"
+#include "../lve_compute_scheduler.hpp"
+#include "../lve_descriptors.hpp"
+#include "../lve_device.hpp"
+#include "../lve_pipeline_registry.hpp"
+#include "../lve_renderer.hpp"
+#include "../lve_renderer_config.hpp"
+
+// std
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace lve;
+
+	constexpr uint32_t ELEMENTS = 256 * 1024;
+	constexpr uint32_t WORKGROUP_SIZE = 64;
+
+	class ComputeLoad {
+	public:
+		ComputeLoad(LveDevice& device, LvePipelineRegistry& registry) : device{ device } {
+			setLayout = LveDescriptorSetLayout::Builder(device)
+				.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+				.build();
+			pool = LveDescriptorPool::Builder(device)
+				.setMaxSets(2 * LveRendererConfig::MAX_FRAMES_IN_FLIGHT)
+				.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * LveRendererConfig::MAX_FRAMES_IN_FLIGHT)
+				.build();
+
+			VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t) };
+			VkDescriptorSetLayout layout = setLayout->getDescriptorSetLayout();
+			VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+			pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			pipelineLayoutInfo.setLayoutCount = 1;
+			pipelineLayoutInfo.pSetLayouts = &layout;
+			pipelineLayoutInfo.pushConstantRangeCount = 1;
+			pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+			if (vkCreatePipelineLayout(device.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create pipeline layout!");
+			}
+
+			shader = registry.getShaderModule("shaders/compute_load.comp.spv");
+			VkComputePipelineCreateInfo pipelineInfo{};
+			pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			pipelineInfo.stage.module = shader->getShaderModule();
+			pipelineInfo.stage.pName = "main";
+			pipelineInfo.layout = pipelineLayout;
+			if (vkCreateComputePipelines(device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create compute pipeline!");
+			}
+		}
+
+		~ComputeLoad() {
+			vkDestroyPipeline(device.device(), pipeline, nullptr);
+			vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+		}
+
+		VkDescriptorSet createSet(LveBuffer& buffer) {
+			VkDescriptorSet set;
+			auto bufferInfo = buffer.descriptorInfo();
+			if (!LveDescriptorWriter(*setLayout, *pool).writeBuffer(0, &bufferInfo).build(set)) {
+				throw std::runtime_error("failed to allocate descriptor set!");
+			}
+			return set;
+		}
+
+		void dispatch(VkCommandBuffer commandBuffer, VkDescriptorSet set, uint32_t iterations) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &set, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &iterations);
+			vkCmdDispatch(commandBuffer, ELEMENTS / WORKGROUP_SIZE, 1, 1);
+		}
+
+	private:
+		LveDevice& device;
+		std::unique_ptr<LveDescriptorSetLayout> setLayout;
+		std::unique_ptr<LveDescriptorPool> pool;
+		std::shared_ptr<LveShaderModule> shader;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+	};
+
+	void runMode(
+		const std::string& mode,
+		LveDevice& device,
+		LveRenderer& renderer,
+		ComputeLoad& load,
+		bool allowDedicatedQueue,
+		int frames,
+		uint32_t computeIterations,
+		uint32_t graphicsIterations) {
+		LveComputeScheduler scheduler{ device, allowDedicatedQueue };
+
+		// per frame slot, so a slot's compute never overwrites data an older frame still reads. Graphics consumes
+		// the compute output in place, the way a culling or binning result would be read by the frame
+		std::vector<std::unique_ptr<LveBuffer>> buffers{};
+		std::vector<VkDescriptorSet> sets{};
+		for (uint32_t i = 0; i < LveRendererConfig::MAX_FRAMES_IN_FLIGHT; i++) {
+			buffers.push_back(std::make_unique<LveBuffer>(
+				device, sizeof(float) * 4, ELEMENTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+			sets.push_back(load.createSet(*buffers.back()));
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		int rendered = 0;
+		while (rendered < frames) {
+			auto commandBuffer = renderer.beginFrame();
+			if (!commandBuffer) continue;
+			int frameIndex = renderer.getFrameIndex();
+
+			scheduler.beginFrame(frameIndex);
+			scheduler.addJob([&, frameIndex](VkCommandBuffer computeCommandBuffer) {
+				load.dispatch(computeCommandBuffer, sets[frameIndex], computeIterations);
+			});
+			// the load shader writes its results back, so graphics needs write access as well
+			scheduler.releaseBuffer(
+				buffers[frameIndex]->getBuffer(),
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+			scheduler.submit(renderer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+			scheduler.beginGraphics(commandBuffer);
+			load.dispatch(commandBuffer, sets[frameIndex], graphicsIterations);
+			renderer.beginSwapChainRenderPass(commandBuffer);
+			renderer.endSwapChainRenderPass(commandBuffer);
+			scheduler.endGraphics(commandBuffer);
+			renderer.endFrame();
+			rendered++;
+		}
+		vkDeviceWaitIdle(device.device());
+		double cpuFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+		const auto& stats = scheduler.getStats();
+		std::cout << mode << "," << (scheduler.isAsync() ? "compute" : "graphics") << "," << stats.frames << ","
+			<< stats.computeMs << "," << stats.graphicsMs << "," << stats.overlapMs << ","
+			<< stats.overlapFraction() * 100.0 << "," << cpuFrameMs << std::endl;
+	}
+}
+
+int main(int argc, char** argv) {
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 300;
+	const uint32_t computeIterations = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 256;
+	const uint32_t graphicsIterations = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 512;
+
+	try {
+		LveDevice device{ nullptr };
+		LveRenderer renderer{ device, { 1280, 720 }, LveRendererConfig{} };
+		LvePipelineRegistry registry{ device };
+		ComputeLoad load{ device, registry };
+
+		std::cout << "mode,queue,frames,compute_ms,graphics_ms,overlap_ms,overlap_pct,cpu_frame_ms" << std::endl;
+		runMode("fallback", device, renderer, load, false, frames, computeIterations, graphicsIterations);
+		if (device.hasDedicatedComputeQueue()) {
+			runMode("async", device, renderer, load, true, frames, computeIterations, graphicsIterations);
+		}
+		else {
+			std::cerr << "no compute-only queue family; async mode skipped" << std::endl;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
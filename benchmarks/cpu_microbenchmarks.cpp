@@ -0,0 +1,329 @@
+// Microbenchmarks for CPU hot paths that need no GPU: TransformComponent::mat4/normalMatrix, LveCamera view and
+// projection setup, LveModel::Builder::loadModel on generated and bundled OBJ files, vertex hashing with
+// hashCombine and PointLightSystem's distance sort. Each kernel runs at several sizes; iteration counts grow until
+// a run takes at least --min-time seconds. JSON output follows Google Benchmark's schema, so its compare.py can
+// diff two runs.
+// Usage: cpu_microbenchmarks [--filter=substring] [--format=csv|json] [--min-time=seconds] [--models=dir]
+
+#include "../lve_camera.hpp"
+#include "../lve_game_object.hpp"
+#include "../lve_model.hpp"
+#include "../lve_utils.hpp"
+#include "../point_light_system.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace lve;
+
+	// keeps the compiler from discarding a result the benchmark never reads
+	template <typename T>
+	void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		static const void* volatile sink;
+		sink = &value;
+#endif
+	}
+
+	class BenchmarkState {
+	public:
+		BenchmarkState(int64_t range, uint64_t iterations) : range{ range }, iterations{ iterations } {}
+
+		// loop condition of the measured region; setup before the first call is not timed
+		bool keepRunning() {
+			if (!started) {
+				started = true;
+				start = std::chrono::steady_clock::now();
+			}
+			if (completed < iterations) {
+				completed++;
+				return true;
+			}
+			elapsed = std::chrono::steady_clock::now() - start;
+			return false;
+		}
+
+		const int64_t range;
+		const uint64_t iterations;
+		// work items per iteration, reported as items_per_second
+		int64_t itemsPerIteration = 0;
+		std::chrono::steady_clock::duration elapsed{};
+
+	private:
+		bool started = false;
+		uint64_t completed = 0;
+		std::chrono::steady_clock::time_point start{};
+	};
+
+	struct Benchmark {
+		std::string name;
+		int64_t range;
+		std::function<void(BenchmarkState& state)> run;
+	};
+
+	struct Result {
+		std::string name;
+		uint64_t iterations;
+		double nsPerIteration;
+		double itemsPerSecond;
+	};
+
+	Result measure(const Benchmark& benchmark, double minSeconds) {
+		uint64_t iterations = 1;
+		while (true) {
+			BenchmarkState state{ benchmark.range, iterations };
+			benchmark.run(state);
+			double seconds = std::chrono::duration<double>(state.elapsed).count();
+			if (seconds >= minSeconds || iterations >= (1ull << 32)) {
+				double nsPerIteration = seconds * 1e9 / iterations;
+				double itemsPerSecond = seconds > 0.0 ? state.itemsPerIteration * static_cast<double>(iterations) / seconds : 0.0;
+				return { benchmark.name + "/" + std::to_string(benchmark.range), iterations, nsPerIteration, itemsPerSecond };
+			}
+			// aim 40% past the target so the next attempt usually suffices, growing at most 10x per step
+			double scale = seconds > 0.0 ? minSeconds * 1.4 / seconds : 10.0;
+			iterations = static_cast<uint64_t>(iterations * std::min(10.0, std::max(scale, 2.0)));
+		}
+	}
+
+	std::vector<TransformComponent> randomTransforms(int64_t count) {
+		std::mt19937 random{ 1 };
+		std::uniform_real_distribution<float> angle{ -glm::pi<float>(), glm::pi<float>() };
+		std::uniform_real_distribution<float> scale{ 0.1f, 3.0f };
+		std::vector<TransformComponent> transforms(static_cast<size_t>(count));
+		for (auto& transform : transforms) {
+			transform.translation = { angle(random), angle(random), angle(random) };
+			transform.rotation = { angle(random), angle(random), angle(random) };
+			transform.scale = { scale(random), scale(random), scale(random) };
+		}
+		return transforms;
+	}
+
+	std::vector<LveModel::Vertex> randomVertices(int64_t count) {
+		std::mt19937 random{ 2 };
+		std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+		std::vector<LveModel::Vertex> vertices(static_cast<size_t>(count));
+		for (auto& vertex : vertices) {
+			vertex.position = { unit(random), unit(random), unit(random) };
+			vertex.color = { unit(random), unit(random), unit(random) };
+			vertex.normal = { unit(random), unit(random), unit(random) };
+			vertex.uv = { unit(random), unit(random) };
+		}
+		return vertices;
+	}
+
+	// a resolution x resolution grid of quads with positions, colors, normals and uvs, split into triangles
+	std::string writeGridObj(int64_t resolution) {
+		auto path = std::filesystem::temp_directory_path() / ("lve_grid_" + std::to_string(resolution) + ".obj");
+		std::ofstream out{ path };
+		for (int64_t z = 0; z <= resolution; z++) {
+			for (int64_t x = 0; x <= resolution; x++) {
+				float u = static_cast<float>(x) / resolution;
+				float v = static_cast<float>(z) / resolution;
+				out << "v " << u << " " << 0.1f * std::sin(10.0f * u) * std::cos(10.0f * v) << " " << v << " "
+					<< u << " " << v << " 0.5\n";
+				out << "vn 0 -1 0\n";
+				out << "vt " << u << " " << v << "\n";
+			}
+		}
+		auto index = [resolution](int64_t x, int64_t z) { return z * (resolution + 1) + x + 1; };
+		auto corner = [](int64_t i) { return std::to_string(i) + "/" + std::to_string(i) + "/" + std::to_string(i); };
+		for (int64_t z = 0; z < resolution; z++) {
+			for (int64_t x = 0; x < resolution; x++) {
+				out << "f " << corner(index(x, z)) << " " << corner(index(x, z + 1)) << " " << corner(index(x + 1, z)) << "\n";
+				out << "f " << corner(index(x + 1, z)) << " " << corner(index(x, z + 1)) << " " << corner(index(x + 1, z + 1)) << "\n";
+			}
+		}
+		if (!out) throw std::runtime_error("failed to write synthetic OBJ file!");
+		return path.string();
+	}
+
+	LveGameObject::Map randomPointLights(int64_t count) {
+		std::mt19937 random{ 3 };
+		std::uniform_real_distribution<float> position{ -10.0f, 10.0f };
+		LveGameObject::Map gameObjects;
+		for (int64_t i = 0; i < count; i++) {
+			auto pointLight = LveGameObject::makePointLight(0.2f);
+			pointLight.transform.translation = { position(random), position(random), position(random) };
+			gameObjects.emplace(pointLight.getId(), std::move(pointLight));
+		}
+		return gameObjects;
+	}
+
+	std::vector<Benchmark> registerBenchmarks(const std::string& modelDirectory) {
+		std::vector<Benchmark> benchmarks{};
+		for (int64_t count : { 64, 1024, 16384 }) {
+			benchmarks.push_back({ "transform_mat4", count, [](BenchmarkState& state) {
+				auto transforms = randomTransforms(state.range);
+				state.itemsPerIteration = state.range;
+				while (state.keepRunning()) {
+					for (auto& transform : transforms) doNotOptimize(transform.mat4());
+				}
+			} });
+			benchmarks.push_back({ "transform_normal_matrix", count, [](BenchmarkState& state) {
+				auto transforms = randomTransforms(state.range);
+				state.itemsPerIteration = state.range;
+				while (state.keepRunning()) {
+					for (auto& transform : transforms) doNotOptimize(transform.normalMatrix());
+				}
+			} });
+		}
+
+		for (int64_t count : { 1, 256 }) {
+			benchmarks.push_back({ "camera_set_view_yxz", count, [](BenchmarkState& state) {
+				auto transforms = randomTransforms(state.range);
+				LveCamera camera{};
+				state.itemsPerIteration = state.range;
+				while (state.keepRunning()) {
+					for (auto& transform : transforms) {
+						camera.setViewYXZ(transform.translation, transform.rotation);
+						doNotOptimize(camera);
+					}
+				}
+			} });
+			benchmarks.push_back({ "camera_set_perspective_projection", count, [](BenchmarkState& state) {
+				LveCamera camera{};
+				state.itemsPerIteration = state.range;
+				while (state.keepRunning()) {
+					for (int64_t i = 0; i < state.range; i++) {
+						camera.setPerspectiveProjection(glm::radians(50.0f), 1.0f + 0.001f * i, 0.1f, 100.0f);
+						doNotOptimize(camera);
+					}
+				}
+			} });
+		}
+
+		for (int64_t resolution : { 16, 128, 512 }) {
+			benchmarks.push_back({ "load_model_synthetic", resolution, [](BenchmarkState& state) {
+				const std::string path = writeGridObj(state.range);
+				LveModel::Builder builder{};
+				state.itemsPerIteration = 2 * state.range * state.range;
+				while (state.keepRunning()) {
+					builder.loadModel(path);
+					doNotOptimize(builder);
+				}
+				std::filesystem::remove(path);
+			} });
+		}
+
+		// the range is the model's index in the list; the name says which file it is
+		const std::vector<std::string> bundled{ "flat_vase.obj", "smooth_vase.obj", "quad.obj" };
+		for (size_t i = 0; i < bundled.size(); i++) {
+			const std::string path = modelDirectory + "/" + bundled[i];
+			if (!std::filesystem::exists(path)) {
+				std::cerr << "skipping load_model_" << bundled[i] << ": " << path << " not found" << std::endl;
+				continue;
+			}
+			benchmarks.push_back({ "load_model_" + bundled[i], static_cast<int64_t>(i), [path](BenchmarkState& state) {
+				LveModel::Builder builder{};
+				while (state.keepRunning()) {
+					builder.loadModel(path);
+					doNotOptimize(builder);
+				}
+			} });
+		}
+
+		for (int64_t count : { 1024, 65536 }) {
+			// the same combination std::hash<LveModel::Vertex> uses in lve_model.cpp
+			benchmarks.push_back({ "vertex_hash_combine", count, [](BenchmarkState& state) {
+				auto vertices = randomVertices(state.range);
+				state.itemsPerIteration = state.range;
+				while (state.keepRunning()) {
+					for (const auto& vertex : vertices) {
+						size_t seed = 0;
+						hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+						doNotOptimize(seed);
+					}
+				}
+			} });
+		}
+
+		for (int64_t count : { 6, 64, 1024 }) {
+			benchmarks.push_back({ "point_light_distance_sort", count, [](BenchmarkState& state) {
+				auto gameObjects = randomPointLights(state.range);
+				const glm::vec3 cameraPosition{ 0.5f, -1.0f, -2.5f };
+				state.itemsPerIteration = state.range;
+				while (state.keepRunning()) {
+					doNotOptimize(PointLightSystem::sortByDistance(gameObjects, cameraPosition));
+				}
+			} });
+		}
+		return benchmarks;
+	}
+
+	void printJson(const std::vector<Result>& results) {
+		std::cout << "{\n  \"context\": { \"executable\": \"cpu_microbenchmarks\" },\n  \"benchmarks\": [";
+		for (size_t i = 0; i < results.size(); i++) {
+			const auto& result = results[i];
+			std::cout << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << result.name << "\", \"run_type\": \"iteration\""
+				<< ", \"iterations\": " << result.iterations << ", \"real_time\": " << result.nsPerIteration
+				<< ", \"cpu_time\": " << result.nsPerIteration << ", \"time_unit\": \"ns\""
+				<< ", \"items_per_second\": " << result.itemsPerSecond << " }";
+		}
+		std::cout << "\n  ]\n}" << std::endl;
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string filter{};
+	std::string format = "csv";
+	double minSeconds = 0.25;
+	std::string modelDirectory = "models";
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto value = [&arg](const char* prefix) { return arg.substr(std::char_traits<char>::length(prefix)); };
+		if (arg.rfind("--filter=", 0) == 0) filter = value("--filter=");
+		else if (arg.rfind("--format=", 0) == 0) format = value("--format=");
+		else if (arg.rfind("--min-time=", 0) == 0) minSeconds = std::atof(value("--min-time=").c_str());
+		else if (arg.rfind("--models=", 0) == 0) modelDirectory = value("--models=");
+		else {
+			std::cerr << "unknown argument " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (format != "csv" && format != "json") {
+		std::cerr << "unknown format " << format << ", expected csv or json" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	try {
+		std::vector<Result> results{};
+		if (format == "csv") std::cout << "name,iterations,ns_per_iteration,items_per_second" << std::endl;
+		for (const auto& benchmark : registerBenchmarks(modelDirectory)) {
+			if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) continue;
+			results.push_back(measure(benchmark, minSeconds));
+			if (format == "csv") {
+				const auto& result = results.back();
+				std::cout << result.name << "," << result.iterations << "," << result.nsPerIteration << ","
+					<< result.itemsPerSecond << std::endl;
+			}
+		}
+		if (format == "json") printJson(results);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
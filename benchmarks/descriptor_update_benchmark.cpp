@@ -0,0 +1,159 @@
+// Compares descriptor update throughput for a six-buffer set: generic vkUpdateDescriptorSets through
+// LveDescriptorWriter, the writer's template path, a hand-packed POD through vkUpdateDescriptorSetWithTemplate,
+// and (when VK_KHR_push_descriptor is available) recording push descriptors into a command buffer.
+// Usage: descriptor_update_benchmark [updates]
+
+#include "../lve_buffer.hpp"
+#include "../lve_descriptors.hpp"
+#include "../lve_device.hpp"
+#include "../lve_window.hpp"
+
+// std
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace lve;
+
+	constexpr uint32_t UNIFORM_BINDINGS = 4;
+	constexpr uint32_t STORAGE_BINDINGS = 2;
+	constexpr uint32_t BINDING_COUNT = UNIFORM_BINDINGS + STORAGE_BINDINGS;
+
+	// matches the packed layout LveDescriptorSetLayout builds: bindings 0..5 in order, one buffer info each
+	struct SetData {
+		std::array<VkDescriptorBufferInfo, BINDING_COUNT> buffers;
+	};
+
+	std::unique_ptr<LveDescriptorSetLayout> buildLayout(LveDevice& device, bool updateTemplate, bool pushDescriptors) {
+		LveDescriptorSetLayout::Builder builder{ device };
+		for (uint32_t binding = 0; binding < BINDING_COUNT; binding++) {
+			builder.addBinding(
+				binding,
+				binding < UNIFORM_BINDINGS ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				VK_SHADER_STAGE_ALL_GRAPHICS);
+		}
+		if (updateTemplate) builder.enableUpdateTemplate();
+		if (pushDescriptors) builder.enablePushDescriptors();
+		return builder.build();
+	}
+
+	void report(const std::string& path, int updates, const std::function<void()>& run) {
+		auto start = std::chrono::steady_clock::now();
+		run();
+		double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::cout << path << "," << updates << "," << totalMs << "," << totalMs * 1e6 / updates << std::endl;
+	}
+}
+
+int main(int argc, char** argv) {
+	const int updates = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+	try {
+		LveWindow window{ 320, 240, "descriptor_update_benchmark" };
+		LveDevice device{ window };
+
+		std::vector<std::unique_ptr<LveBuffer>> buffers{};
+		std::vector<VkDescriptorBufferInfo> bufferInfos{};
+		for (uint32_t binding = 0; binding < BINDING_COUNT; binding++) {
+			buffers.push_back(std::make_unique<LveBuffer>(
+				device,
+				256,
+				1,
+				binding < UNIFORM_BINDINGS ? VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT : VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+			bufferInfos.push_back(buffers.back()->descriptorInfo());
+		}
+
+		auto genericLayout = buildLayout(device, false, false);
+		auto templateLayout = buildLayout(device, true, false);
+
+		auto pool = LveDescriptorPool::Builder(device)
+			.setMaxSets(2)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 * UNIFORM_BINDINGS)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * STORAGE_BINDINGS)
+			.build();
+
+		LveDescriptorWriter genericWriter{ *genericLayout, *pool };
+		LveDescriptorWriter templateWriter{ *templateLayout, *pool };
+		for (uint32_t binding = 0; binding < BINDING_COUNT; binding++) {
+			genericWriter.writeBuffer(binding, &bufferInfos[binding]);
+			templateWriter.writeBuffer(binding, &bufferInfos[binding]);
+		}
+		VkDescriptorSet genericSet;
+		VkDescriptorSet templateSet;
+		if (!genericWriter.build(genericSet) || !templateWriter.build(templateSet)) {
+			throw std::runtime_error("failed to allocate benchmark descriptor sets!");
+		}
+
+		SetData setData{};
+		for (uint32_t binding = 0; binding < BINDING_COUNT; binding++) {
+			setData.buffers[binding] = bufferInfos[binding];
+		}
+		if (templateLayout->getTemplateDataSize() != sizeof(SetData)) {
+			throw std::runtime_error("packed template layout does not match SetData!");
+		}
+
+		std::cout << "path,updates,total_ms,ns_per_update" << std::endl;
+		report("write_descriptor_sets", updates, [&]() {
+			for (int i = 0; i < updates; i++) genericWriter.overwrite(genericSet);
+		});
+		report("writer_template", updates, [&]() {
+			for (int i = 0; i < updates; i++) templateWriter.overwrite(templateSet);
+		});
+		report("pod_template", updates, [&]() {
+			for (int i = 0; i < updates; i++) templateLayout->updateWithTemplate(templateSet, &setData);
+		});
+
+		if (device.supportsPushDescriptors()) {
+			auto pushLayout = buildLayout(device, false, true);
+			VkDescriptorSetLayout pushSetLayout = pushLayout->getDescriptorSetLayout();
+
+			VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+			pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			pipelineLayoutInfo.setLayoutCount = 1;
+			pipelineLayoutInfo.pSetLayouts = &pushSetLayout;
+			VkPipelineLayout pipelineLayout;
+			if (vkCreatePipelineLayout(device.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create pipeline layout!");
+			}
+
+			// recording cost only; the command buffer is never submitted
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandPool = device.getCommandPool();
+			allocInfo.commandBufferCount = 1;
+			VkCommandBuffer commandBuffer;
+			if (vkAllocateCommandBuffers(device.device(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate command buffers!");
+			}
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+			report("push_template", updates, [&]() {
+				for (int i = 0; i < updates; i++) pushLayout->pushWithTemplate(commandBuffer, pipelineLayout, 0, &setData);
+			});
+
+			vkEndCommandBuffer(commandBuffer);
+			vkFreeCommandBuffers(device.device(), device.getCommandPool(), 1, &commandBuffer);
+			vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+		}
+		else {
+			std::cerr << "VK_KHR_push_descriptor unavailable, skipping push_template" << std::endl;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+// Builds N graphics pipeline variants with 1..hardware_concurrency compile threads and reports
+// wall time per thread count, once with monolithic pipelines and once linked from graphics
+// pipeline library parts when the device supports them. Usage: pipeline_compile_benchmark [variantCount]
+
+#include "../lve_descriptors.hpp"
+#include "../lve_device.hpp"
+#include "../lve_pipeline_registry.hpp"
+#include "../lve_renderer.hpp"
+#include "../lve_thread_pool.hpp"
+#include "../lve_window.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+	struct SimplePushConstantData {
+		glm::mat4 modelMatrix{ 1.0f };
+		glm::mat4 normalMatrix{ 1.0f };
+	};
+}
+
+int main(int argc, char** argv) {
+	using namespace lve;
+	const int variantCount = argc > 1 ? std::atoi(argv[1]) : 64;
+
+	try {
+		LveWindow window{ 320, 240, "pipeline_compile_benchmark" };
+		LveDevice device{ window };
+		LveRenderer renderer{ window, device };
+
+		auto setLayout = LveDescriptorSetLayout::Builder(device)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+			.build();
+		VkDescriptorSetLayout descriptorSetLayout = setLayout->getDescriptorSetLayout();
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(SimplePushConstantData);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		VkPipelineLayout pipelineLayout;
+		if (vkCreatePipelineLayout(device.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+
+		std::cout << "mode,variants,threads,wall_ms,cpu_ms,part_compile_ms,fast_link_ms,optimized_link_ms" << std::endl;
+		int run = 0;
+		for (bool useLibrary : { false, true }) {
+			if (useLibrary && !device.supportsGraphicsPipelineLibrary()) break;
+
+			for (size_t threads = 1; threads <= LveThreadPool::defaultThreadCount(); threads *= 2, run++) {
+				// every run compiles from an empty cache, not the one loaded from disk or filled by earlier runs
+				device.resetPipelineCache();
+				LveThreadPool pool{ threads };
+				LvePipelineRegistry registry{ device, &pool, useLibrary };
+
+				std::vector<LvePipelineHandle> handles;
+				handles.reserve(variantCount);
+				for (int i = 0; i < variantCount; i++) {
+					PipelineConfigInfo config{};
+					LvePipeline::defaultPipelineConfigInfo(config);
+					config.renderPass = renderer.getSwapChainRenderPass();
+					config.pipelineLayout = pipelineLayout;
+					// a distinct bias per run also keeps driver-internal shader caches from matching earlier runs,
+					// while variants within a run only differ in output state so library parts can be shared
+					config.rasterizerInfo.depthBiasEnable = VK_TRUE;
+					config.rasterizerInfo.depthBiasConstantFactor = static_cast<float>(run + 1);
+					config.colorBlendInfo.blendConstants[0] = static_cast<float>(i);
+					if (i & 1) {
+						LvePipeline::enableAlphaBlending(config);
+					}
+					handles.push_back(registry.requestPipeline(
+						"shaders/simple_shader.vert.spv",
+						"shaders/simple_shader.frag.spv",
+						config));
+				}
+				registry.waitIdle();
+
+				auto stats = registry.getStats();
+				std::cout << (stats.usesPipelineLibrary ? "library" : "monolithic") << ","
+					<< variantCount << "," << threads << "," << stats.compileWallMs << "," << stats.compileCpuMs << ","
+					<< stats.library.partCompileMs << "," << stats.library.fastLinkMs << ","
+					<< stats.library.optimizedLinkMs << std::endl;
+			}
+		}
+
+		vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+// Renders empty frames on a headless device, first without capturing and then reading back every frame through
+// LveReadback, and prints the CPU frame time of both phases. The difference is the per-frame cost of capturing:
+// recording the copy and polling, with encoding on the background thread. Frames arriving while every ring slot
+// is still copying or encoding are dropped and counted.
+// Usage: readback_benchmark [frames] [width] [height] [none|raw|png] [outputDir]
+
+#include "../lve_device.hpp"
+#include "../lve_percentile.hpp"
+#include "../lve_readback.hpp"
+#include "../lve_renderer.hpp"
+#include "../lve_renderer_config.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace lve;
+
+	void runPhase(
+		const std::string& phase,
+		LveDevice& device,
+		LveRenderer& renderer,
+		int frames,
+		bool capture,
+		LveReadback::FileFormat fileFormat,
+		const std::string& outputDir) {
+		LveReadback readback{ device };
+		std::vector<double> frameMs{};
+		frameMs.reserve(frames);
+
+		int rendered = 0;
+		while (rendered < frames) {
+			auto start = std::chrono::steady_clock::now();
+			readback.poll();
+			auto commandBuffer = renderer.beginFrame();
+			if (!commandBuffer) continue;
+			renderer.beginSwapChainRenderPass(commandBuffer);
+			renderer.endSwapChainRenderPass(commandBuffer);
+			if (capture) {
+				LveReadback::Request request{};
+				request.fileFormat = fileFormat;
+				if (fileFormat != LveReadback::FileFormat::None) {
+					request.path = outputDir + "/frame_" + std::to_string(rendered)
+						+ (fileFormat == LveReadback::FileFormat::Png ? ".png" : ".raw");
+				}
+				readback.captureSwapChain(commandBuffer, renderer, request);
+			}
+			renderer.endFrame();
+			readback.frameSubmitted(renderer.getLastSubmittedTimelineValue());
+			frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			rendered++;
+		}
+		readback.flush();
+		vkDeviceWaitIdle(device.device());
+
+		double total = 0.0;
+		for (double ms : frameMs) total += ms;
+		std::sort(frameMs.begin(), frameMs.end());
+		double p99 = percentile(frameMs, 99);
+
+		auto stats = readback.getStats();
+		std::cout << phase << "," << frames << "," << total / frames << "," << p99 << "," << stats.captured << ","
+			<< stats.dropped << "," << stats.encodeMs << std::endl;
+	}
+
+	LveReadback::FileFormat parseFileFormat(const char* name) {
+		if (std::strcmp(name, "none") == 0) return LveReadback::FileFormat::None;
+		if (std::strcmp(name, "raw") == 0) return LveReadback::FileFormat::Raw;
+		if (std::strcmp(name, "png") == 0) return LveReadback::FileFormat::Png;
+		throw std::runtime_error("unknown file format, expected none, raw or png!");
+	}
+}
+
+int main(int argc, char** argv) {
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 300;
+	const uint32_t width = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 1920;
+	const uint32_t height = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 1080;
+	const std::string outputDir = argc > 5 ? argv[5] : ".";
+
+	try {
+		const auto fileFormat = argc > 4 ? parseFileFormat(argv[4]) : LveReadback::FileFormat::None;
+		LveDevice device{ nullptr };
+		LveRenderer renderer{ device, { width, height }, LveRendererConfig{} };
+
+		std::cout << "phase,frames,avg_ms,p99_ms,captured,dropped,encode_ms" << std::endl;
+		runPhase("baseline", device, renderer, frames, false, fileFormat, outputDir);
+		runPhase("capture", device, renderer, frames, true, fileFormat, outputDir);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
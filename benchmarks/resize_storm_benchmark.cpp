@@ -0,0 +1,82 @@
+// Measures CPU frame times while the window is resized every few frames, against a steady baseline.
+// Each resize recreates the swap chain; the old one is retired rather than waited on, so the worst frame
+// in the storm should stay close to the steady-state worst frame.
+// Usage: resize_storm_benchmark [frames] [framesPerResize]
+
+#include "../lve_device.hpp"
+#include "../lve_percentile.hpp"
+#include "../lve_renderer.hpp"
+#include "../lve_window.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace lve;
+
+	void report(const std::string& phase, int resizes, std::vector<double> frameMs) {
+		if (frameMs.empty()) return;
+		std::sort(frameMs.begin(), frameMs.end());
+		double averageMs = std::accumulate(frameMs.begin(), frameMs.end(), 0.0) / frameMs.size();
+		double p99Ms = percentile(frameMs, 99);
+		std::cout << phase << "," << frameMs.size() << "," << resizes << "," << averageMs << "," << p99Ms << ","
+			<< frameMs.back() << std::endl;
+	}
+
+	// framesPerResize == 0 renders without resizing
+	void runPhase(const std::string& phase, LveWindow& window, LveRenderer& renderer, int frames, int framesPerResize) {
+		const std::array<std::array<int, 2>, 4> sizes{ { {1280, 720}, {960, 540}, {1600, 900}, {640, 360} } };
+		std::vector<double> frameMs{};
+		frameMs.reserve(frames);
+		int resizes = 0;
+
+		auto last = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			if (framesPerResize > 0 && frame % framesPerResize == 0) {
+				auto& size = sizes[resizes++ % sizes.size()];
+				glfwSetWindowSize(window.getGLFWwindow(), size[0], size[1]);
+			}
+			glfwPollEvents();
+
+			if (auto commandBuffer = renderer.beginFrame()) {
+				renderer.beginSwapChainRenderPass(commandBuffer);
+				renderer.endSwapChainRenderPass(commandBuffer);
+				renderer.endFrame();
+			}
+
+			auto now = std::chrono::steady_clock::now();
+			frameMs.push_back(std::chrono::duration<double, std::milli>(now - last).count());
+			last = now;
+		}
+		report(phase, resizes, std::move(frameMs));
+	}
+}
+
+int main(int argc, char** argv) {
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 600;
+	const int framesPerResize = argc > 2 ? std::max(1, std::atoi(argv[2])) : 2;
+
+	try {
+		LveWindow window{ 1280, 720, "resize_storm_benchmark" };
+		LveDevice device{ window };
+		LveRenderer renderer{ window, device };
+
+		std::cout << "phase,frames,resizes,avg_ms,p99_ms,max_ms" << std::endl;
+		runPhase("steady", window, renderer, frames, 0);
+		runPhase("resize_storm", window, renderer, frames, framesPerResize);
+		vkDeviceWaitIdle(device.device());
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,329 @@
+// Renders a procedurally generated scene on a headless device along a scripted camera orbit and prints CPU and
+// GPU frame-time percentiles, draw counts and memory use as JSON. The scene is fully determined by the arguments
+// (meshes are generated, not loaded; placement comes from a seeded generator) and frames advance with a fixed
+// time step, so two runs with the same arguments on the same machine are comparable across commits.
+// Usage: scene_benchmark [frames] [objects] [uniqueModels] [lights] [dynamicFraction] [width] [height] [seed]
+
+#include "../lve_buffer.hpp"
+#include "../lve_camera.hpp"
+#include "../lve_descriptors.hpp"
+#include "../lve_device.hpp"
+#include "../lve_frame_info.hpp"
+#include "../lve_game_object.hpp"
+#include "../lve_gpu_profiler.hpp"
+#include "../lve_json.hpp"
+#include "../lve_model.hpp"
+#include "../lve_percentile.hpp"
+#include "../lve_pipeline_registry.hpp"
+#include "../lve_renderer.hpp"
+#include "../lve_renderer_config.hpp"
+#include "../lve_specialization.hpp"
+#include "../point_light_system.hpp"
+#include "../render_system.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+	using namespace lve;
+
+	constexpr float FRAME_TIME = 1.0f / 60.0f;
+	constexpr int WARMUP_FRAMES = 2 * static_cast<int>(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+
+	struct SceneParams {
+		int frames = 600;
+		int objects = 1000;
+		int uniqueModels = 8;
+		int lights = 6;
+		float dynamicFraction = 0.25f;
+		uint32_t width = 1920;
+		uint32_t height = 1080;
+		uint32_t seed = 1;
+	};
+
+	struct Scene {
+		LveGameObject::Map gameObjects{};
+		std::vector<LveGameObject::id_t> dynamicObjects{};
+		float radius = 1.0f;
+		uint64_t meshDraws = 0;
+		uint64_t lightDraws = 0;
+		uint64_t trianglesPerFrame = 0;
+		uint64_t meshBytes = 0;
+	};
+
+	// a sphere with `segments` around and segments / 2 rings, so models differ in vertex count and cost
+	LveModel::Builder makeSphere(uint32_t segments, glm::vec3 color) {
+		LveModel::Builder builder{};
+		const uint32_t rings = std::max(2u, segments / 2);
+		for (uint32_t ring = 0; ring <= rings; ring++) {
+			float phi = glm::pi<float>() * ring / rings;
+			for (uint32_t segment = 0; segment <= segments; segment++) {
+				float theta = glm::two_pi<float>() * segment / segments;
+				LveModel::Vertex vertex{};
+				vertex.normal = { std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) };
+				vertex.position = 0.5f * vertex.normal;
+				vertex.color = color;
+				vertex.uv = { static_cast<float>(segment) / segments, static_cast<float>(ring) / rings };
+				builder.vertices.push_back(vertex);
+			}
+		}
+		for (uint32_t ring = 0; ring < rings; ring++) {
+			for (uint32_t segment = 0; segment < segments; segment++) {
+				uint32_t a = ring * (segments + 1) + segment;
+				uint32_t b = a + segments + 1;
+				builder.indices.insert(builder.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+			}
+		}
+		return builder;
+	}
+
+	Scene buildScene(LveDevice& device, const SceneParams& params) {
+		Scene scene{};
+		std::mt19937 random{ params.seed };
+		std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+
+		std::vector<std::shared_ptr<LveModel>> models{};
+		std::vector<uint64_t> modelTriangles{};
+		for (int i = 0; i < params.uniqueModels; i++) {
+			auto builder = makeSphere(8 + 4 * (i % 8), { unit(random), unit(random), unit(random) });
+			scene.meshBytes += builder.vertices.size() * sizeof(LveModel::Vertex) + builder.indices.size() * sizeof(uint32_t);
+			modelTriangles.push_back(builder.indices.size() / 3);
+			models.push_back(std::make_shared<LveModel>(device, builder));
+		}
+
+		// objects on a square grid in the XZ plane centered on the origin, which PointLightSystem::update rotates
+		// the lights around, with some jitter; the first dynamicFraction of them spin
+		const int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(params.objects)))));
+		const float spacing = 1.5f;
+		const float offset = 0.5f * (side - 1) * spacing;
+		const int dynamicCount = static_cast<int>(std::lround(params.objects * params.dynamicFraction));
+		for (int i = 0; i < params.objects; i++) {
+			auto object = LveGameObject::createGameObject();
+			size_t model = static_cast<size_t>(i) % models.size();
+			object.model = models[model];
+			object.transform.translation = {
+				(i % side) * spacing - offset + 0.5f * (unit(random) - 0.5f),
+				0.0f,
+				(i / side) * spacing - offset + 0.5f * (unit(random) - 0.5f) };
+			object.transform.rotation = { 0.0f, glm::two_pi<float>() * unit(random), 0.0f };
+			object.transform.scale = glm::vec3(0.5f + unit(random));
+			if (i < dynamicCount) scene.dynamicObjects.push_back(object.getId());
+			scene.trianglesPerFrame += modelTriangles[model];
+			scene.meshDraws++;
+			scene.gameObjects.emplace(object.getId(), std::move(object));
+		}
+
+		scene.radius = std::max(2.0f, 1.5f * offset);
+
+		for (int i = 0; i < params.lights; i++) {
+			auto pointLight = LveGameObject::makePointLight(0.5f);
+			pointLight.color = { unit(random), unit(random), unit(random) };
+			float angle = glm::two_pi<float>() * i / params.lights;
+			pointLight.transform.translation = {
+				scene.radius * std::cos(angle), -1.0f - unit(random), scene.radius * std::sin(angle) };
+			scene.lightDraws++;
+			scene.gameObjects.emplace(pointLight.getId(), std::move(pointLight));
+		}
+		return scene;
+	}
+
+	// one orbit over the run, bobbing up and down twice, always looking at the scene center (the origin)
+	void placeCamera(LveCamera& camera, const Scene& scene, int frame, int frames) {
+		float t = static_cast<float>(frame) / std::max(1, frames);
+		float angle = glm::two_pi<float>() * t;
+		glm::vec3 position{
+			1.2f * scene.radius * std::cos(angle),
+			-0.4f * scene.radius - 0.2f * scene.radius * std::sin(2.0f * angle),
+			1.2f * scene.radius * std::sin(angle) };
+		camera.setViewTarget(position, glm::vec3(0.0f));
+	}
+
+	uint64_t peakResidentKilobytes() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+		return counters.PeakWorkingSetSize / 1024;
+#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+		// kilobytes on Linux, bytes on macOS
+#ifdef __APPLE__
+		return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+#else
+		return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+	}
+
+	SceneParams parseParams(int argc, char** argv) {
+		SceneParams params{};
+		if (argc > 1) params.frames = std::atoi(argv[1]);
+		if (argc > 2) params.objects = std::atoi(argv[2]);
+		if (argc > 3) params.uniqueModels = std::atoi(argv[3]);
+		if (argc > 4) params.lights = std::atoi(argv[4]);
+		if (argc > 5) params.dynamicFraction = std::strtof(argv[5], nullptr);
+		if (argc > 6) params.width = static_cast<uint32_t>(std::atoi(argv[6]));
+		if (argc > 7) params.height = static_cast<uint32_t>(std::atoi(argv[7]));
+		if (argc > 8) params.seed = static_cast<uint32_t>(std::atoi(argv[8]));
+
+		if (params.frames < 1 || params.objects < 0 || params.uniqueModels < 1 || params.lights < 0) {
+			throw std::runtime_error("invalid scene parameters!");
+		}
+		if (params.lights > MAX_POINT_LIGHTS) {
+			std::cerr << "clamping " << params.lights << " lights to MAX_POINT_LIGHTS (" << MAX_POINT_LIGHTS << ")" << std::endl;
+			params.lights = MAX_POINT_LIGHTS;
+		}
+		params.dynamicFraction = std::clamp(params.dynamicFraction, 0.0f, 1.0f);
+		return params;
+	}
+}
+
+int main(int argc, char** argv) {
+	try {
+		const SceneParams params = parseParams(argc, argv);
+
+		LveDevice device{ nullptr };
+		LveRenderer renderer{ device, { params.width, params.height }, LveRendererConfig{} };
+		LvePipelineRegistry registry{ device };
+
+		auto globalPool = LveDescriptorPool::Builder(device)
+			.setMaxSets(LveRendererConfig::MAX_FRAMES_IN_FLIGHT)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveRendererConfig::MAX_FRAMES_IN_FLIGHT)
+			.build();
+		auto globalSetLayout = LveDescriptorSetLayout::Builder(device)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+			.build();
+
+		std::vector<std::unique_ptr<LveBuffer>> uboBuffers(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+		std::vector<VkDescriptorSet> globalDescriptorSets(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+		for (size_t i = 0; i < uboBuffers.size(); i++) {
+			uboBuffers[i] = std::make_unique<LveBuffer>(
+				device, sizeof(GlobalUbo), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			uboBuffers[i]->map();
+			auto bufferInfo = uboBuffers[i]->descriptorInfo();
+			LveDescriptorWriter(*globalSetLayout, *globalPool)
+				.writeBuffer(0, &bufferInfo)
+				.build(globalDescriptorSets[i]);
+		}
+
+		Scene scene = buildScene(device, params);
+
+		LightingPermutation lightingPermutation{};
+		lightingPermutation.maxPointLights = static_cast<uint32_t>(params.lights);
+		RenderSystem renderSystem{
+			device, registry, renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout(), lightingPermutation };
+		PointLightSystem pointLightSystem{
+			device, registry, renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+		LveGpuProfiler gpuProfiler{ device, 4, static_cast<uint32_t>(params.frames) };
+
+		LveCamera camera{};
+		camera.setPerspectiveProjection(glm::radians(50.0f), renderer.getAspectRatio(), 0.1f, 1000.0f);
+
+		std::vector<double> cpuFrameMs{};
+		cpuFrameMs.reserve(params.frames);
+		int frame = 0;
+		while (frame < WARMUP_FRAMES + params.frames) {
+			auto start = std::chrono::steady_clock::now();
+			auto commandBuffer = renderer.beginFrame();
+			if (!commandBuffer) continue;
+			const bool measured = frame >= WARMUP_FRAMES;
+			int frameIndex = renderer.getFrameIndex();
+
+			gpuProfiler.beginFrame(commandBuffer, frameIndex);
+			uint32_t frameZone = measured ? gpuProfiler.beginZone(commandBuffer, "frame") : LveGpuProfiler::NO_ZONE;
+
+			placeCamera(camera, scene, frame, WARMUP_FRAMES + params.frames);
+			for (auto id : scene.dynamicObjects) {
+				scene.gameObjects.at(id).transform.rotation.y += FRAME_TIME;
+			}
+
+			FrameInfo frameInfo{ frameIndex, FRAME_TIME, commandBuffer, camera, globalDescriptorSets[frameIndex], scene.gameObjects };
+			GlobalUbo ubo{};
+			ubo.projection = camera.getProjection();
+			ubo.view = camera.getView();
+			ubo.inverseView = camera.getInverseView();
+			pointLightSystem.update(frameInfo, ubo);
+			uboBuffers[frameIndex]->writeToBuffer(&ubo);
+			uboBuffers[frameIndex]->flush();
+
+			renderer.beginSwapChainRenderPass(commandBuffer);
+			renderSystem.renderGameObjects(frameInfo);
+			pointLightSystem.render(frameInfo);
+			renderer.endSwapChainRenderPass(commandBuffer);
+			gpuProfiler.endZone(commandBuffer, frameZone);
+			renderer.endFrame();
+
+			if (measured) {
+				cpuFrameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			}
+			frame++;
+		}
+
+		// the last framesInFlight frames are collected when their slots come around again
+		for (uint32_t i = 0; i < LveRendererConfig::MAX_FRAMES_IN_FLIGHT; i++) {
+			auto commandBuffer = renderer.beginFrame();
+			if (!commandBuffer) continue;
+			gpuProfiler.beginFrame(commandBuffer, renderer.getFrameIndex());
+			renderer.beginSwapChainRenderPass(commandBuffer);
+			renderer.endSwapChainRenderPass(commandBuffer);
+			renderer.endFrame();
+		}
+		vkDeviceWaitIdle(device.device());
+
+		std::vector<double> sorted = cpuFrameMs;
+		std::sort(sorted.begin(), sorted.end());
+		double cpuTotal = 0.0;
+		for (double ms : sorted) cpuTotal += ms;
+
+		LveGpuProfiler::ZoneStats gpu{};
+		for (const auto& zone : gpuProfiler.getStats()) {
+			if (zone.name == "frame") gpu = zone;
+		}
+
+		std::cout << "{\n"
+			<< "  \"benchmark\": \"scene\",\n"
+			<< "  \"device\": ";
+		// driver-reported, so it may contain quotes or backslashes
+		writeJsonString(std::cout, device.properties.deviceName);
+		std::cout << ",\n"
+			<< "  \"params\": { \"frames\": " << params.frames << ", \"warmup_frames\": " << WARMUP_FRAMES
+			<< ", \"objects\": " << params.objects << ", \"unique_models\": " << params.uniqueModels
+			<< ", \"lights\": " << params.lights << ", \"dynamic_fraction\": " << params.dynamicFraction
+			<< ", \"width\": " << params.width << ", \"height\": " << params.height << ", \"seed\": " << params.seed << " },\n"
+			<< "  \"draws\": { \"per_frame\": " << scene.meshDraws + scene.lightDraws << ", \"mesh\": " << scene.meshDraws
+			<< ", \"light\": " << scene.lightDraws << ", \"triangles\": " << scene.trianglesPerFrame << " },\n"
+			<< "  \"cpu_frame_ms\": { \"min\": " << sorted.front() << ", \"avg\": " << cpuTotal / sorted.size()
+			<< ", \"p50\": " << percentile(sorted, 50) << ", \"p95\": " << percentile(sorted, 95)
+			<< ", \"p99\": " << percentile(sorted, 99) << ", \"max\": " << sorted.back() << " },\n"
+			<< "  \"gpu_frame_ms\": { \"samples\": " << gpu.samples << ", \"min\": " << gpu.minMs
+			<< ", \"avg\": " << gpu.averageMs << ", \"p99\": " << gpu.p99Ms << " },\n"
+			<< "  \"memory\": { \"mesh_bytes\": " << scene.meshBytes << ", \"peak_rss_kb\": " << peakResidentKilobytes() << " }\n"
+			<< "}" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
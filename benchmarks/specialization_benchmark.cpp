@@ -0,0 +1,163 @@
+// Compares GPU time of the mesh pass with a generic fragment shader (light loop bounded by
+// MAX_POINT_LIGHTS and broken at ubo.numPointLights) against one specialized to the scene's light count.
+// Usage: specialization_benchmark [frames] [overdrawLayers]
+
+#include "../lve_buffer.hpp"
+#include "../lve_camera.hpp"
+#include "../lve_descriptors.hpp"
+#include "../lve_device.hpp"
+#include "../lve_frame_info.hpp"
+#include "../lve_game_object.hpp"
+#include "../lve_model.hpp"
+#include "../lve_pipeline_registry.hpp"
+#include "../lve_renderer.hpp"
+#include "../lve_specialization.hpp"
+#include "../lve_window.hpp"
+#include "../render_system.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// std
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+	using namespace lve;
+
+	double measureVariant(
+		LveDevice& device,
+		LveRenderer& renderer,
+		RenderSystem& renderSystem,
+		LveCamera& camera,
+		LveGameObject::Map& gameObjects,
+		std::vector<VkDescriptorSet>& globalDescriptorSets,
+		VkQueryPool queryPool,
+		int frames) {
+		double totalMs = 0.0;
+		int measured = 0;
+		for (int frame = 0; frame < frames; frame++) {
+			auto commandBuffer = renderer.beginFrame();
+			if (!commandBuffer) continue;
+
+			int frameIndex = renderer.getFrameIndex();
+			FrameInfo frameInfo{ frameIndex, 0.0f, commandBuffer, camera, globalDescriptorSets[frameIndex], gameObjects };
+
+			vkCmdResetQueryPool(commandBuffer, queryPool, 0, 2);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+			renderer.beginSwapChainRenderPass(commandBuffer);
+			renderSystem.renderGameObjects(frameInfo);
+			renderer.endSwapChainRenderPass(commandBuffer);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+			renderer.endFrame();
+
+			// stalling is fine here: only the GPU interval between the two timestamps is reported
+			vkDeviceWaitIdle(device.device());
+			uint64_t timestamps[2];
+			if (vkGetQueryPoolResults(
+				device.device(), queryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+				VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+				totalMs += (timestamps[1] - timestamps[0]) * device.properties.limits.timestampPeriod * 1e-6;
+				measured++;
+			}
+		}
+		return measured > 0 ? totalMs / measured : 0.0;
+	}
+}
+
+int main(int argc, char** argv) {
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 200;
+	const int overdrawLayers = argc > 2 ? std::atoi(argv[2]) : 32;
+
+	try {
+		LveWindow window{ 1280, 720, "specialization_benchmark" };
+		LveDevice device{ window };
+		LveRenderer renderer{ window, device };
+		LvePipelineRegistry registry{ device };
+
+		auto globalPool = LveDescriptorPool::Builder(device)
+			.setMaxSets(LveRendererConfig::MAX_FRAMES_IN_FLIGHT)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveRendererConfig::MAX_FRAMES_IN_FLIGHT)
+			.build();
+		auto globalSetLayout = LveDescriptorSetLayout::Builder(device)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+			.build();
+
+		// full-screen quads stacked towards the camera so every layer passes the depth test
+		LveGameObject::Map gameObjects;
+		std::shared_ptr<LveModel> quad = LveModel::createModelFromFile(device, "models/quad.obj");
+		for (int i = 0; i < overdrawLayers; i++) {
+			auto layer = LveGameObject::createGameObject();
+			layer.model = quad;
+			layer.transform.translation = { 0.0f, 0.0f, 2.0f - i * (1.0f / overdrawLayers) };
+			layer.transform.rotation = { -glm::half_pi<float>(), 0.0f, 0.0f };
+			layer.transform.scale = glm::vec3(10.0f);
+			gameObjects.emplace(layer.getId(), std::move(layer));
+		}
+
+		LveCamera camera{};
+		camera.setViewTarget(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		camera.setPerspectiveProjection(glm::radians(50.0f), renderer.getAspectRatio(), 0.1f, 100.0f);
+
+		GlobalUbo ubo{};
+		ubo.projection = camera.getProjection();
+		ubo.view = camera.getView();
+		ubo.inverseView = camera.getInverseView();
+		const uint32_t sceneLights = 6;
+		for (uint32_t i = 0; i < sceneLights; i++) {
+			float angle = i * glm::two_pi<float>() / sceneLights;
+			ubo.pointLights[i].position = glm::vec4(glm::cos(angle), glm::sin(angle), 1.0f, 1.0f);
+			ubo.pointLights[i].color = glm::vec4(1.0f, 1.0f, 1.0f, 0.2f);
+		}
+		ubo.numPointLights = sceneLights;
+
+		std::vector<std::unique_ptr<LveBuffer>> uboBuffers(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+		std::vector<VkDescriptorSet> globalDescriptorSets(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+		for (size_t i = 0; i < uboBuffers.size(); i++) {
+			uboBuffers[i] = std::make_unique<LveBuffer>(
+				device, sizeof(GlobalUbo), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			uboBuffers[i]->map();
+			uboBuffers[i]->writeToBuffer(&ubo);
+			uboBuffers[i]->flush();
+			auto bufferInfo = uboBuffers[i]->descriptorInfo();
+			LveDescriptorWriter(*globalSetLayout, *globalPool)
+				.writeBuffer(0, &bufferInfo)
+				.build(globalDescriptorSets[i]);
+		}
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = 2;
+		VkQueryPool queryPool;
+		if (vkCreateQueryPool(device.device(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create query pool!");
+		}
+
+		std::cout << "variant,max_point_lights,frames,overdraw_layers,gpu_ms" << std::endl;
+		{
+			// no specialization data at all: the shader keeps its MAX_POINT_LIGHTS default
+			RenderSystem renderSystem{ device, registry, renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+			double gpuMs = measureVariant(device, renderer, renderSystem, camera, gameObjects, globalDescriptorSets, queryPool, frames);
+			std::cout << "generic," << MAX_POINT_LIGHTS << "," << frames << "," << overdrawLayers << "," << gpuMs << std::endl;
+		}
+		{
+			LightingPermutation specialized{};
+			specialized.maxPointLights = sceneLights;
+			RenderSystem renderSystem{ device, registry, renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout(), specialized };
+			double gpuMs = measureVariant(device, renderer, renderSystem, camera, gameObjects, globalDescriptorSets, queryPool, frames);
+			std::cout << "specialized," << specialized.maxPointLights << "," << frames << "," << overdrawLayers << "," << gpuMs << std::endl;
+		}
+
+		vkDestroyQueryPool(device.device(), queryPool, nullptr);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
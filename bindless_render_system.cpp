@@ -0,0 +1,139 @@
+#include "bindless_render_system.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_profiler.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <stdexcept>
+#include <array>
+#include <cassert>
+
+namespace lve {
+	// std430 layout of ObjectData in bindless_shader.vert
+	struct BindlessObjectData {
+		glm::mat4 modelMatrix{ 1.0f };
+		glm::mat4 normalMatrix{ 1.0f };
+		uint32_t textureHandle = INVALID_BINDLESS_HANDLE;
+		uint32_t samplerHandle = INVALID_BINDLESS_HANDLE;
+		uint32_t padding[2]{};
+	};
+
+	struct BindlessPushConstantData {
+		uint32_t objectBufferHandle;
+	};
+
+	BindlessRenderSystem::BindlessRenderSystem(LveDevice& device, LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass,
+		VkDescriptorSetLayout globalSetLayout, LveBindlessDescriptors& bindlessDescriptors, uint32_t framesInFlight,
+		const LightingPermutation& permutation)
+		: lveDevice(device), pipelineRegistry(pipelineRegistry), bindlessDescriptors(bindlessDescriptors) {
+		createObjectBuffers(framesInFlight);
+		createPipelineLayout(globalSetLayout);
+		createPipeline(pipelineRegistry, renderPass, permutation);
+	}
+	BindlessRenderSystem::~BindlessRenderSystem() {
+		for (auto handle : objectBufferHandles) {
+			bindlessDescriptors.releaseStorageBuffer(handle);
+		}
+		pipelineRegistry.releasePipelineLayout(pipelineLayout);
+		// a pipeline compile queued against the layout may not have run yet; the registry holds the queue until it has
+		lveDevice.deferDestruction([device = lveDevice.device(), layout = pipelineLayout]() {
+			vkDestroyPipelineLayout(device, layout, allocationCallbacks(LveMemoryTag::Pipelines));
+		});
+	}
+
+	void BindlessRenderSystem::createObjectBuffers(uint32_t framesInFlight) {
+		objectBuffers.resize(framesInFlight);
+		objectBufferHandles.resize(framesInFlight);
+		for (size_t i = 0; i < objectBuffers.size(); i++) {
+			objectBuffers[i] = std::make_unique<LveBuffer>(
+				lveDevice,
+				sizeof(BindlessObjectData),
+				MAX_OBJECTS,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+			);
+			objectBuffers[i]->map();
+			objectBufferHandles[i] = bindlessDescriptors.addStorageBuffer(objectBuffers[i]->descriptorInfo());
+		}
+	}
+
+	void BindlessRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(BindlessPushConstantData);
+
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, bindlessDescriptors.getDescriptorSetLayout() };
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, allocationCallbacks(LveMemoryTag::Pipelines), &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+	}
+
+	void BindlessRenderSystem::createPipeline(LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass, const LightingPermutation& permutation) {
+		assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+		PipelineConfigInfo pipelineConfig{};
+		LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
+		permutation.apply(pipelineConfig.fragSpecialization);
+		pipelineConfig.renderPass = renderPass;
+		pipelineConfig.pipelineLayout = pipelineLayout;
+		lvePipeline = pipelineRegistry.requestPipeline(
+			"shaders/bindless_shader.vert.spv",
+			"shaders/bindless_shader.frag.spv",
+			pipelineConfig
+		);
+	}
+
+	void BindlessRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
+		LVE_PROFILE_ZONE("BindlessRenderSystem::renderGameObjects");
+		auto& objectBuffer = *objectBuffers[frameInfo.frameIndex];
+
+		uint32_t objectCount = 0;
+		for (auto& keyValue : frameInfo.gameObjects) {
+			auto& obj = keyValue.second;
+			if (obj.model == nullptr) continue;
+			assert(objectCount < MAX_OBJECTS && "Game objects exceed BindlessRenderSystem::MAX_OBJECTS");
+			BindlessObjectData data{};
+			data.modelMatrix = obj.transform.mat4();
+			data.normalMatrix = obj.transform.normalMatrix();
+			objectBuffer.writeToIndex(&data, objectCount++);
+		}
+		if (objectCount == 0) return;
+		objectBuffer.flush();
+
+		lvePipeline->bind(frameInfo.commandBuffer);
+
+		// the only descriptor bind of the pass: per-frame globals plus the bindless table
+		std::array<VkDescriptorSet, 2> descriptorSets{ frameInfo.globalDescriptorSet, bindlessDescriptors.getDescriptorSet() };
+		vkCmdBindDescriptorSets(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			pipelineLayout,
+			0,
+			static_cast<uint32_t>(descriptorSets.size()),
+			descriptorSets.data(),
+			0,
+			nullptr
+		);
+
+		BindlessPushConstantData push{ objectBufferHandles[frameInfo.frameIndex] };
+		vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(BindlessPushConstantData), &push);
+
+		// same iteration order as above, so firstInstance lines up with the object's slot
+		uint32_t objectIndex = 0;
+		for (auto& keyValue : frameInfo.gameObjects) {
+			auto& obj = keyValue.second;
+			if (obj.model == nullptr) continue;
+			obj.model->bind(frameInfo.commandBuffer);
+			obj.model->draw(frameInfo.commandBuffer, objectIndex++);
+		}
+	}
+}
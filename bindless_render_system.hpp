@@ -0,0 +1,48 @@
+#pragma once
+
+#include "lve_bindless.hpp"
+#include "lve_buffer.hpp"
+#include "lve_device.hpp"
+#include "lve_frame_info.hpp"
+#include "lve_game_object.hpp"
+#include "lve_pipeline_registry.hpp"
+#include "lve_specialization.hpp"
+
+// std
+#include <memory>
+#include <vector>
+
+namespace lve {
+	// Draws every game object with one pipeline, one descriptor bind and one push constant per frame.
+	// Per-object data lives in a storage buffer indexed by gl_InstanceIndex; textures and samplers are
+	// referenced by bindless handle from that data instead of per-object descriptor sets.
+	class BindlessRenderSystem {
+	public:
+		static constexpr uint32_t MAX_OBJECTS = 4096;
+
+		BindlessRenderSystem(LveDevice& device, LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass,
+			VkDescriptorSetLayout globalSetLayout, LveBindlessDescriptors& bindlessDescriptors, uint32_t framesInFlight,
+			const LightingPermutation& permutation);
+		~BindlessRenderSystem();
+
+		BindlessRenderSystem(const BindlessRenderSystem&) = delete;
+		BindlessRenderSystem& operator=(const BindlessRenderSystem&) = delete;
+
+		void renderGameObjects(FrameInfo& frameInfo);
+
+	private:
+		void createObjectBuffers(uint32_t framesInFlight);
+		void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+		void createPipeline(LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass, const LightingPermutation& permutation);
+
+		LveDevice& lveDevice;
+		LvePipelineRegistry& pipelineRegistry;
+		LveBindlessDescriptors& bindlessDescriptors;
+
+		std::vector<std::unique_ptr<LveBuffer>> objectBuffers{};
+		std::vector<LveBindlessHandle> objectBufferHandles{};
+
+		LvePipelineHandle lvePipeline;
+		VkPipelineLayout pipelineLayout;
+	};
+}
@@ -0,0 +1,367 @@
+#include "lve_allocation_tracker.hpp"
+
+namespace lve {
+	const char* memoryTagName(LveMemoryTag tag) {
+		switch (tag) {
+			case LveMemoryTag::Untagged: return "untagged";
+			case LveMemoryTag::App: return "app";
+			case LveMemoryTag::Device: return "device";
+			case LveMemoryTag::SwapChain: return "swap chain";
+			case LveMemoryTag::Pipelines: return "pipelines";
+			case LveMemoryTag::Descriptors: return "descriptors";
+			case LveMemoryTag::Buffers: return "buffers";
+			case LveMemoryTag::Assets: return "assets";
+			case LveMemoryTag::Rendering: return "rendering";
+			case LveMemoryTag::Profiling: return "profiling";
+			default: return "unknown";
+		}
+	}
+}
+
+#ifdef LVE_TRACK_ALLOCATIONS
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace lve {
+	namespace {
+		constexpr size_t TAG_COUNT = static_cast<size_t>(LveMemoryTag::Count);
+		// power-of-two size classes: bucket i holds sizes in [2^(i-1), 2^i)
+		constexpr size_t SIZE_BUCKETS = 40;
+		constexpr size_t SITE_CAPACITY = 256;
+		constexpr size_t FRAME_HISTORY = 4096;
+		constexpr size_t VULKAN_SCOPES = 5;
+
+		// everything below is zero-initialized before any dynamic initialization, so operator new can run
+		// during static initialization of other translation units
+
+		struct TagCounters {
+			std::atomic<uint64_t> allocations;
+			std::atomic<uint64_t> frees;
+			std::atomic<uint64_t> totalBytes;
+			std::atomic<uint64_t> liveBytes;
+			std::atomic<uint64_t> peakBytes;
+			std::atomic<uint64_t> vulkanAllocations;
+			std::atomic<uint64_t> vulkanInternalBytes;
+		};
+
+		struct Site {
+			std::atomic<const char*> name;
+			std::atomic<uint64_t> allocations;
+			std::atomic<uint64_t> bytes;
+		};
+
+		struct FrameSample {
+			uint64_t allocations;
+			uint64_t bytes;
+		};
+
+		std::array<TagCounters, TAG_COUNT> tagCounters;
+		std::atomic<uint64_t> liveBytes;
+		std::atomic<uint64_t> peakBytes;
+		std::array<std::atomic<uint64_t>, SIZE_BUCKETS> sizeHistogram;
+		std::array<std::atomic<uint64_t>, VULKAN_SCOPES> vulkanScopeHistogram;
+		std::array<Site, SITE_CAPACITY> sites;
+		std::atomic<uint64_t> droppedSites;
+
+		std::atomic<uint64_t> frameAllocations;
+		std::atomic<uint64_t> frameBytes;
+		// written by endFrame on the main thread only
+		std::array<FrameSample, FRAME_HISTORY> frameHistory;
+		uint64_t framesRecorded = 0;
+
+		thread_local LveMemoryTag currentTag = LveMemoryTag::Untagged;
+		thread_local const char* currentSite = nullptr;
+
+		// sits right below every pointer handed out, so frees are attributed to the allocating tag
+		struct Header {
+			void* base;
+			uint64_t size;
+			LveMemoryTag tag;
+		};
+
+		void updateMax(std::atomic<uint64_t>& maximum, uint64_t value) {
+			uint64_t current = maximum.load(std::memory_order_relaxed);
+			while (current < value && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+		}
+
+		size_t sizeBucket(uint64_t size) {
+			size_t bucket = 0;
+			while (size > 0 && bucket + 1 < SIZE_BUCKETS) {
+				size >>= 1;
+				bucket++;
+			}
+			return bucket;
+		}
+
+		// open addressing on the pointer value of __func__; names are never removed
+		void recordSite(const char* name, uint64_t size) {
+			size_t start = (reinterpret_cast<uintptr_t>(name) >> 4) % SITE_CAPACITY;
+			for (size_t probe = 0; probe < SITE_CAPACITY; probe++) {
+				Site& site = sites[(start + probe) % SITE_CAPACITY];
+				const char* existing = site.name.load(std::memory_order_acquire);
+				if (existing == nullptr &&
+					site.name.compare_exchange_strong(existing, name, std::memory_order_acq_rel)) {
+					existing = name;
+				}
+				if (existing == name) {
+					site.allocations.fetch_add(1, std::memory_order_relaxed);
+					site.bytes.fetch_add(size, std::memory_order_relaxed);
+					return;
+				}
+			}
+			droppedSites.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void recordAllocation(LveMemoryTag tag, uint64_t size) {
+			TagCounters& counters = tagCounters[static_cast<size_t>(tag)];
+			counters.allocations.fetch_add(1, std::memory_order_relaxed);
+			counters.totalBytes.fetch_add(size, std::memory_order_relaxed);
+			updateMax(counters.peakBytes, counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+			updateMax(peakBytes, liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+			frameAllocations.fetch_add(1, std::memory_order_relaxed);
+			frameBytes.fetch_add(size, std::memory_order_relaxed);
+			sizeHistogram[sizeBucket(size)].fetch_add(1, std::memory_order_relaxed);
+			if (currentSite != nullptr) recordSite(currentSite, size);
+		}
+
+		void* allocate(size_t size, size_t alignment, LveMemoryTag tag) {
+			alignment = std::max(alignment, alignof(std::max_align_t));
+			if (size > SIZE_MAX - alignment - sizeof(Header)) return nullptr;
+			void* base = std::malloc(size + alignment + sizeof(Header));
+			if (base == nullptr) return nullptr;
+
+			uintptr_t user = (reinterpret_cast<uintptr_t>(base) + sizeof(Header) + alignment - 1) & ~(alignment - 1);
+			Header* header = reinterpret_cast<Header*>(user) - 1;
+			header->base = base;
+			header->size = size;
+			header->tag = tag;
+			recordAllocation(tag, size);
+			return reinterpret_cast<void*>(user);
+		}
+
+		Header* headerOf(void* memory) {
+			return static_cast<Header*>(memory) - 1;
+		}
+
+		void release(void* memory) {
+			if (memory == nullptr) return;
+			Header* header = headerOf(memory);
+			TagCounters& counters = tagCounters[static_cast<size_t>(header->tag)];
+			counters.frees.fetch_add(1, std::memory_order_relaxed);
+			counters.liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+			liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+			std::free(header->base);
+		}
+
+		LveMemoryTag tagOf(void* userData) {
+			return static_cast<LveMemoryTag>(reinterpret_cast<uintptr_t>(userData));
+		}
+
+		void* VKAPI_CALL vulkanAllocation(
+			void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+			LveMemoryTag tag = tagOf(userData);
+			tagCounters[static_cast<size_t>(tag)].vulkanAllocations.fetch_add(1, std::memory_order_relaxed);
+			vulkanScopeHistogram[std::min<size_t>(scope, VULKAN_SCOPES - 1)].fetch_add(1, std::memory_order_relaxed);
+			return allocate(size, alignment, tag);
+		}
+
+		void* VKAPI_CALL vulkanReallocation(
+			void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+			if (original == nullptr) return vulkanAllocation(userData, size, alignment, scope);
+			if (size == 0) {
+				release(original);
+				return nullptr;
+			}
+			// on failure the original allocation must stay valid
+			void* memory = vulkanAllocation(userData, size, alignment, scope);
+			if (memory == nullptr) return nullptr;
+			std::memcpy(memory, original, static_cast<size_t>(std::min<uint64_t>(size, headerOf(original)->size)));
+			release(original);
+			return memory;
+		}
+
+		void VKAPI_CALL vulkanFree(void*, void* memory) {
+			release(memory);
+		}
+
+		void VKAPI_CALL vulkanInternalAllocation(
+			void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+			tagCounters[static_cast<size_t>(tagOf(userData))].vulkanInternalBytes.fetch_add(size, std::memory_order_relaxed);
+		}
+
+		void VKAPI_CALL vulkanInternalFree(
+			void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+			tagCounters[static_cast<size_t>(tagOf(userData))].vulkanInternalBytes.fetch_sub(size, std::memory_order_relaxed);
+		}
+
+		void* trackedNew(size_t size) {
+			return allocate(size == 0 ? 1 : size, alignof(std::max_align_t), currentTag);
+		}
+	}
+
+	const VkAllocationCallbacks* LveAllocationTracker::callbacks(LveMemoryTag tag) {
+		// one set per tag, told apart by pUserData; they all free through the header, so they are compatible
+		// with each other and an object may be destroyed with a different tag than it was created with
+		static const std::array<VkAllocationCallbacks, TAG_COUNT> table = []() {
+			std::array<VkAllocationCallbacks, TAG_COUNT> callbacks{};
+			for (size_t i = 0; i < TAG_COUNT; i++) {
+				callbacks[i].pUserData = reinterpret_cast<void*>(i);
+				callbacks[i].pfnAllocation = vulkanAllocation;
+				callbacks[i].pfnReallocation = vulkanReallocation;
+				callbacks[i].pfnFree = vulkanFree;
+				callbacks[i].pfnInternalAllocation = vulkanInternalAllocation;
+				callbacks[i].pfnInternalFree = vulkanInternalFree;
+			}
+			return callbacks;
+		}();
+		return &table[static_cast<size_t>(tag)];
+	}
+
+	void LveAllocationTracker::pushScope(
+		LveMemoryTag tag, const char* site, LveMemoryTag& previousTag, const char*& previousSite) {
+		previousTag = currentTag;
+		previousSite = currentSite;
+		currentTag = tag;
+		currentSite = site;
+	}
+
+	void LveAllocationTracker::popScope(LveMemoryTag previousTag, const char* previousSite) {
+		currentTag = previousTag;
+		currentSite = previousSite;
+	}
+
+	void LveAllocationTracker::endFrame() {
+		frameHistory[framesRecorded % FRAME_HISTORY] = {
+			frameAllocations.exchange(0, std::memory_order_relaxed),
+			frameBytes.exchange(0, std::memory_order_relaxed) };
+		framesRecorded++;
+	}
+
+	double LveAllocationTracker::steadyStateAllocationsPerFrame(uint32_t warmupFrames) {
+		uint64_t first = std::max<uint64_t>(warmupFrames, framesRecorded > FRAME_HISTORY ? framesRecorded - FRAME_HISTORY : 0);
+		if (first >= framesRecorded) return 0.0;
+		uint64_t allocations = 0;
+		for (uint64_t frame = first; frame < framesRecorded; frame++) {
+			allocations += frameHistory[frame % FRAME_HISTORY].allocations;
+		}
+		return static_cast<double>(allocations) / (framesRecorded - first);
+	}
+
+	void LveAllocationTracker::printReport(uint32_t warmupFrames) {
+		std::cout << "Host allocations: peak " << peakBytes.load() << " bytes, " << liveBytes.load() << " bytes live" << std::endl;
+		for (size_t i = 0; i < TAG_COUNT; i++) {
+			const TagCounters& counters = tagCounters[i];
+			if (counters.allocations.load() == 0 && counters.vulkanInternalBytes.load() == 0) continue;
+			std::cout << "  " << memoryTagName(static_cast<LveMemoryTag>(i)) << ": " << counters.allocations.load()
+				<< " allocations (" << counters.vulkanAllocations.load() << " by Vulkan), " << counters.frees.load()
+				<< " frees, " << counters.totalBytes.load() << " bytes total, peak " << counters.peakBytes.load()
+				<< " bytes, " << counters.liveBytes.load() << " bytes live, " << counters.vulkanInternalBytes.load()
+				<< " bytes Vulkan-internal" << std::endl;
+		}
+
+		uint64_t first = std::max<uint64_t>(warmupFrames, framesRecorded > FRAME_HISTORY ? framesRecorded - FRAME_HISTORY : 0);
+		if (first < framesRecorded) {
+			uint64_t maxAllocations = 0;
+			uint64_t maxBytes = 0;
+			uint64_t allocatingFrames = 0;
+			for (uint64_t frame = first; frame < framesRecorded; frame++) {
+				const FrameSample& sample = frameHistory[frame % FRAME_HISTORY];
+				maxAllocations = std::max(maxAllocations, sample.allocations);
+				maxBytes = std::max(maxBytes, sample.bytes);
+				if (sample.allocations > 0) allocatingFrames++;
+			}
+			std::cout << "  per frame after " << warmupFrames << " warmup frames: "
+				<< steadyStateAllocationsPerFrame(warmupFrames) << " allocations avg, " << maxAllocations << " max, "
+				<< maxBytes << " bytes max; " << allocatingFrames << " of " << framesRecorded - first
+				<< " frames allocated" << std::endl;
+		}
+
+		std::cout << "  sizes:";
+		for (size_t bucket = 0; bucket < SIZE_BUCKETS; bucket++) {
+			uint64_t count = sizeHistogram[bucket].load();
+			if (count == 0) continue;
+			std::cout << " <" << (uint64_t{ 1 } << bucket) << ": " << count << ";";
+		}
+		std::cout << std::endl;
+
+		static const char* const scopeNames[VULKAN_SCOPES] = { "command", "object", "cache", "device", "instance" };
+		std::cout << "  Vulkan scopes:";
+		for (size_t scope = 0; scope < VULKAN_SCOPES; scope++) {
+			std::cout << " " << scopeNames[scope] << ": " << vulkanScopeHistogram[scope].load() << ";";
+		}
+		std::cout << std::endl;
+
+		std::array<const Site*, SITE_CAPACITY> sorted{};
+		size_t siteCount = 0;
+		for (const auto& site : sites) {
+			if (site.name.load() != nullptr) sorted[siteCount++] = &site;
+		}
+		std::sort(sorted.begin(), sorted.begin() + siteCount, [](const Site* a, const Site* b) {
+			return a->allocations.load() > b->allocations.load();
+		});
+		std::cout << "  top call sites:" << std::endl;
+		for (size_t i = 0; i < std::min<size_t>(siteCount, 10); i++) {
+			std::cout << "    " << sorted[i]->name.load() << ": " << sorted[i]->allocations.load() << " allocations, "
+				<< sorted[i]->bytes.load() << " bytes" << std::endl;
+		}
+		if (droppedSites.load() > 0) {
+			std::cout << "    (" << droppedSites.load() << " allocations from sites past the table's capacity)" << std::endl;
+		}
+	}
+}
+
+// the aligned overloads are left to the standard library; they pair with its own aligned deletes and go untracked
+
+void* operator new(std::size_t size) {
+	void* memory = lve::trackedNew(size);
+	if (memory == nullptr) throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t size) {
+	void* memory = lve::trackedNew(size);
+	if (memory == nullptr) throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return lve::trackedNew(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return lve::trackedNew(size);
+}
+
+void operator delete(void* memory) noexcept {
+	lve::release(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	lve::release(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	lve::release(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+	lve::release(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+	lve::release(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+	lve::release(memory);
+}
+
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+
+// Host allocation tracking. With LVE_TRACK_ALLOCATIONS defined, the global operator new/delete are replaced and
+// allocationCallbacks(tag) hands Vulkan a tracking allocator; without it allocationCallbacks returns nullptr,
+// the scope macro expands to nothing, the tracker's functions are empty inline stubs and the defaults are used
+// as before.
+//
+//   vkCreateX(device, &info, allocationCallbacks(LveMemoryTag::SwapChain), &handle);
+//   LVE_MEMORY_SCOPE(LveMemoryTag::Assets);   attributes operator new in the rest of the scope to the tag and
+//                                             to the enclosing function as the call site
+
+namespace lve {
+	enum class LveMemoryTag : uint8_t {
+		Untagged,
+		App,
+		Device,
+		SwapChain,
+		Pipelines,
+		Descriptors,
+		Buffers,
+		Assets,
+		Rendering,
+		Profiling,
+		Count
+	};
+
+	const char* memoryTagName(LveMemoryTag tag);
+
+#ifdef LVE_TRACK_ALLOCATIONS
+
+	// Counters are atomics in fixed-size tables, so recording never allocates or locks and works from any thread.
+	class LveAllocationTracker {
+	public:
+		static const VkAllocationCallbacks* callbacks(LveMemoryTag tag);
+
+		// closes the current frame's counters; call once per frame from the main loop
+		static void endFrame();
+		// average allocations per frame after the first warmupFrames, over the frames still in the history
+		static double steadyStateAllocationsPerFrame(uint32_t warmupFrames);
+		static void printReport(uint32_t warmupFrames);
+
+		static void pushScope(LveMemoryTag tag, const char* site, LveMemoryTag& previousTag, const char*& previousSite);
+		static void popScope(LveMemoryTag previousTag, const char* previousSite);
+	};
+
+	class LveMemoryScope {
+	public:
+		LveMemoryScope(LveMemoryTag tag, const char* site) {
+			LveAllocationTracker::pushScope(tag, site, previousTag, previousSite);
+		}
+		~LveMemoryScope() { LveAllocationTracker::popScope(previousTag, previousSite); }
+
+		LveMemoryScope(const LveMemoryScope&) = delete;
+		LveMemoryScope& operator=(const LveMemoryScope&) = delete;
+
+	private:
+		LveMemoryTag previousTag;
+		const char* previousSite;
+	};
+
+#define LVE_MEMORY_CONCAT_INNER(a, b) a##b
+#define LVE_MEMORY_CONCAT(a, b) LVE_MEMORY_CONCAT_INNER(a, b)
+#define LVE_MEMORY_SCOPE(tag) ::lve::LveMemoryScope LVE_MEMORY_CONCAT(lveMemoryScope, __LINE__){ tag, __func__ }
+
+#else
+
+	class LveAllocationTracker {
+	public:
+		static constexpr const VkAllocationCallbacks* callbacks(LveMemoryTag) { return nullptr; }
+		static void endFrame() {}
+		static double steadyStateAllocationsPerFrame(uint32_t) { return 0.0; }
+		static void printReport(uint32_t) {}
+	};
+
+#define LVE_MEMORY_SCOPE(tag) ((void)0)
+
+#endif
+
+	inline const VkAllocationCallbacks* allocationCallbacks(LveMemoryTag tag) {
+		return LveAllocationTracker::callbacks(tag);
+	}
+}
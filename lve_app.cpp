@@ -3,8 +3,22 @@
 #include "lve_app.hpp"
 #include "lve_camera.hpp"
 #include "keyboard_movement_controller.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_bindless.hpp"
 #include "lve_buffer.hpp"
+#include "lve_descriptor_allocator.hpp"
+#include "lve_descriptor_cache.hpp"
+#include "lve_dynamic_resolution.hpp"
+#include "lve_gpu_profiler.hpp"
+#include "lve_pipeline_registry.hpp"
+#include "lve_pipeline_statistics.hpp"
+#include "lve_profiler.hpp"
+#include "lve_readback.hpp"
+#include "lve_renderer_config.hpp"
+#include "lve_specialization.hpp"
+#include "lve_thread_pool.hpp"
 #include "render_system.hpp"
+#include "bindless_render_system.hpp"
 #include "point_light_system.hpp"
 
 #define GLM_FORCE_RADIANS
@@ -13,25 +27,96 @@
 #include <glm/gtc/constants.hpp>
 
 #include <stdexcept>
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
 
 constexpr float MAX_FRAME_RATE = 1.0f / 60.0f;
 
 namespace lve{
+	namespace {
+		// edge-triggered so holding a key switches the config once
+		class KeyToggle {
+		public:
+			explicit KeyToggle(int key) : key{ key } {}
+			bool pressed(GLFWwindow* window) {
+				bool down = glfwGetKey(window, key) == GLFW_PRESS;
+				bool triggered = down && !wasDown;
+				wasDown = down;
+				return triggered;
+			}
+		private:
+			int key;
+			bool wasDown = false;
+		};
+
+		void printLatency(const LveRendererConfig& config, const LveLatencyTracker::Stats& stats) {
+			if (stats.frames == 0) return;
+			std::cout << "Input-to-present latency [" << config.describe() << "]: " << stats.averageMs << " ms avg, "
+				<< stats.p99Ms << " ms p99, " << stats.maxMs << " ms max over " << stats.frames << " frames" << std::endl;
+		}
+
+		bool pipelineStatisticsRequested() {
+			const char* value = std::getenv("LVE_PIPELINE_STATISTICS");
+			return value != nullptr && std::strcmp(value, "0") != 0;
+		}
+
+		void printPipelineStatistics(const LvePipelineStatistics::PassStats& pass) {
+			const auto& average = pass.average;
+			std::cout << "Pipeline statistics " << pass.name << " (avg of " << pass.frames << " frames): "
+				<< average.inputAssemblyVertices << " vertices, " << average.inputAssemblyPrimitives << " primitives, "
+				<< average.vertexShaderInvocations << " VS, " << average.clippingInvocations << " -> "
+				<< average.clippingPrimitives << " clipped primitives (" << pass.averageClippedFraction() * 100.0
+				<< "% kept), " << average.fragmentShaderInvocations << " FS, " << average.computeShaderInvocations
+				<< " CS; overdraw " << pass.averageOverdraw << "x" << std::endl;
+		}
+
+		bool dynamicResolutionRequested() {
+			const char* value = std::getenv("LVE_DYNAMIC_RESOLUTION");
+			return value != nullptr && std::strcmp(value, "0") != 0;
+		}
+
+		// frames left out of the steady-state allocation figures while pipelines, descriptor pools and caches fill up
+		constexpr uint32_t ALLOCATION_WARMUP_FRAMES = 120;
+
+		// LVE_ALLOCATION_BUDGET=<n> fails the run when steady-state frames average more than n host allocations;
+		// only meaningful in builds with LVE_TRACK_ALLOCATIONS
+		bool allocationBudgetExceeded() {
+			const char* value = std::getenv("LVE_ALLOCATION_BUDGET");
+			if (value == nullptr) return false;
+			double allocationsPerFrame = LveAllocationTracker::steadyStateAllocationsPerFrame(ALLOCATION_WARMUP_FRAMES);
+			return allocationsPerFrame > std::strtod(value, nullptr);
+		}
+
+		// LVE_CAPTURE_FRAMES=<dir> writes every presented frame there as raw RGBA, e.g. for image-diff tests
+		std::string captureDirectory() {
+			const char* value = std::getenv("LVE_CAPTURE_FRAMES");
+			return value != nullptr ? std::string{ value } : std::string{};
+		}
+	}
+
+
 	LveApp::LveApp() {
-		globalPool = 
-			LveDescriptorPool::Builder(lveDevice)
-			.setMaxSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT)
-			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+		descriptorAllocator =
+			LveDescriptorAllocator::Builder(lveDevice)
+			.setFramesInFlight(LveRendererConfig::MAX_FRAMES_IN_FLIGHT)
+			.addPoolSizeRatio(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f)
+			.addPoolSizeRatio(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f)
 			.build();
+		lveRenderer.setConfig(LveRendererConfig::fromEnvironment());
 		loadGameObjects();
 	}
 	LveApp::~LveApp() { }
 
 	void LveApp::run() {
-		std::vector<std::unique_ptr<LveBuffer>> uboBuffers(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+		LVE_PROFILE_THREAD("main");
+		// per-frame resources cover the largest config so frames in flight can change at runtime
+		std::vector<std::unique_ptr<LveBuffer>> uboBuffers(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
 		for (size_t i = 0; i < uboBuffers.size(); i++) {
 			uboBuffers[i] = std::make_unique<LveBuffer>(
 				lveDevice,
@@ -44,20 +129,55 @@ namespace lve{
 			uboBuffers[i]->map();
 		}
 
+		LveDescriptorLayoutCache layoutCache{lveDevice};
+		LveDescriptorSetCache setCache{lveDevice, *descriptorAllocator, LveRendererConfig::MAX_FRAMES_IN_FLIGHT};
+
 		auto globalSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
 			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
-			.build();
+			.build(layoutCache);
+
+		LveThreadPool compileThreads{};
+		LvePipelineRegistry pipelineRegistry{lveDevice, &compileThreads};
+		pipelineRegistry.registerRenderPass(
+			lveRenderer.getSwapChainRenderPass(),
+			{ {lveRenderer.getSwapChainImageFormat()}, lveRenderer.getSwapChainDepthFormat(), VK_SAMPLE_COUNT_1_BIT });
 
-		std::vector<VkDescriptorSet> globalDescriptorSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-		for (size_t i = 0; i < globalDescriptorSets.size(); i++) {
-			auto bufferInfo = uboBuffers[i]->descriptorInfo();
-			LveDescriptorWriter(*globalSetLayout, *globalPool)
-				.writeBuffer(0, &bufferInfo)
-				.build(globalDescriptorSets[i]);
+		// specialize the light loop to the scene's light count instead of looping to ubo.numPointLights
+		LightingPermutation lightingPermutation{};
+		lightingPermutation.maxPointLights = 0;
+		for (auto& keyValue : gameObjects) {
+			if (keyValue.second.pointLight != nullptr) lightingPermutation.maxPointLights++;
 		}
 
-		RenderSystem renderSystem{lveDevice, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout()};
-		PointLightSystem pointLightSystem{lveDevice, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout()};
+		// systems only declare their pipelines here; they compile concurrently and block on first bind
+		// with descriptor indexing, objects draw through one bindless set instead of per-object binds
+		std::unique_ptr<LveBindlessDescriptors> bindlessDescriptors{};
+		std::unique_ptr<BindlessRenderSystem> bindlessRenderSystem{};
+		std::unique_ptr<RenderSystem> renderSystem{};
+		if (lveDevice.supportsDescriptorIndexing()) {
+			bindlessDescriptors = std::make_unique<LveBindlessDescriptors>(lveDevice, LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+			bindlessRenderSystem = std::make_unique<BindlessRenderSystem>(lveDevice, pipelineRegistry, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout(), *bindlessDescriptors, LveRendererConfig::MAX_FRAMES_IN_FLIGHT, lightingPermutation);
+		}
+		else {
+			renderSystem = std::make_unique<RenderSystem>(lveDevice, pipelineRegistry, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout(), lightingPermutation);
+		}
+		PointLightSystem pointLightSystem{lveDevice, pipelineRegistry, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout()};
+		// the scene render pass is compatible with the swap chain's, so the systems above render into either
+		std::unique_ptr<LveDynamicResolution> dynamicResolution{};
+		if (dynamicResolutionRequested()) {
+			dynamicResolution = std::make_unique<LveDynamicResolution>(
+				lveDevice, lveRenderer, pipelineRegistry, layoutCache, setCache, LveDynamicResolution::Settings::fromEnvironment());
+		}
+		LveGpuProfiler gpuProfiler{ lveDevice };
+		// costs a query per system draw, so only on request
+		std::unique_ptr<LvePipelineStatistics> pipelineStatistics{};
+		if (pipelineStatisticsRequested()) {
+			pipelineStatistics = std::make_unique<LvePipelineStatistics>(lveDevice);
+		}
+		LveReadback readback{ lveDevice };
+		const std::string frameCaptureDirectory = captureDirectory();
+		uint64_t capturedFrames = 0;
+		uint32_t screenshots = 0;
 		LveCamera camera{};
 		camera.setViewTarget(glm::vec3(-1.0, -2.0, -2.0), glm::vec3(0.0f, 0.0f, 2.5f));
 
@@ -65,11 +185,50 @@ namespace lve{
 		viewObject.transform.translation.z = -2.5f;
 		KeyboardMovementController cameraController{};
 
+		// F1 present mode, F2 frames in flight, F3 swap chain image count, F4 low latency
+		KeyToggle presentModeKey{GLFW_KEY_F1};
+		KeyToggle framesInFlightKey{GLFW_KEY_F2};
+		KeyToggle imageCountKey{GLFW_KEY_F3};
+		KeyToggle lowLatencyKey{GLFW_KEY_F4};
+		// F12 screenshot
+		KeyToggle screenshotKey{GLFW_KEY_F12};
+		const std::array<VkPresentModeKHR, 4> presentModes{
+			VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+
 		auto currentTime = std::chrono::high_resolution_clock::now();
 
 		while (!lveWindow.shouldClose()) {
+			LVE_PROFILE_ZONE("frame");
+			LVE_MEMORY_SCOPE(LveMemoryTag::App);
+			lveRenderer.beginInputSampling();
 			glfwPollEvents();
 
+			LveRendererConfig config = lveRenderer.getConfig();
+			GLFWwindow* window = lveWindow.getGLFWwindow();
+			bool configChanged = true;
+			if (presentModeKey.pressed(window)) {
+				auto mode = std::find(presentModes.begin(), presentModes.end(), config.presentMode);
+				config.presentMode = mode == presentModes.end() || mode + 1 == presentModes.end() ? presentModes[0] : *(mode + 1);
+			}
+			else if (framesInFlightKey.pressed(window)) {
+				config.framesInFlight = config.framesInFlight % LveRendererConfig::MAX_FRAMES_IN_FLIGHT + 1;
+			}
+			else if (imageCountKey.pressed(window)) {
+				// 0 (driver default) -> 2 -> 3 -> 4 -> 0
+				config.swapChainImageCount = config.swapChainImageCount == 0 ? 2 : (config.swapChainImageCount + 1) % 5;
+			}
+			else if (lowLatencyKey.pressed(window)) {
+				config.lowLatency = !config.lowLatency;
+			}
+			else {
+				configChanged = false;
+			}
+			if (configChanged) {
+				printLatency(lveRenderer.getConfig(), lveRenderer.getLatencyStats());
+				lveRenderer.setConfig(config);
+				std::cout << "Renderer config: " << config.describe() << std::endl;
+			}
+
 			auto newTime = std::chrono::high_resolution_clock::now();
 			float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
 			currentTime = newTime;
@@ -82,36 +241,151 @@ namespace lve{
 			float aspect = lveRenderer.getAspectRatio();
 			camera.setPerspectiveProjection(glm::radians(50.0f), aspect, 0.1f, 100.0f);
 
+			bool screenshotRequested = screenshotKey.pressed(window);
+			readback.poll();
+
 			if (auto commandBuffer = lveRenderer.beginFrame()) {
 				int frameIndex = lveRenderer.getFrameIndex();
+				// beginFrame waited for this frame slot's timeline value, so its descriptor pools are no longer in use
+				descriptorAllocator->beginFrame(frameIndex);
+				setCache.beginFrame();
+				if (bindlessDescriptors) bindlessDescriptors->beginFrame();
+				gpuProfiler.beginFrame(commandBuffer, frameIndex);
+				if (pipelineStatistics) pipelineStatistics->beginFrame(commandBuffer, frameIndex);
+				uint32_t frameZone = gpuProfiler.beginZone(commandBuffer, "frame");
+				// the same UBO comes back every framesInFlight frames, so this only writes on the first pass
+				VkDescriptorSet globalDescriptorSet;
+				auto bufferInfo = uboBuffers[frameIndex]->descriptorInfo();
+				LveDescriptorWriter(*globalSetLayout)
+					.writeBuffer(0, &bufferInfo)
+					.build(globalDescriptorSet, setCache);
 				FrameInfo frameInfo{ 
 					frameIndex, 
 					frameTime, 
 					commandBuffer, 
 					camera, 
-					globalDescriptorSets[frameIndex],
+					globalDescriptorSet,
 					gameObjects
 				};
 				// update
-				GlobalUbo ubo{};
-				ubo.projection = camera.getProjection();
-				ubo.view = camera.getView();
-				ubo.inverseView = camera.getInverseView();
-				pointLightSystem.update(frameInfo, ubo);
-				uboBuffers[frameIndex]->writeToBuffer(&ubo);
-				uboBuffers[frameIndex]->flush();
+				{
+					LVE_PROFILE_ZONE("UBO update");
+					GlobalUbo ubo{};
+					ubo.projection = camera.getProjection();
+					ubo.view = camera.getView();
+					ubo.inverseView = camera.getInverseView();
+					pointLightSystem.update(frameInfo, ubo);
+					uboBuffers[frameIndex]->writeToBuffer(&ubo);
+					uboBuffers[frameIndex]->flush();
+				}
 				// render
-				lveRenderer.beginSwapChainRenderPass(commandBuffer);
-				renderSystem.renderGameObjects(frameInfo);
-				pointLightSystem.render(frameInfo);
+				uint32_t passZone = LveGpuProfiler::NO_ZONE;
+				if (dynamicResolution) {
+					dynamicResolution->beginFrame(commandBuffer, frameIndex);
+					passZone = gpuProfiler.beginZone(commandBuffer, "scene pass");
+					dynamicResolution->beginScenePass(commandBuffer);
+				}
+				else {
+					passZone = gpuProfiler.beginZone(commandBuffer, "swap chain pass");
+					lveRenderer.beginSwapChainRenderPass(commandBuffer);
+				}
+				const VkExtent2D sceneExtent = dynamicResolution
+					? dynamicResolution->getSceneExtent()
+					: lveRenderer.getSwapChainExtent();
+				if (bindlessRenderSystem) {
+					LveGpuZone zone{ &gpuProfiler, commandBuffer, "bindless render system" };
+					LvePipelineStatisticsScope statistics{
+						pipelineStatistics.get(), commandBuffer, "bindless render system", sceneExtent };
+					bindlessRenderSystem->renderGameObjects(frameInfo);
+				}
+				else {
+					LveGpuZone zone{ &gpuProfiler, commandBuffer, "render system" };
+					LvePipelineStatisticsScope statistics{ pipelineStatistics.get(), commandBuffer, "render system", sceneExtent };
+					renderSystem->renderGameObjects(frameInfo);
+				}
+				{
+					LveGpuZone zone{ &gpuProfiler, commandBuffer, "point light system" };
+					LvePipelineStatisticsScope statistics{
+						pipelineStatistics.get(), commandBuffer, "point light system", sceneExtent };
+					pointLightSystem.render(frameInfo);
+				}
+				if (dynamicResolution) {
+					dynamicResolution->endScenePass(commandBuffer);
+					gpuProfiler.endZone(commandBuffer, passZone);
+					passZone = gpuProfiler.beginZone(commandBuffer, "upscale pass");
+					lveRenderer.beginSwapChainRenderPass(commandBuffer);
+					LvePipelineStatisticsScope statistics{
+						pipelineStatistics.get(), commandBuffer, "upscale", lveRenderer.getSwapChainExtent() };
+					dynamicResolution->upscale(commandBuffer);
+				}
 				lveRenderer.endSwapChainRenderPass(commandBuffer);
+				gpuProfiler.endZone(commandBuffer, passZone);
+				if (dynamicResolution) dynamicResolution->endFrame(commandBuffer);
+				gpuProfiler.endZone(commandBuffer, frameZone);
+				if (screenshotRequested) {
+					LveReadback::Request request{};
+					request.path = "screenshot_" + std::to_string(screenshots++) + ".png";
+					if (readback.captureSwapChain(commandBuffer, lveRenderer, request)) {
+						std::cout << "Screenshot: " << request.path << std::endl;
+					}
+				}
+				if (!frameCaptureDirectory.empty()) {
+					LveReadback::Request request{};
+					request.path = frameCaptureDirectory + "/frame_" + std::to_string(capturedFrames++) + ".raw";
+					request.fileFormat = LveReadback::FileFormat::Raw;
+					readback.captureSwapChain(commandBuffer, lveRenderer, request);
+				}
 				lveRenderer.endFrame();
+				readback.frameSubmitted(lveRenderer.getLastSubmittedTimelineValue());
 			}
+			LveAllocationTracker::endFrame();
 		}
 		vkDeviceWaitIdle(lveDevice.device());
+		readback.flush();
+		if (pipelineStatistics) {
+			for (const auto& pass : pipelineStatistics->getStats()) printPipelineStatistics(pass);
+		}
+		for (const auto& zone : gpuProfiler.getStats()) {
+			std::cout << "GPU zone " << zone.name << ": " << zone.minMs << " ms min, " << zone.averageMs << " ms avg, "
+				<< zone.p99Ms << " ms p99 (recent frames of " << zone.samples << " timed)" << std::endl;
+		}
+		auto readbackStats = readback.getStats();
+		if (readbackStats.captured > 0 || readbackStats.dropped > 0) {
+			std::cout << "Readback: " << readbackStats.encoded << " of " << readbackStats.captured << " captures written ("
+				<< readbackStats.dropped << " dropped), " << readbackStats.encodeMs << " ms encoding" << std::endl;
+		}
+		printLatency(lveRenderer.getConfig(), lveRenderer.getLatencyStats());
+		if (dynamicResolution && dynamicResolution->getStats().measuredFrames > 0) {
+			const auto& drs = dynamicResolution->getStats();
+			std::cout << "Dynamic resolution: scale " << drs.averageScale << " avg (" << drs.minScale << " - " << drs.maxScale
+				<< "), GPU " << drs.averageFrameMs << " ms avg, " << drs.framesOverBudget << " of " << drs.measuredFrames
+				<< " frames over budget, " << drs.scaleChanges << " scale changes" << std::endl;
+		}
+
+		auto registryStats = pipelineRegistry.getStats();
+		std::cout << "Pipeline compilation: " << registryStats.compileWallMs << " ms wall, "
+			<< registryStats.compileCpuMs << " ms summed over " << compileThreads.threadCount() << " threads ("
+			<< (lveDevice.isPipelineCacheWarm() ? "warm" : "cold") << " cache)" << std::endl;
+		std::cout << "Pipeline registry: " << registryStats.pipelineHits << " hits, "
+			<< registryStats.pipelineMisses << " misses; shader modules: "
+			<< registryStats.shaderHits << " hits, " << registryStats.shaderMisses << " misses" << std::endl;
+		if (registryStats.usesPipelineLibrary) {
+			const auto& library = registryStats.library;
+			std::cout << "Pipeline library: " << library.partMisses << " parts compiled in " << library.partCompileMs
+				<< " ms (" << library.partHits << " reused), " << library.fastLinks << " fast links in " << library.fastLinkMs
+				<< " ms, " << library.optimizedLinks << " optimized links in " << library.optimizedLinkMs << " ms" << std::endl;
+		}
+		std::cout << "Descriptor caches: layouts " << layoutCache.getStats().hitRate() * 100.0 << "% hits, sets "
+			<< setCache.getStats().hitRate() * 100.0 << "% hits (" << setCache.getStats().evictions << " evictions)" << std::endl;
+		LveAllocationTracker::printReport(ALLOCATION_WARMUP_FRAMES);
+		LVE_PROFILE_SHUTDOWN();
+		if (allocationBudgetExceeded()) {
+			throw std::runtime_error("steady-state frames exceeded the host allocation budget!");
+		}
 	}
 
 	void LveApp::loadGameObjects() {
+		LVE_MEMORY_SCOPE(LveMemoryTag::Assets);
 		std::shared_ptr<LveModel> lveModel = 
 			LveModel::createModelFromFile(lveDevice, "models/flat_vase.obj");
         auto flatVase = LveGameObject::createGameObject();
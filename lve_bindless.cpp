@@ -0,0 +1,212 @@
+#include "lve_bindless.hpp"
+
+#include "lve_allocation_tracker.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+	LveBindlessHandle LveBindlessHandleAllocator::allocate() {
+		if (!freeHandles.empty()) {
+			LveBindlessHandle handle = freeHandles.back();
+			freeHandles.pop_back();
+			return handle;
+		}
+		if (nextHandle >= capacity) {
+			throw std::runtime_error("failed to allocate bindless handle: descriptor array is full!");
+		}
+		return nextHandle++;
+	}
+
+	void LveBindlessHandleAllocator::release(LveBindlessHandle handle, uint64_t frame) {
+		assert(handle < nextHandle && "Releasing a bindless handle that was never allocated");
+		retiredHandles.push_back({ handle, frame });
+	}
+
+	void LveBindlessHandleAllocator::reclaim(uint64_t completedFrame) {
+		auto firstPending = std::partition(retiredHandles.begin(), retiredHandles.end(),
+			[completedFrame](const RetiredHandle& retired) { return retired.frame <= completedFrame; });
+		for (auto it = retiredHandles.begin(); it != firstPending; ++it) {
+			freeHandles.push_back(it->handle);
+		}
+		retiredHandles.erase(retiredHandles.begin(), firstPending);
+	}
+
+	LveBindlessDescriptors::LveBindlessDescriptors(LveDevice& device, uint32_t framesInFlight, Capacity requested)
+		: lveDevice{ device },
+		framesInFlight{ framesInFlight },
+		capacity{ clampToDeviceLimits(device, requested) },
+		storageBufferHandles{ capacity.storageBuffers },
+		sampledImageHandles{ capacity.sampledImages },
+		samplerHandles{ capacity.samplers } {
+		if (!lveDevice.supportsDescriptorIndexing()) {
+			throw std::runtime_error("failed to create bindless descriptors: descriptor indexing is not enabled!");
+		}
+		createDescriptorSetLayout();
+		createDescriptorPool();
+		allocateDescriptorSet();
+	}
+
+	LveBindlessDescriptors::~LveBindlessDescriptors() {
+		// the set stays bound by frames in flight; the layout is not referenced once recording ends
+		lveDevice.deferDestruction([device = lveDevice.device(), pool = descriptorPool]() {
+			vkDestroyDescriptorPool(device, pool, allocationCallbacks(LveMemoryTag::Descriptors));
+		});
+		vkDestroyDescriptorSetLayout(lveDevice.device(), descriptorSetLayout, allocationCallbacks(LveMemoryTag::Descriptors));
+	}
+
+	LveBindlessDescriptors::Capacity LveBindlessDescriptors::clampToDeviceLimits(const LveDevice& device, Capacity requested) {
+		const auto& limits = device.getDescriptorIndexingProperties();
+		Capacity clamped{};
+		clamped.storageBuffers = std::min({ requested.storageBuffers,
+			limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+			limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+		clamped.sampledImages = std::min({ requested.sampledImages,
+			limits.maxDescriptorSetUpdateAfterBindSampledImages,
+			limits.maxPerStageDescriptorUpdateAfterBindSampledImages });
+		clamped.samplers = std::min({ requested.samplers,
+			limits.maxDescriptorSetUpdateAfterBindSamplers,
+			limits.maxPerStageDescriptorUpdateAfterBindSamplers });
+		return clamped;
+	}
+
+	void LveBindlessDescriptors::createDescriptorSetLayout() {
+		std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+		bindings[0].binding = STORAGE_BUFFER_BINDING;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[0].descriptorCount = capacity.storageBuffers;
+		bindings[0].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+		bindings[1].binding = SAMPLED_IMAGE_BINDING;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		bindings[1].descriptorCount = capacity.sampledImages;
+		bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		bindings[2].binding = SAMPLER_BINDING;
+		bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		bindings[2].descriptorCount = capacity.samplers;
+		bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		// slots may be empty, and may be rewritten while the set is bound as long as no in-flight draw reads them
+		// (samplers fall under descriptorBindingSampledImageUpdateAfterBind)
+		VkDescriptorBindingFlags arrayFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+		std::array<VkDescriptorBindingFlags, 3> bindingFlags{ arrayFlags, arrayFlags, arrayFlags };
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		if (vkCreateDescriptorSetLayout(lveDevice.device(), &layoutInfo, allocationCallbacks(LveMemoryTag::Descriptors), &descriptorSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create bindless descriptor set layout!");
+		}
+	}
+
+	void LveBindlessDescriptors::createDescriptorPool() {
+		std::array<VkDescriptorPoolSize, 3> poolSizes{};
+		poolSizes[0] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, capacity.storageBuffers };
+		poolSizes[1] = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, capacity.sampledImages };
+		poolSizes[2] = { VK_DESCRIPTOR_TYPE_SAMPLER, capacity.samplers };
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		if (vkCreateDescriptorPool(lveDevice.device(), &poolInfo, allocationCallbacks(LveMemoryTag::Descriptors), &descriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create bindless descriptor pool!");
+		}
+	}
+
+	void LveBindlessDescriptors::allocateDescriptorSet() {
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &descriptorSetLayout;
+
+		if (vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate bindless descriptor set!");
+		}
+	}
+
+	void LveBindlessDescriptors::writeDescriptor(uint32_t binding, LveBindlessHandle handle, VkDescriptorType type,
+		const VkDescriptorBufferInfo* bufferInfo, const VkDescriptorImageInfo* imageInfo) {
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptorSet;
+		write.dstBinding = binding;
+		write.dstArrayElement = handle;
+		write.descriptorType = type;
+		write.descriptorCount = 1;
+		write.pBufferInfo = bufferInfo;
+		write.pImageInfo = imageInfo;
+		vkUpdateDescriptorSets(lveDevice.device(), 1, &write, 0, nullptr);
+	}
+
+	LveBindlessHandle LveBindlessDescriptors::addStorageBuffer(const VkDescriptorBufferInfo& bufferInfo) {
+		LveBindlessHandle handle = storageBufferHandles.allocate();
+		updateStorageBuffer(handle, bufferInfo);
+		return handle;
+	}
+
+	LveBindlessHandle LveBindlessDescriptors::addSampledImage(VkImageView imageView, VkImageLayout imageLayout) {
+		LveBindlessHandle handle = sampledImageHandles.allocate();
+		updateSampledImage(handle, imageView, imageLayout);
+		return handle;
+	}
+
+	LveBindlessHandle LveBindlessDescriptors::addSampler(VkSampler sampler) {
+		LveBindlessHandle handle = samplerHandles.allocate();
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.sampler = sampler;
+		writeDescriptor(SAMPLER_BINDING, handle, VK_DESCRIPTOR_TYPE_SAMPLER, nullptr, &imageInfo);
+		return handle;
+	}
+
+	void LveBindlessDescriptors::updateStorageBuffer(LveBindlessHandle handle, const VkDescriptorBufferInfo& bufferInfo) {
+		writeDescriptor(STORAGE_BUFFER_BINDING, handle, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &bufferInfo, nullptr);
+	}
+
+	void LveBindlessDescriptors::updateSampledImage(LveBindlessHandle handle, VkImageView imageView, VkImageLayout imageLayout) {
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageView = imageView;
+		imageInfo.imageLayout = imageLayout;
+		writeDescriptor(SAMPLED_IMAGE_BINDING, handle, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, nullptr, &imageInfo);
+	}
+
+	void LveBindlessDescriptors::releaseStorageBuffer(LveBindlessHandle handle) {
+		storageBufferHandles.release(handle, currentFrame);
+	}
+
+	void LveBindlessDescriptors::releaseSampledImage(LveBindlessHandle handle) {
+		sampledImageHandles.release(handle, currentFrame);
+	}
+
+	void LveBindlessDescriptors::releaseSampler(LveBindlessHandle handle) {
+		samplerHandles.release(handle, currentFrame);
+	}
+
+	void LveBindlessDescriptors::beginFrame() {
+		currentFrame++;
+		if (currentFrame < framesInFlight) return;
+
+		// the timeline wait for this frame slot guarantees everything recorded framesInFlight frames ago has finished
+		uint64_t completedFrame = currentFrame - framesInFlight;
+		storageBufferHandles.reclaim(completedFrame);
+		sampledImageHandles.reclaim(completedFrame);
+		samplerHandles.reclaim(completedFrame);
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+	using LveBindlessHandle = uint32_t;
+	constexpr LveBindlessHandle INVALID_BINDLESS_HANDLE = UINT32_MAX;
+
+	// Hands out stable array indices. A released index only becomes reusable once every frame that could
+	// still read it has retired, so shaders never see a slot change underneath an in-flight draw.
+	class LveBindlessHandleAllocator {
+	public:
+		explicit LveBindlessHandleAllocator(uint32_t capacity) : capacity{ capacity } {}
+
+		LveBindlessHandle allocate();
+		void release(LveBindlessHandle handle, uint64_t frame);
+		// returns handles released at or before completedFrame to the free list
+		void reclaim(uint64_t completedFrame);
+
+		uint32_t getCapacity() const { return capacity; }
+		uint32_t liveCount() const { return nextHandle - static_cast<uint32_t>(freeHandles.size() + retiredHandles.size()); }
+
+	private:
+		struct RetiredHandle {
+			LveBindlessHandle handle;
+			uint64_t frame;
+		};
+
+		uint32_t capacity;
+		uint32_t nextHandle = 0;
+		std::vector<LveBindlessHandle> freeHandles{};
+		std::vector<RetiredHandle> retiredHandles{};
+	};
+
+	// One update-after-bind descriptor set holding partially bound arrays of every storage buffer, sampled
+	// image and sampler in use. It is bound once per frame; draws select resources by handle in the shader:
+	//   layout(set = 1, binding = 0) readonly buffer ObjectBuffer { ObjectData objects[]; } storageBuffers[];
+	//   layout(set = 1, binding = 1) uniform texture2D textures[];
+	//   layout(set = 1, binding = 2) uniform sampler samplers[];
+	class LveBindlessDescriptors {
+	public:
+		enum Binding : uint32_t {
+			STORAGE_BUFFER_BINDING = 0,
+			SAMPLED_IMAGE_BINDING = 1,
+			SAMPLER_BINDING = 2,
+		};
+
+		struct Capacity {
+			uint32_t storageBuffers = 1024;
+			uint32_t sampledImages = 16384;
+			uint32_t samplers = 64;
+		};
+
+		// requested capacities are clamped to the device's update-after-bind limits
+		LveBindlessDescriptors(LveDevice& device, uint32_t framesInFlight, Capacity capacity = Capacity{});
+		~LveBindlessDescriptors();
+
+		LveBindlessDescriptors(const LveBindlessDescriptors&) = delete;
+		LveBindlessDescriptors& operator=(const LveBindlessDescriptors&) = delete;
+
+		LveBindlessHandle addStorageBuffer(const VkDescriptorBufferInfo& bufferInfo);
+		LveBindlessHandle addSampledImage(VkImageView imageView, VkImageLayout imageLayout);
+		LveBindlessHandle addSampler(VkSampler sampler);
+
+		void updateStorageBuffer(LveBindlessHandle handle, const VkDescriptorBufferInfo& bufferInfo);
+		void updateSampledImage(LveBindlessHandle handle, VkImageView imageView, VkImageLayout imageLayout);
+
+		void releaseStorageBuffer(LveBindlessHandle handle);
+		void releaseSampledImage(LveBindlessHandle handle);
+		void releaseSampler(LveBindlessHandle handle);
+
+		// call once per frame after the frame slot's timeline wait; recycles handles no frame in flight can still read
+		void beginFrame();
+
+		VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
+		VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+		const Capacity& getCapacity() const { return capacity; }
+
+	private:
+		static Capacity clampToDeviceLimits(const LveDevice& device, Capacity requested);
+
+		void createDescriptorSetLayout();
+		void createDescriptorPool();
+		void allocateDescriptorSet();
+		void writeDescriptor(uint32_t binding, LveBindlessHandle handle, VkDescriptorType type,
+			const VkDescriptorBufferInfo* bufferInfo, const VkDescriptorImageInfo* imageInfo);
+
+		LveDevice& lveDevice;
+		uint32_t framesInFlight;
+		uint64_t currentFrame = 0;
+		Capacity capacity;
+
+		VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+		LveBindlessHandleAllocator storageBufferHandles;
+		LveBindlessHandleAllocator sampledImageHandles;
+		LveBindlessHandleAllocator samplerHandles;
+	};
+}
@@ -7,6 +7,8 @@
 
 #include "lve_buffer.hpp"
 
+#include "lve_allocation_tracker.hpp"
+
  // std
 #include <cassert>
 #include <cstring>
@@ -41,6 +43,7 @@ namespace lve {
         instanceCount{ instanceCount },
         usageFlags{ usageFlags },
         memoryPropertyFlags{ memoryPropertyFlags } {
+        LVE_MEMORY_SCOPE(LveMemoryTag::Buffers);
         alignmentSize = getAlignment(instanceSize, minOffsetAlignment);
         bufferSize = alignmentSize * instanceCount;
         device.createBuffer(bufferSize, usageFlags, memoryPropertyFlags, buffer, memory);
@@ -48,8 +51,10 @@ namespace lve {
 
     LveBuffer::~LveBuffer() {
         unmap();
-        vkDestroyBuffer(lveDevice.device(), buffer, nullptr);
-        vkFreeMemory(lveDevice.device(), memory, nullptr);
+        lveDevice.deferDestruction([device = lveDevice.device(), buffer = buffer, memory = memory]() {
+            vkDestroyBuffer(device, buffer, allocationCallbacks(LveMemoryTag::Buffers));
+            vkFreeMemory(device, memory, allocationCallbacks(LveMemoryTag::Buffers));
+        });
     }
 
     /**
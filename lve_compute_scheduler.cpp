@@ -0,0 +1,418 @@
+#include "lve_compute_scheduler.hpp"
+
+#include "lve_allocation_tracker.hpp"
+#include "lve_profiler.hpp"
+#include "lve_renderer_config.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace lve {
+	namespace {
+		// per frame slot: compute begin/end, then graphics begin/end
+		constexpr uint32_t QUERIES_PER_FRAME = 4;
+		constexpr uint32_t COMPUTE_QUERY = 0;
+		constexpr uint32_t GRAPHICS_QUERY = 2;
+	}
+
+	LveComputeScheduler::LveComputeScheduler(LveDevice& device, bool allowDedicatedQueue)
+		: lveDevice{ device },
+		graphicsQueueFamily{ device.findPhysicalQueueFamilies().graphicsFamily },
+		queue{ allowDedicatedQueue ? device.computeQueue() : device.graphicsQueue() },
+		queueFamily{ allowDedicatedQueue ? device.computeQueueFamily() : graphicsQueueFamily } {
+		frameSlots.resize(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+		createCommandBuffers();
+		createTimeline();
+		createQueryPool();
+	}
+
+	LveComputeScheduler::~LveComputeScheduler() {
+		// graphics waits on this timeline, so everything the device timeline has seen is past it too; the wait
+		// covers a final submission nothing consumed
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &timeline;
+		waitInfo.pValues = &lastTimelineValue;
+		vkWaitSemaphores(lveDevice.device(), &waitInfo, std::numeric_limits<uint64_t>::max());
+
+		// the graphics submission waiting on the timeline may still be in flight
+		lveDevice.deferDestruction([device = lveDevice.device(), pool = commandPool, semaphore = timeline,
+			queryPool = timestampQueryPool]() {
+			if (queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(device, queryPool, allocationCallbacks(LveMemoryTag::Rendering));
+			vkDestroySemaphore(device, semaphore, allocationCallbacks(LveMemoryTag::Rendering));
+			vkDestroyCommandPool(device, pool, allocationCallbacks(LveMemoryTag::Rendering));
+		});
+	}
+
+	void LveComputeScheduler::createCommandBuffers() {
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = queueFamily;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		if (vkCreateCommandPool(lveDevice.device(), &poolInfo, allocationCallbacks(LveMemoryTag::Rendering), &commandPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute command pool!");
+		}
+
+		std::vector<VkCommandBuffer> commandBuffers(frameSlots.size());
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = commandPool;
+		allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+		if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate compute command buffers!");
+		}
+		for (size_t i = 0; i < frameSlots.size(); i++) {
+			frameSlots[i].commandBuffer = commandBuffers[i];
+		}
+	}
+
+	void LveComputeScheduler::createTimeline() {
+		VkSemaphoreTypeCreateInfo typeInfo{};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+		if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, allocationCallbacks(LveMemoryTag::Rendering), &timeline) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute timeline semaphore!");
+		}
+	}
+
+	void LveComputeScheduler::createQueryPool() {
+		// timestampComputeAndGraphics guarantees timestamps on every graphics and compute queue
+		if (!lveDevice.properties.limits.timestampComputeAndGraphics) return;
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = QUERIES_PER_FRAME * static_cast<uint32_t>(frameSlots.size());
+		if (vkCreateQueryPool(lveDevice.device(), &queryPoolInfo, allocationCallbacks(LveMemoryTag::Rendering), &timestampQueryPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create timestamp query pool!");
+		}
+	}
+
+	bool LveComputeScheduler::readInterval(uint32_t firstQuery, Interval& interval) {
+		std::array<uint64_t, 2> timestamps{};
+		VkResult result = vkGetQueryPoolResults(
+			lveDevice.device(),
+			timestampQueryPool,
+			firstQuery,
+			2,
+			sizeof(timestamps),
+			timestamps.data(),
+			sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS) return false;
+		interval.begin = timestamps[0];
+		interval.end = timestamps[1];
+		return true;
+	}
+
+	uint64_t LveComputeScheduler::overlapTicks(const Interval& a, const Interval& b) {
+		uint64_t begin = std::max(a.begin, b.begin);
+		uint64_t end = std::min(a.end, b.end);
+		return end > begin ? end - begin : 0;
+	}
+
+	void LveComputeScheduler::collectTimestamps(int frameIndex) {
+		FrameSlot& slot = frameSlots[frameIndex];
+		uint32_t firstQuery = QUERIES_PER_FRAME * frameIndex;
+		Interval compute{};
+		Interval graphics{};
+		bool haveCompute = slot.computeTimed && readInterval(firstQuery + COMPUTE_QUERY, compute);
+		bool haveGraphics = slot.graphicsTimed && readInterval(firstQuery + GRAPHICS_QUERY, graphics);
+		slot.computeTimed = false;
+		slot.graphicsTimed = false;
+
+		// comparing timestamps across queues assumes one device-wide time domain, which desktop drivers use
+		// (VK_EXT_calibrated_timestamps would make it explicit)
+		if (haveCompute && haveGraphics) {
+			const double msPerTick = lveDevice.properties.limits.timestampPeriod / 1e6;
+			uint64_t computeTicks = compute.end - compute.begin;
+			uint64_t overlap = std::min(
+				computeTicks, overlapTicks(compute, previousGraphics) + overlapTicks(compute, graphics));
+
+			stats.frames++;
+			stats.computeMs += (computeTicks * msPerTick - stats.computeMs) / stats.frames;
+			stats.graphicsMs += ((graphics.end - graphics.begin) * msPerTick - stats.graphicsMs) / stats.frames;
+			stats.overlapMs += (overlap * msPerTick - stats.overlapMs) / stats.frames;
+		}
+		// slots are visited in frame order, so this is the frame before the next slot's compute
+		previousGraphics = haveGraphics ? graphics : Interval{};
+	}
+
+	void LveComputeScheduler::beginFrame(int frameIndex) {
+		assert(jobs.empty() && releases.empty() && "Compute jobs from the previous frame were never submitted");
+		currentFrameIndex = frameIndex;
+		submitted = false;
+		pendingAcquires.clear();
+
+		// normally already reached: the graphics frame that waited on it finished before LveRenderer::beginFrame
+		FrameSlot& slot = frameSlots[frameIndex];
+		if (slot.timelineValue > 0) {
+			LVE_PROFILE_ZONE("LveComputeScheduler wait");
+			VkSemaphoreWaitInfo waitInfo{};
+			waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+			waitInfo.semaphoreCount = 1;
+			waitInfo.pSemaphores = &timeline;
+			waitInfo.pValues = &slot.timelineValue;
+			if (vkWaitSemaphores(lveDevice.device(), &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
+				throw std::runtime_error("failed to wait for compute timeline!");
+			}
+		}
+
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			collectTimestamps(frameIndex);
+		}
+	}
+
+	void LveComputeScheduler::addJob(RecordFn record) {
+		assert(!submitted && "Cannot add compute jobs after submit");
+		jobs.push_back(std::move(record));
+	}
+
+	void LveComputeScheduler::releaseBuffer(VkBuffer buffer, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+		assert(!submitted && "Cannot release buffers after submit");
+		releases.push_back({ buffer, dstStages, dstAccess });
+	}
+
+	void LveComputeScheduler::submit(LveRenderer& renderer, VkPipelineStageFlags consumerStages) {
+		assert(!submitted && "Compute work already submitted this frame");
+		submitted = true;
+		if (jobs.empty()) {
+			releases.clear();
+			return;
+		}
+
+		FrameSlot& slot = frameSlots[currentFrameIndex];
+		VkCommandBuffer commandBuffer = slot.commandBuffer;
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording compute command buffer!");
+		}
+
+		uint32_t firstQuery = QUERIES_PER_FRAME * currentFrameIndex + COMPUTE_QUERY;
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(commandBuffer, timestampQueryPool, firstQuery, 2);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, firstQuery);
+		}
+		acquireReturns(commandBuffer, slot);
+		for (auto& job : jobs) {
+			job(commandBuffer);
+		}
+		jobs.clear();
+
+		// exclusive buffers change queue family through a release here and a matching acquire in beginGraphics;
+		// within one family the semaphore wait alone makes the writes visible
+		if (queueFamily != graphicsQueueFamily && !releases.empty()) {
+			std::vector<VkBufferMemoryBarrier> barriers{};
+			for (auto& release : releases) {
+				VkBufferMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+				barrier.srcQueueFamilyIndex = queueFamily;
+				barrier.dstQueueFamilyIndex = graphicsQueueFamily;
+				barrier.buffer = release.buffer;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+				barriers.push_back(barrier);
+			}
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0,
+				0,
+				nullptr,
+				static_cast<uint32_t>(barriers.size()),
+				barriers.data(),
+				0,
+				nullptr);
+		}
+		// kept within one family too, so the slot's next jobs know to wait for graphics' accesses
+		pendingAcquires = std::move(releases);
+		releases.clear();
+
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, firstQuery + 1);
+			slot.computeTimed = true;
+		}
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record compute command buffer!");
+		}
+
+		// without a dedicated queue this submits to the graphics queue, which other threads submit to as well
+		std::unique_lock<std::mutex> queueLock{};
+		if (queue == lveDevice.graphicsQueue()) queueLock = lveDevice.lockGraphicsQueue();
+		uint64_t signalValue = ++lastTimelineValue;
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &timeline;
+		if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit compute command buffer!");
+		}
+		slot.timelineValue = signalValue;
+
+		renderer.addFrameWait(timeline, signalValue, consumerStages);
+	}
+
+	void LveComputeScheduler::acquireReturns(VkCommandBuffer commandBuffer, FrameSlot& slot) {
+		if (slot.returns.empty()) return;
+
+		VkPipelineStageFlags graphicsStages = 0;
+		VkAccessFlags graphicsAccess = 0;
+		for (auto& returned : slot.returns) {
+			graphicsStages |= returned.dstStages;
+			graphicsAccess |= returned.dstAccess;
+		}
+
+		if (queueFamily == graphicsQueueFamily) {
+			// one queue: the slot's graphics came earlier in submission order, so a barrier reaches back to it
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = graphicsAccess;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				graphicsStages,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0,
+				1,
+				&barrier,
+				0,
+				nullptr,
+				0,
+				nullptr);
+			slot.returns.clear();
+			return;
+		}
+
+		// the release in that frame's endGraphics executed before LveRenderer::beginFrame returned from waiting
+		// for the slot, which happens before this submission
+		std::vector<VkBufferMemoryBarrier> barriers{};
+		for (auto& returned : slot.returns) {
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.srcQueueFamilyIndex = graphicsQueueFamily;
+			barrier.dstQueueFamilyIndex = queueFamily;
+			barrier.buffer = returned.buffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			barriers.push_back(barrier);
+		}
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			0,
+			nullptr,
+			static_cast<uint32_t>(barriers.size()),
+			barriers.data(),
+			0,
+			nullptr);
+		slot.returns.clear();
+	}
+
+	void LveComputeScheduler::beginGraphics(VkCommandBuffer commandBuffer) {
+		uint32_t firstQuery = QUERIES_PER_FRAME * currentFrameIndex + GRAPHICS_QUERY;
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(commandBuffer, timestampQueryPool, firstQuery, 2);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, firstQuery);
+		}
+
+		if (pendingAcquires.empty() || queueFamily == graphicsQueueFamily) return;
+		// the acquire's source stages lie within the semaphore wait stages passed to submit, which chains it after
+		// the release
+		VkPipelineStageFlags dstStages = 0;
+		std::vector<VkBufferMemoryBarrier> barriers{};
+		for (auto& acquire : pendingAcquires) {
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = acquire.dstAccess;
+			barrier.srcQueueFamilyIndex = queueFamily;
+			barrier.dstQueueFamilyIndex = graphicsQueueFamily;
+			barrier.buffer = acquire.buffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			barriers.push_back(barrier);
+			dstStages |= acquire.dstStages;
+		}
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			dstStages,
+			dstStages,
+			0,
+			0,
+			nullptr,
+			static_cast<uint32_t>(barriers.size()),
+			barriers.data(),
+			0,
+			nullptr);
+	}
+
+	void LveComputeScheduler::endGraphics(VkCommandBuffer commandBuffer) {
+		// hand this frame's buffers back so the slot's next compute jobs own them again
+		if (!pendingAcquires.empty() && queueFamily != graphicsQueueFamily) {
+			VkPipelineStageFlags srcStages = 0;
+			std::vector<VkBufferMemoryBarrier> barriers{};
+			for (auto& acquired : pendingAcquires) {
+				VkBufferMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.srcAccessMask = acquired.dstAccess;
+				barrier.dstAccessMask = 0;
+				barrier.srcQueueFamilyIndex = graphicsQueueFamily;
+				barrier.dstQueueFamilyIndex = queueFamily;
+				barrier.buffer = acquired.buffer;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+				barriers.push_back(barrier);
+				srcStages |= acquired.dstStages;
+			}
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				srcStages,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0,
+				0,
+				nullptr,
+				static_cast<uint32_t>(barriers.size()),
+				barriers.data(),
+				0,
+				nullptr);
+		}
+		if (!pendingAcquires.empty()) {
+			frameSlots[currentFrameIndex].returns = std::move(pendingAcquires);
+			pendingAcquires.clear();
+		}
+
+		if (timestampQueryPool == VK_NULL_HANDLE) return;
+		uint32_t firstQuery = QUERIES_PER_FRAME * currentFrameIndex + GRAPHICS_QUERY;
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, firstQuery + 1);
+		frameSlots[currentFrameIndex].graphicsTimed = true;
+	}
+}
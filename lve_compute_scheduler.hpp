@@ -0,0 +1,109 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_renderer.hpp"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lve {
+	// Submits per-frame compute work (light binning, culling, particle simulation) to the device's compute queue
+	// so it overlaps the previous frame's graphics, and makes the frame's graphics submission wait for it on a
+	// timeline semaphore of its own (a second queue cannot signal the device timeline in order). On devices
+	// without a compute-only family the same submissions go to the graphics queue and simply run serialized.
+	//
+	// Per frame, after LveRenderer::beginFrame:
+	//   beginFrame -> addJob / releaseBuffer ... -> submit -> beginGraphics(cb) ... endGraphics(cb) -> endFrame
+	// Buffers written by compute and read by graphics must be per frame slot: the CPU wait in beginFrame is what
+	// keeps a slot's compute from overwriting data the graphics of framesInFlight frames ago still reads.
+	//
+	// LveApp has no compute pass yet; benchmarks/async_compute_benchmark.cpp is the only caller.
+	class LveComputeScheduler {
+	public:
+		using RecordFn = std::function<void(VkCommandBuffer commandBuffer)>;
+
+		struct Stats {
+			uint64_t frames = 0;
+			double computeMs = 0.0;
+			double graphicsMs = 0.0;
+			// compute time that ran while the previous or current frame's graphics was executing
+			double overlapMs = 0.0;
+			double overlapFraction() const { return computeMs > 0.0 ? overlapMs / computeMs : 0.0; }
+		};
+
+		// allowDedicatedQueue = false forces the graphics-queue fallback, e.g. to compare against it
+		LveComputeScheduler(LveDevice& device, bool allowDedicatedQueue = true);
+		~LveComputeScheduler();
+
+		LveComputeScheduler(const LveComputeScheduler&) = delete;
+		LveComputeScheduler& operator=(const LveComputeScheduler&) = delete;
+
+		// waits for this slot's previous compute submission and collects its timestamps
+		void beginFrame(int frameIndex);
+		void addJob(RecordFn record);
+		// hands a buffer written by this frame's jobs to the graphics queue family; no-op when both share a family.
+		// endGraphics hands it back, and the next submit in the same frame slot acquires it before the jobs run,
+		// so a per-slot buffer is owned by the compute family whenever its jobs write it
+		void releaseBuffer(VkBuffer buffer, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess);
+		// records and submits the frame's jobs; the renderer's next submission waits for them at consumerStages
+		void submit(LveRenderer& renderer, VkPipelineStageFlags consumerStages);
+		// call first and last in the frame's graphics command buffer, outside any render pass
+		void beginGraphics(VkCommandBuffer commandBuffer);
+		void endGraphics(VkCommandBuffer commandBuffer);
+
+		bool isAsync() const { return queue != lveDevice.graphicsQueue(); }
+		uint32_t getQueueFamily() const { return queueFamily; }
+		const Stats& getStats() const { return stats; }
+
+	private:
+		struct BufferRelease {
+			VkBuffer buffer;
+			VkPipelineStageFlags dstStages;
+			VkAccessFlags dstAccess;
+		};
+
+		struct Interval {
+			uint64_t begin = 0;
+			uint64_t end = 0;
+		};
+
+		struct FrameSlot {
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			uint64_t timelineValue = 0;
+			bool computeTimed = false;
+			bool graphicsTimed = false;
+			// released back to the compute family by this slot's last graphics, acquired by its next submit
+			std::vector<BufferRelease> returns{};
+		};
+
+		void createCommandBuffers();
+		void createTimeline();
+		void createQueryPool();
+		void acquireReturns(VkCommandBuffer commandBuffer, FrameSlot& slot);
+		void collectTimestamps(int frameIndex);
+		bool readInterval(uint32_t firstQuery, Interval& interval);
+		static uint64_t overlapTicks(const Interval& a, const Interval& b);
+
+		LveDevice& lveDevice;
+		uint32_t graphicsQueueFamily;
+		VkQueue queue;
+		uint32_t queueFamily;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkSemaphore timeline = VK_NULL_HANDLE;
+		uint64_t lastTimelineValue = 0;
+		VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+
+		std::vector<FrameSlot> frameSlots{};
+		int currentFrameIndex = 0;
+		std::vector<RecordFn> jobs{};
+		std::vector<BufferRelease> releases{};
+		// acquires the graphics side records for this frame's releases
+		std::vector<BufferRelease> pendingAcquires{};
+		bool submitted = false;
+
+		Interval previousGraphics{};
+		Stats stats{};
+	};
+}
@@ -0,0 +1,85 @@
+#include "lve_deletion_queue.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+	namespace {
+		// never reached by a completed value, so these entries wait until endSubmission gives them theirs
+		constexpr uint64_t NEXT_SUBMISSION = UINT64_MAX;
+	}
+
+	LveDeletionQueue::~LveDeletionQueue() {
+		assert(entries.empty() && "Deletion queue destroyed with pending entries; call flushAll once the device is idle");
+	}
+
+	void LveDeletionQueue::push(uint64_t timelineValue, Deleter deleter) {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.push_back({ timelineValue, std::move(deleter) });
+	}
+
+	void LveDeletionQueue::pushAfterSubmitted(uint64_t lastSubmittedValue, Deleter deleter) {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.push_back({ submissionOpen ? NEXT_SUBMISSION : lastSubmittedValue, std::move(deleter) });
+	}
+
+	void LveDeletionQueue::pushAfterNextSubmission(Deleter deleter) {
+		push(NEXT_SUBMISSION, std::move(deleter));
+	}
+
+	void LveDeletionQueue::beginSubmission() {
+		std::lock_guard<std::mutex> lock(mutex);
+		submissionOpen = true;
+	}
+
+	void LveDeletionQueue::endSubmission(uint64_t timelineValue) {
+		std::lock_guard<std::mutex> lock(mutex);
+		submissionOpen = false;
+		for (auto& entry : entries) {
+			if (entry.timelineValue == NEXT_SUBMISSION) entry.timelineValue = timelineValue;
+		}
+	}
+
+	size_t LveDeletionQueue::flush(uint64_t completedValue) {
+		return flushEntries(completedValue, true);
+	}
+
+	void LveDeletionQueue::flushAll() {
+		// deleters can enqueue further entries, so drain until nothing is left
+		while (flushEntries(UINT64_MAX, false) > 0) {}
+	}
+
+	size_t LveDeletionQueue::flushEntries(uint64_t completedValue, bool respectHolds) {
+		std::vector<Entry> ready{};
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (respectHolds && holds > 0) return 0;
+			// values can arrive out of order from different threads, so scan rather than pop a prefix
+			auto firstPending = std::stable_partition(entries.begin(), entries.end(),
+				[completedValue](const Entry& entry) { return entry.timelineValue <= completedValue; });
+			ready.assign(std::make_move_iterator(entries.begin()), std::make_move_iterator(firstPending));
+			entries.erase(entries.begin(), firstPending);
+		}
+
+		// run outside the lock: a deleter may release an object whose destructor defers more work
+		for (auto& entry : ready) {
+			entry.deleter();
+		}
+		return ready.size();
+	}
+
+	LveDeletionQueue::Hold LveDeletionQueue::hold() {
+		std::lock_guard<std::mutex> lock(mutex);
+		holds++;
+		return Hold(this, [](LveDeletionQueue* queue) {
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			queue->holds--;
+		});
+	}
+
+	size_t LveDeletionQueue::size() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries.size();
+	}
+}
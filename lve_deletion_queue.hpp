@@ -0,0 +1,60 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+	// Defers destruction of GPU-visible objects until the device timeline reaches the value of the last
+	// submission that could reference them, so resources can be released mid-frame without idling the device.
+	// Thread-safe: streaming and compile threads may retire objects while the render thread flushes.
+	class LveDeletionQueue {
+	public:
+		using Deleter = std::function<void()>;
+		// keeps flush from running anything while alive; see hold()
+		using Hold = std::shared_ptr<void>;
+
+		LveDeletionQueue() = default;
+		~LveDeletionQueue();
+
+		LveDeletionQueue(const LveDeletionQueue&) = delete;
+		LveDeletionQueue& operator=(const LveDeletionQueue&) = delete;
+
+		void push(uint64_t timelineValue, Deleter deleter);
+		// waits for the open submission if there is one, whose value is only known once it is made, and
+		// otherwise for lastSubmittedValue
+		void pushAfterSubmitted(uint64_t lastSubmittedValue, Deleter deleter);
+		// waits for the next submission to end even if none is open, e.g. for a present queued behind the last one
+		void pushAfterNextSubmission(Deleter deleter);
+
+		// bracket the recording of a command buffer that deferred deletions may still be referenced by
+		void beginSubmission();
+		void endSubmission(uint64_t timelineValue);
+		// runs every deleter whose value is at or below completedValue; returns how many ran
+		size_t flush(uint64_t completedValue);
+		// only valid once the device is idle
+		void flushAll();
+
+		// For work that uses handles outside of any submission, so the timeline cannot see it, such as pipeline
+		// compiles on worker threads: nothing is destroyed until every hold is released, except by flushAll.
+		Hold hold();
+
+		size_t size() const;
+
+	private:
+		size_t flushEntries(uint64_t completedValue, bool respectHolds);
+
+		struct Entry {
+			uint64_t timelineValue;
+			Deleter deleter;
+		};
+
+		mutable std::mutex mutex;
+		std::vector<Entry> entries{};
+		size_t holds = 0;
+		bool submissionOpen = false;
+	};
+}
@@ -1,11 +1,45 @@
 #include "lve_descriptors.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_descriptor_allocator.hpp"
+#include "lve_descriptor_cache.hpp"
 
 // std
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 
 namespace lve {
 
+    namespace {
+        // packed template data for writer updates, reused so steady-state rewrites do not allocate
+        std::vector<uint8_t>& templateScratch() {
+            thread_local std::vector<uint8_t> scratch{};
+            return scratch;
+        }
+
+        // whether the writes to one binding together set every array element of it
+        bool coversBinding(const VkDescriptorUpdateTemplateEntry& entry, const std::vector<VkWriteDescriptorSet>& writes) {
+            uint64_t covered = 0;
+            for (auto& write : writes) {
+                if (write.dstBinding != entry.dstBinding) continue;
+                if (write.dstArrayElement + write.descriptorCount > entry.descriptorCount) {
+                    return false;
+                }
+                if (write.dstArrayElement == 0 && write.descriptorCount == entry.descriptorCount) {
+                    return true;
+                }
+                if (entry.descriptorCount <= 64) {
+                    uint64_t bits = write.descriptorCount == 64 ? ~0ull : (1ull << write.descriptorCount) - 1;
+                    covered |= bits << write.dstArrayElement;
+                }
+            }
+            // arrays wider than a mask only take the template path when one write spans them
+            return entry.descriptorCount <= 64 &&
+                covered == (entry.descriptorCount == 64 ? ~0ull : (1ull << entry.descriptorCount) - 1);
+        }
+    }
+
     // *************** Descriptor Set Layout Builder *********************
 
     LveDescriptorSetLayout::Builder& LveDescriptorSetLayout::Builder::addBinding(
@@ -23,15 +57,33 @@ namespace lve {
         return *this;
     }
 
+    LveDescriptorSetLayout::Builder& LveDescriptorSetLayout::Builder::enableUpdateTemplate() {
+        updateTemplate = true;
+        return *this;
+    }
+
+    LveDescriptorSetLayout::Builder& LveDescriptorSetLayout::Builder::enablePushDescriptors() {
+        pushDescriptors = true;
+        return *this;
+    }
+
     std::unique_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::Builder::build() const {
-        return std::make_unique<LveDescriptorSetLayout>(lveDevice, bindings);
+        return std::make_unique<LveDescriptorSetLayout>(lveDevice, bindings, updateTemplate, pushDescriptors);
+    }
+
+    std::shared_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::Builder::build(LveDescriptorLayoutCache& cache) const {
+        return cache.getLayout(bindings, updateTemplate, pushDescriptors);
     }
 
     // *************** Descriptor Set Layout *********************
 
     LveDescriptorSetLayout::LveDescriptorSetLayout(
-        LveDevice& lveDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings)
-        : lveDevice{ lveDevice }, bindings{ bindings } {
+        LveDevice& lveDevice,
+        std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+        bool useUpdateTemplate,
+        bool pushDescriptors)
+        : lveDevice{ lveDevice }, bindings{ bindings }, pushDescriptors{ pushDescriptors } {
+        assert((!pushDescriptors || lveDevice.supportsPushDescriptors()) && "VK_KHR_push_descriptor is not enabled");
         std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
         for (auto kv : bindings) {
             setLayoutBindings.push_back(kv.second);
@@ -39,20 +91,161 @@ namespace lve {
 
         VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
         descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutInfo.flags = pushDescriptors ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0;
         descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
         descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
 
         if (vkCreateDescriptorSetLayout(
             lveDevice.device(),
             &descriptorSetLayoutInfo,
-            nullptr,
+            allocationCallbacks(LveMemoryTag::Descriptors),
             &descriptorSetLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor set layout!");
         }
+
+        // push layouts always go through templates, but theirs depend on the pipeline layout and are made on first push
+        if (useUpdateTemplate || pushDescriptors) {
+            createTemplateEntries();
+        }
+        if (useUpdateTemplate && !pushDescriptors) {
+            updateTemplate = createUpdateTemplate(VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET, VK_NULL_HANDLE, 0);
+        }
     }
 
     LveDescriptorSetLayout::~LveDescriptorSetLayout() {
-        vkDestroyDescriptorSetLayout(lveDevice.device(), descriptorSetLayout, nullptr);
+        for (auto& kv : pushTemplates) {
+            vkDestroyDescriptorUpdateTemplate(lveDevice.device(), kv.second, allocationCallbacks(LveMemoryTag::Descriptors));
+        }
+        if (updateTemplate != VK_NULL_HANDLE) {
+            vkDestroyDescriptorUpdateTemplate(lveDevice.device(), updateTemplate, allocationCallbacks(LveMemoryTag::Descriptors));
+        }
+        vkDestroyDescriptorSetLayout(lveDevice.device(), descriptorSetLayout, allocationCallbacks(LveMemoryTag::Descriptors));
+    }
+
+    void LveDescriptorSetLayout::createTemplateEntries() {
+        std::vector<uint32_t> bindingNumbers{};
+        for (auto& kv : bindings) {
+            bindingNumbers.push_back(kv.first);
+        }
+        std::sort(bindingNumbers.begin(), bindingNumbers.end());
+
+        // packed data is every binding in ascending order, each one an array of its info struct, so a POD like
+        //   struct { VkDescriptorBufferInfo ubo; VkDescriptorImageInfo textures[4]; }
+        // can be handed to updateWithTemplate directly
+        size_t offset = 0;
+        for (uint32_t binding : bindingNumbers) {
+            auto& layoutBinding = bindings[binding];
+            size_t stride = descriptorInfoSize(layoutBinding.descriptorType);
+
+            VkDescriptorUpdateTemplateEntry entry{};
+            entry.dstBinding = binding;
+            entry.dstArrayElement = 0;
+            entry.descriptorCount = layoutBinding.descriptorCount;
+            entry.descriptorType = layoutBinding.descriptorType;
+            entry.offset = offset;
+            entry.stride = stride;
+            templateEntries.push_back(entry);
+
+            templateOffsets[binding] = offset;
+            offset += stride * layoutBinding.descriptorCount;
+        }
+        templateDataSize = offset;
+    }
+
+    VkDescriptorUpdateTemplate LveDescriptorSetLayout::createUpdateTemplate(
+        VkDescriptorUpdateTemplateType templateType, VkPipelineLayout pipelineLayout, uint32_t set) const {
+        VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+        templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(templateEntries.size());
+        templateInfo.pDescriptorUpdateEntries = templateEntries.data();
+        templateInfo.templateType = templateType;
+        templateInfo.descriptorSetLayout = descriptorSetLayout;
+        templateInfo.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        templateInfo.pipelineLayout = pipelineLayout;
+        templateInfo.set = set;
+
+        VkDescriptorUpdateTemplate descriptorTemplate;
+        if (vkCreateDescriptorUpdateTemplate(lveDevice.device(), &templateInfo, allocationCallbacks(LveMemoryTag::Descriptors), &descriptorTemplate) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor update template!");
+        }
+        return descriptorTemplate;
+    }
+
+    size_t LveDescriptorSetLayout::descriptorInfoSize(VkDescriptorType descriptorType) {
+        switch (descriptorType) {
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            return sizeof(VkDescriptorBufferInfo);
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            return sizeof(VkBufferView);
+        default:
+            return sizeof(VkDescriptorImageInfo);
+        }
+    }
+
+    size_t LveDescriptorSetLayout::getTemplateOffset(uint32_t binding) const {
+        assert(templateOffsets.count(binding) == 1 && "Layout has no update template or does not contain binding");
+        return templateOffsets.at(binding);
+    }
+
+    void LveDescriptorSetLayout::updateWithTemplate(VkDescriptorSet set, const void* data) const {
+        assert(updateTemplate != VK_NULL_HANDLE && "Layout was built without enableUpdateTemplate()");
+        vkUpdateDescriptorSetWithTemplate(lveDevice.device(), set, updateTemplate, data);
+    }
+
+    void LveDescriptorSetLayout::pushWithTemplate(
+        VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set, const void* data) {
+        assert(pushDescriptors && "Layout was built without enablePushDescriptors()");
+        auto& pushTemplate = pushTemplates[{ pipelineLayout, set }];
+        if (pushTemplate == VK_NULL_HANDLE) {
+            pushTemplate = createUpdateTemplate(VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR, pipelineLayout, set);
+        }
+        lveDevice.cmdPushDescriptorSetWithTemplate(commandBuffer, pushTemplate, pipelineLayout, set, data);
+    }
+
+    bool LveDescriptorSetLayout::packWrites(const std::vector<VkWriteDescriptorSet>& writes, std::vector<uint8_t>& data) const {
+        // a template rewrites every descriptor, so it only applies when the writes cover every element of every binding
+        if (templateEntries.empty()) {
+            return false;
+        }
+        for (auto& entry : templateEntries) {
+            if (!coversBinding(entry, writes)) {
+                return false;
+            }
+        }
+
+        // fully covered, so every byte is written below and the old contents need no clearing
+        data.resize(templateDataSize);
+        for (auto& entry : templateEntries) {
+            for (auto& write : writes) {
+                if (write.dstBinding != entry.dstBinding) continue;
+                uint8_t* dst = data.data() + entry.offset + write.dstArrayElement * entry.stride;
+                const void* src = write.pBufferInfo != nullptr ? static_cast<const void*>(write.pBufferInfo)
+                    : write.pImageInfo != nullptr ? static_cast<const void*>(write.pImageInfo)
+                    : static_cast<const void*>(write.pTexelBufferView);
+                std::memcpy(dst, src, entry.stride * write.descriptorCount);
+            }
+        }
+        return true;
+    }
+
+    void LveDescriptorSetLayout::writeDescriptors(VkDescriptorSet set, const std::vector<VkWriteDescriptorSet>& writes) const {
+        assert(!pushDescriptors && "Push descriptor layouts have no sets to write");
+        // callers rewriting a set every frame should fill a POD at getTemplateOffset() and use updateWithTemplate
+        auto& data = templateScratch();
+        if (updateTemplate != VK_NULL_HANDLE && packWrites(writes, data)) {
+            vkUpdateDescriptorSetWithTemplate(lveDevice.device(), set, updateTemplate, data.data());
+            return;
+        }
+
+        std::vector<VkWriteDescriptorSet> setWrites = writes;
+        for (auto& write : setWrites) {
+            write.dstSet = set;
+        }
+        vkUpdateDescriptorSets(lveDevice.device(), static_cast<uint32_t>(setWrites.size()), setWrites.data(), 0, nullptr);
     }
 
     // *************** Descriptor Pool Builder *********************
@@ -92,14 +285,17 @@ namespace lve {
         descriptorPoolInfo.maxSets = maxSets;
         descriptorPoolInfo.flags = poolFlags;
 
-        if (vkCreateDescriptorPool(lveDevice.device(), &descriptorPoolInfo, nullptr, &descriptorPool) !=
+        if (vkCreateDescriptorPool(lveDevice.device(), &descriptorPoolInfo, allocationCallbacks(LveMemoryTag::Descriptors), &descriptorPool) !=
             VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor pool!");
         }
     }
 
     LveDescriptorPool::~LveDescriptorPool() {
-        vkDestroyDescriptorPool(lveDevice.device(), descriptorPool, nullptr);
+        // sets from this pool may still be bound by frames in flight
+        lveDevice.deferDestruction([device = lveDevice.device(), pool = descriptorPool]() {
+            vkDestroyDescriptorPool(device, pool, allocationCallbacks(LveMemoryTag::Descriptors));
+        });
     }
 
     bool LveDescriptorPool::allocateDescriptor(
@@ -133,7 +329,10 @@ namespace lve {
     // *************** Descriptor Writer *********************
 
     LveDescriptorWriter::LveDescriptorWriter(LveDescriptorSetLayout& setLayout, LveDescriptorPool& pool)
-        : setLayout{ setLayout }, pool{ pool } {}
+        : setLayout{ setLayout }, pool{ &pool } {}
+
+    LveDescriptorWriter::LveDescriptorWriter(LveDescriptorSetLayout& setLayout)
+        : setLayout{ setLayout }, pool{ nullptr } {}
 
     LveDescriptorWriter& LveDescriptorWriter::writeBuffer(
         uint32_t binding, VkDescriptorBufferInfo* bufferInfo) {
@@ -178,7 +377,8 @@ namespace lve {
     }
 
     bool LveDescriptorWriter::build(VkDescriptorSet& set) {
-        bool success = pool.allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
+        assert(pool != nullptr && "Writer was created without a descriptor pool");
+        bool success = pool->allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
         if (!success) {
             return false;
         }
@@ -186,11 +386,30 @@ namespace lve {
         return true;
     }
 
+    void LveDescriptorWriter::build(VkDescriptorSet& set, LveDescriptorAllocator& allocator, int frameIndex) {
+        set = allocator.allocate(setLayout.getDescriptorSetLayout(), frameIndex);
+        overwrite(set);
+    }
+
+    void LveDescriptorWriter::buildPersistent(VkDescriptorSet& set, LveDescriptorAllocator& allocator) {
+        set = allocator.allocatePersistent(setLayout.getDescriptorSetLayout());
+        overwrite(set);
+    }
+
+    void LveDescriptorWriter::build(VkDescriptorSet& set, LveDescriptorSetCache& cache) {
+        set = cache.getSet(setLayout, writes);
+    }
+
     void LveDescriptorWriter::overwrite(VkDescriptorSet& set) {
-        for (auto& write : writes) {
-            write.dstSet = set;
+        setLayout.writeDescriptors(set, writes);
+    }
+
+    void LveDescriptorWriter::push(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set) {
+        auto& data = templateScratch();
+        if (!setLayout.packWrites(writes, data)) {
+            throw std::runtime_error("failed to push descriptors: writes must cover every binding of the layout!");
         }
-        vkUpdateDescriptorSets(pool.lveDevice.device(), writes.size(), writes.data(), 0, nullptr);
+        setLayout.pushWithTemplate(commandBuffer, pipelineLayout, set, data.data());
     }
 
 }
\ No newline at end of file
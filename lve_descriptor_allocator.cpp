@@ -0,0 +1,157 @@
+#include "lve_descriptor_allocator.hpp"
+
+#include "lve_allocation_tracker.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+    // *************** Descriptor Allocator Builder *********************
+
+    LveDescriptorAllocator::Builder& LveDescriptorAllocator::Builder::addPoolSizeRatio(
+        VkDescriptorType descriptorType, float ratio) {
+        ratios.push_back({ descriptorType, ratio });
+        return *this;
+    }
+
+    LveDescriptorAllocator::Builder& LveDescriptorAllocator::Builder::setFramesInFlight(uint32_t count) {
+        framesInFlight = count;
+        return *this;
+    }
+
+    LveDescriptorAllocator::Builder& LveDescriptorAllocator::Builder::setInitialSetsPerPool(uint32_t count) {
+        initialSetsPerPool = count;
+        return *this;
+    }
+
+    LveDescriptorAllocator::Builder& LveDescriptorAllocator::Builder::setMaxSetsPerPool(uint32_t count) {
+        maxSetsPerPool = count;
+        return *this;
+    }
+
+    std::unique_ptr<LveDescriptorAllocator> LveDescriptorAllocator::Builder::build() const {
+        return std::make_unique<LveDescriptorAllocator>(
+            lveDevice, ratios, framesInFlight, initialSetsPerPool, maxSetsPerPool);
+    }
+
+    // *************** Descriptor Allocator *********************
+
+    LveDescriptorAllocator::LveDescriptorAllocator(
+        LveDevice& lveDevice,
+        std::vector<PoolSizeRatio> ratios,
+        uint32_t framesInFlight,
+        uint32_t initialSetsPerPool,
+        uint32_t maxSetsPerPool)
+        : lveDevice{ lveDevice },
+        ratios{ std::move(ratios) },
+        nextSetsPerPool{ initialSetsPerPool },
+        maxSetsPerPool{ std::max(initialSetsPerPool, maxSetsPerPool) },
+        frames(framesInFlight) {
+        assert(!this->ratios.empty() && "Descriptor allocator needs at least one pool size ratio");
+        assert(framesInFlight > 0 && "Descriptor allocator needs at least one frame in flight");
+    }
+
+    LveDescriptorAllocator::~LveDescriptorAllocator() {
+        lveDevice.deferDestruction([device = lveDevice.device(), pools = allPools]() {
+            for (auto pool : pools) {
+                vkDestroyDescriptorPool(device, pool, allocationCallbacks(LveMemoryTag::Descriptors));
+            }
+        });
+    }
+
+    void LveDescriptorAllocator::beginFrame(int frameIndex) {
+        assert(frameIndex >= 0 && frameIndex < static_cast<int>(frames.size()) && "Frame index out of range");
+        auto& chain = frames[frameIndex];
+        if (chain.currentPool != VK_NULL_HANDLE) {
+            chain.fullPools.push_back(chain.currentPool);
+            chain.currentPool = VK_NULL_HANDLE;
+        }
+
+        // resetting a pool returns every set allocated from it at once, no vkFreeDescriptorSets needed
+        for (auto pool : chain.fullPools) {
+            vkResetDescriptorPool(lveDevice.device(), pool, 0);
+            readyPools.push_back(pool);
+            stats.poolResets++;
+        }
+        chain.fullPools.clear();
+    }
+
+    VkDescriptorSet LveDescriptorAllocator::allocate(VkDescriptorSetLayout descriptorSetLayout, int frameIndex) {
+        assert(frameIndex >= 0 && frameIndex < static_cast<int>(frames.size()) && "Frame index out of range");
+        stats.frameAllocations++;
+        return allocateFrom(frames[frameIndex], descriptorSetLayout);
+    }
+
+    VkDescriptorSet LveDescriptorAllocator::allocatePersistent(VkDescriptorSetLayout descriptorSetLayout) {
+        stats.persistentAllocations++;
+        return allocateFrom(persistent, descriptorSetLayout);
+    }
+
+    VkDescriptorSet LveDescriptorAllocator::allocateFrom(PoolChain& chain, VkDescriptorSetLayout descriptorSetLayout) {
+        LVE_MEMORY_SCOPE(LveMemoryTag::Descriptors);
+        if (chain.currentPool == VK_NULL_HANDLE) {
+            chain.currentPool = acquirePool();
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = chain.currentPool;
+        allocInfo.pSetLayouts = &descriptorSetLayout;
+        allocInfo.descriptorSetCount = 1;
+
+        VkDescriptorSet descriptorSet;
+        VkResult result = vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptorSet);
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+            // retire the exhausted pool into the chain and continue in a fresh one
+            chain.fullPools.push_back(chain.currentPool);
+            chain.currentPool = acquirePool();
+            allocInfo.descriptorPool = chain.currentPool;
+            result = vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptorSet);
+        }
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor set!");
+        }
+        return descriptorSet;
+    }
+
+    VkDescriptorPool LveDescriptorAllocator::acquirePool() {
+        if (!readyPools.empty()) {
+            VkDescriptorPool pool = readyPools.back();
+            readyPools.pop_back();
+            return pool;
+        }
+
+        VkDescriptorPool pool = createPool(nextSetsPerPool);
+        // each new pool is larger than the last so steady state settles on a handful of pools
+        nextSetsPerPool = std::min(nextSetsPerPool * 2, maxSetsPerPool);
+        return pool;
+    }
+
+    VkDescriptorPool LveDescriptorAllocator::createPool(uint32_t maxSets) {
+        std::vector<VkDescriptorPoolSize> poolSizes{};
+        poolSizes.reserve(ratios.size());
+        for (auto& ratio : ratios) {
+            uint32_t count = std::max(1u, static_cast<uint32_t>(ratio.ratio * maxSets));
+            poolSizes.push_back({ ratio.type, count });
+        }
+
+        VkDescriptorPoolCreateInfo descriptorPoolInfo{};
+        descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        descriptorPoolInfo.pPoolSizes = poolSizes.data();
+        descriptorPoolInfo.maxSets = maxSets;
+        descriptorPoolInfo.flags = 0;
+
+        VkDescriptorPool pool;
+        if (vkCreateDescriptorPool(lveDevice.device(), &descriptorPoolInfo, allocationCallbacks(LveMemoryTag::Descriptors), &pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor pool!");
+        }
+        allPools.push_back(pool);
+        stats.poolsCreated++;
+        return pool;
+    }
+
+}
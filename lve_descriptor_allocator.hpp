@@ -0,0 +1,90 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+    // Hands out descriptor sets from chains of pools that grow on exhaustion instead of failing.
+    // Per-frame sets live until beginFrame() is called again for the same frame index, at which point
+    // every pool of that frame is reset in bulk. Persistent sets come from a separate tier that is
+    // never reset, so long-lived sets do not pin per-frame pools.
+    class LveDescriptorAllocator {
+    public:
+        struct PoolSizeRatio {
+            VkDescriptorType type;
+            float ratio;
+        };
+
+        class Builder {
+        public:
+            Builder(LveDevice& lveDevice) : lveDevice{ lveDevice } {}
+
+            Builder& addPoolSizeRatio(VkDescriptorType descriptorType, float ratio);
+            Builder& setFramesInFlight(uint32_t count);
+            Builder& setInitialSetsPerPool(uint32_t count);
+            Builder& setMaxSetsPerPool(uint32_t count);
+            std::unique_ptr<LveDescriptorAllocator> build() const;
+
+        private:
+            LveDevice& lveDevice;
+            std::vector<PoolSizeRatio> ratios{};
+            uint32_t framesInFlight = 2;
+            uint32_t initialSetsPerPool = 64;
+            uint32_t maxSetsPerPool = 4096;
+        };
+
+        struct Stats {
+            uint32_t poolsCreated = 0;
+            uint32_t poolResets = 0;
+            uint64_t frameAllocations = 0;
+            uint64_t persistentAllocations = 0;
+        };
+
+        LveDescriptorAllocator(
+            LveDevice& lveDevice,
+            std::vector<PoolSizeRatio> ratios,
+            uint32_t framesInFlight,
+            uint32_t initialSetsPerPool,
+            uint32_t maxSetsPerPool);
+        ~LveDescriptorAllocator();
+        LveDescriptorAllocator(const LveDescriptorAllocator&) = delete;
+        LveDescriptorAllocator& operator=(const LveDescriptorAllocator&) = delete;
+
+        // must only be called once the previous submission using frameIndex has completed
+        void beginFrame(int frameIndex);
+
+        VkDescriptorSet allocate(VkDescriptorSetLayout descriptorSetLayout, int frameIndex);
+        VkDescriptorSet allocatePersistent(VkDescriptorSetLayout descriptorSetLayout);
+
+        uint32_t getFramesInFlight() const { return static_cast<uint32_t>(frames.size()); }
+        const Stats& getStats() const { return stats; }
+
+    private:
+        struct PoolChain {
+            std::vector<VkDescriptorPool> fullPools{};
+            VkDescriptorPool currentPool = VK_NULL_HANDLE;
+        };
+
+        VkDescriptorSet allocateFrom(PoolChain& chain, VkDescriptorSetLayout descriptorSetLayout);
+        VkDescriptorPool acquirePool();
+        VkDescriptorPool createPool(uint32_t maxSets);
+
+        LveDevice& lveDevice;
+        std::vector<PoolSizeRatio> ratios;
+        uint32_t nextSetsPerPool;
+        uint32_t maxSetsPerPool;
+
+        std::vector<PoolChain> frames;
+        PoolChain persistent{};
+        // reset pools waiting to be picked up by any chain
+        std::vector<VkDescriptorPool> readyPools{};
+        std::vector<VkDescriptorPool> allPools{};
+
+        Stats stats{};
+    };
+
+}
@@ -0,0 +1,166 @@
+#include "lve_descriptor_cache.hpp"
+
+#include "lve_allocation_tracker.hpp"
+#include "lve_pipeline_key.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+
+    // *************** Descriptor Layout Cache *********************
+
+    std::shared_ptr<LveDescriptorSetLayout> LveDescriptorLayoutCache::getLayout(
+        const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+        bool useUpdateTemplate,
+        bool pushDescriptors) {
+        LVE_MEMORY_SCOPE(LveMemoryTag::Descriptors);
+        std::vector<VkDescriptorSetLayoutBinding> sortedBindings{};
+        sortedBindings.reserve(bindings.size());
+        for (auto& kv : bindings) {
+            sortedBindings.push_back(kv.second);
+        }
+        std::sort(sortedBindings.begin(), sortedBindings.end(),
+            [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+                return a.binding < b.binding;
+            });
+
+        std::string key;
+        key.reserve(2 + sortedBindings.size() * sizeof(VkDescriptorSetLayoutBinding));
+        appendKey(key, useUpdateTemplate);
+        appendKey(key, pushDescriptors);
+        for (auto& binding : sortedBindings) {
+            appendKey(key, binding.binding);
+            appendKey(key, binding.descriptorType);
+            appendKey(key, binding.descriptorCount);
+            appendKey(key, binding.stageFlags);
+            appendKey(key, binding.pImmutableSamplers);
+        }
+
+        auto it = layouts.find(key);
+        if (it != layouts.end()) {
+            stats.hits++;
+            return it->second;
+        }
+
+        stats.misses++;
+        auto layout = std::make_shared<LveDescriptorSetLayout>(lveDevice, bindings, useUpdateTemplate, pushDescriptors);
+        layouts.emplace(std::move(key), layout);
+        return layout;
+    }
+
+    // *************** Descriptor Set Cache *********************
+
+    LveDescriptorSetCache::LveDescriptorSetCache(
+        LveDevice& lveDevice, LveDescriptorAllocator& allocator, uint32_t maxUnusedFrames)
+        : lveDevice{ lveDevice }, allocator{ allocator }, maxUnusedFrames{ maxUnusedFrames } {
+        assert(maxUnusedFrames >= allocator.getFramesInFlight() &&
+            "Descriptor sets could be evicted while a frame in flight still uses them");
+    }
+
+    void LveDescriptorSetCache::beginFrame() {
+        currentFrame++;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (currentFrame - it->second.lastUsedFrame > maxUnusedFrames) {
+                freeSets[it->second.layout].push_back(it->second.set);
+                stats.evictions++;
+                it = entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        for (auto it = invalidatedEntries.begin(); it != invalidatedEntries.end();) {
+            if (currentFrame - it->lastUsedFrame > maxUnusedFrames) {
+                freeSets[it->layout].push_back(it->set);
+                it = invalidatedEntries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    void LveDescriptorSetCache::invalidateHandle(uint64_t handle) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto& resources = it->second.resources;
+            if (std::find(resources.begin(), resources.end(), handle) != resources.end()) {
+                invalidatedEntries.push_back(std::move(it->second));
+                stats.evictions++;
+                it = entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    VkDescriptorSet LveDescriptorSetCache::getSet(
+        const LveDescriptorSetLayout& setLayout, const std::vector<VkWriteDescriptorSet>& writes) {
+        LVE_MEMORY_SCOPE(LveMemoryTag::Descriptors);
+        VkDescriptorSetLayout layout = setLayout.getDescriptorSetLayout();
+
+        // writes are keyed in binding order so the same resources written in a different order still hit
+        std::vector<const VkWriteDescriptorSet*> sortedWrites{};
+        sortedWrites.reserve(writes.size());
+        for (auto& write : writes) {
+            sortedWrites.push_back(&write);
+        }
+        std::sort(sortedWrites.begin(), sortedWrites.end(),
+            [](const VkWriteDescriptorSet* a, const VkWriteDescriptorSet* b) {
+                return a->dstBinding != b->dstBinding ? a->dstBinding < b->dstBinding : a->dstArrayElement < b->dstArrayElement;
+            });
+
+        std::string key;
+        std::vector<uint64_t> resources{};
+        appendKey(key, layout);
+        for (auto write : sortedWrites) {
+            appendKey(key, write->dstBinding);
+            appendKey(key, write->dstArrayElement);
+            appendKey(key, write->descriptorType);
+            for (uint32_t i = 0; i < write->descriptorCount; i++) {
+                if (write->pBufferInfo != nullptr) {
+                    appendKey(key, write->pBufferInfo[i].buffer);
+                    appendKey(key, write->pBufferInfo[i].offset);
+                    appendKey(key, write->pBufferInfo[i].range);
+                    resources.push_back(handleValue(write->pBufferInfo[i].buffer));
+                }
+                else if (write->pImageInfo != nullptr) {
+                    appendKey(key, write->pImageInfo[i].sampler);
+                    appendKey(key, write->pImageInfo[i].imageView);
+                    appendKey(key, write->pImageInfo[i].imageLayout);
+                    resources.push_back(handleValue(write->pImageInfo[i].imageView));
+                }
+                else if (write->pTexelBufferView != nullptr) {
+                    appendKey(key, write->pTexelBufferView[i]);
+                }
+            }
+        }
+
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            stats.hits++;
+            it->second.lastUsedFrame = currentFrame;
+            return it->second.set;
+        }
+
+        stats.misses++;
+        VkDescriptorSet set;
+        auto& recycledSets = freeSets[layout];
+        if (!recycledSets.empty()) {
+            set = recycledSets.back();
+            recycledSets.pop_back();
+            stats.recycled++;
+        }
+        else {
+            set = allocator.allocatePersistent(layout);
+        }
+
+        setLayout.writeDescriptors(set, writes);
+
+        entries.emplace(std::move(key), Entry{ set, layout, currentFrame, std::move(resources) });
+        return set;
+    }
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "lve_descriptor_allocator.hpp"
+#include "lve_descriptors.hpp"
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+    // Shares one LveDescriptorSetLayout between all builders that declare the same bindings.
+    class LveDescriptorLayoutCache {
+    public:
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            double hitRate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses); }
+        };
+
+        LveDescriptorLayoutCache(LveDevice& lveDevice) : lveDevice{ lveDevice } {}
+        LveDescriptorLayoutCache(const LveDescriptorLayoutCache&) = delete;
+        LveDescriptorLayoutCache& operator=(const LveDescriptorLayoutCache&) = delete;
+
+        std::shared_ptr<LveDescriptorSetLayout> getLayout(
+            const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+            bool useUpdateTemplate = false,
+            bool pushDescriptors = false);
+
+        const Stats& getStats() const { return stats; }
+
+    private:
+        LveDevice& lveDevice;
+        std::unordered_map<std::string, std::shared_ptr<LveDescriptorSetLayout>> layouts{};
+        Stats stats{};
+    };
+
+    // Returns an existing descriptor set when the same layout is written with the same resources, so repeated
+    // binds skip both allocation and vkUpdateDescriptorSets. Sets unused for maxUnusedFrames frames are evicted
+    // into a per-layout free list and rewritten for the next miss on that layout instead of being freed.
+    // Entries are keyed by raw handles, which the driver may reuse for a new resource once the old one is destroyed,
+    // so owners call invalidate() with each cached buffer or image view before destroying it.
+    class LveDescriptorSetCache {
+    public:
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            uint64_t recycled = 0;
+            double hitRate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses); }
+        };
+
+        // maxUnusedFrames must cover the frames in flight so an evicted set is never still in use by the GPU
+        LveDescriptorSetCache(LveDevice& lveDevice, LveDescriptorAllocator& allocator, uint32_t maxUnusedFrames);
+        LveDescriptorSetCache(const LveDescriptorSetCache&) = delete;
+        LveDescriptorSetCache& operator=(const LveDescriptorSetCache&) = delete;
+
+        void beginFrame();
+
+        VkDescriptorSet getSet(const LveDescriptorSetLayout& setLayout, const std::vector<VkWriteDescriptorSet>& writes);
+
+        // drops every set that references the resource; the sets are recycled once the frames in flight are done with them
+        void invalidate(VkBuffer buffer) { invalidateHandle(handleValue(buffer)); }
+        void invalidate(VkImageView imageView) { invalidateHandle(handleValue(imageView)); }
+
+        size_t size() const { return entries.size(); }
+        const Stats& getStats() const { return stats; }
+
+    private:
+        struct Entry {
+            VkDescriptorSet set;
+            VkDescriptorSetLayout layout;
+            uint64_t lastUsedFrame;
+            // buffers and image views the set was written with
+            std::vector<uint64_t> resources;
+        };
+
+        // non-dispatchable handles are pointers on 64-bit targets and uint64_t elsewhere
+        template <typename T>
+        static uint64_t handleValue(T handle) {
+            uint64_t value = 0;
+            std::memcpy(&value, &handle, sizeof(handle));
+            return value;
+        }
+        void invalidateHandle(uint64_t handle);
+
+        LveDevice& lveDevice;
+        LveDescriptorAllocator& allocator;
+        uint32_t maxUnusedFrames;
+        uint64_t currentFrame = 0;
+
+        std::unordered_map<std::string, Entry> entries{};
+        // invalidated entries wait here until no frame in flight can still be using them
+        std::vector<Entry> invalidatedEntries{};
+        std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>> freeSets{};
+        Stats stats{};
+    };
+
+}
@@ -1,11 +1,26 @@
 #include "lve_device.hpp"
 
+#include "lve_allocation_tracker.hpp"
+#include "lve_profiler.hpp"
+
 // std headers
+#include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_set>
 
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
 namespace lve {
 
 	// local callback functions
@@ -47,26 +62,55 @@ namespace lve {
 		}
 	}
 
+	// on-disk pipeline cache: a small engine header followed by the driver's opaque blob
+	static constexpr const char* PIPELINE_CACHE_FILE = ENGINE_DIR "pipeline_cache.bin";
+	static constexpr uint32_t PIPELINE_CACHE_FILE_MAGIC = 0x4350564c; // "LVPC"
+	static constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+	struct PipelineCacheFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t dataSize;
+	};
+
 	// class member functions
-	LveDevice::LveDevice(LveWindow& window) : window{ window } {
+	LveDevice::LveDevice(LveWindow& window) : LveDevice{ &window } {}
+
+	// a null window selects headless mode: no surface, no surface/swapchain extensions, no present queue
+	LveDevice::LveDevice(LveWindow* window) : window{ window } {
 		createInstance();
 		setupDebugMessenger();
 		createSurface();
 		pickPhysicalDevice();
 		createLogicalDevice();
 		createCommandPool();
+		createTimeline();
+		createPipelineCache();
 	}
 
 	LveDevice::~LveDevice() {
-		vkDestroyCommandPool(device_, commandPool, nullptr);
-		vkDestroyDevice(device_, nullptr);
+		// objects destroyed after the last frame are still queued; nothing can be in flight once idle
+		vkDeviceWaitIdle(device_);
+		deletionQueue.flushAll();
+
+		savePipelineCache();
+		vkDestroyPipelineCache(device_, pipelineCache_, allocationCallbacks(LveMemoryTag::Device));
+		vkDestroySemaphore(device_, timeline_, allocationCallbacks(LveMemoryTag::Device));
+		vkDestroyCommandPool(device_, commandPool, allocationCallbacks(LveMemoryTag::Device));
+		for (auto& kv : singleTimeCommandPools) {
+			vkDestroyCommandPool(device_, kv.second, allocationCallbacks(LveMemoryTag::Device));
+		}
+		vkDestroyDevice(device_, allocationCallbacks(LveMemoryTag::Device));
 
 		if (enableValidationLayers) {
-			DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+			DestroyDebugUtilsMessengerEXT(instance, debugMessenger, allocationCallbacks(LveMemoryTag::Device));
 		}
 
-		vkDestroySurfaceKHR(instance, surface_, nullptr);
-		vkDestroyInstance(instance, nullptr);
+		// headless instances never enable VK_KHR_surface, so its entry points must not be called
+		if (!isHeadless()) {
+			vkDestroySurfaceKHR(instance, surface_, allocationCallbacks(LveMemoryTag::Device));
+		}
+		vkDestroyInstance(instance, allocationCallbacks(LveMemoryTag::Device));
 	}
 
 	void LveDevice::createInstance() {
@@ -80,7 +124,8 @@ namespace lve {
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		// 1.2 for vkGetPhysicalDeviceFeatures2 and the feature structs optional extensions are probed with
+		appInfo.apiVersion = VK_API_VERSION_1_2;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -103,7 +148,7 @@ namespace lve {
 			createInfo.pNext = nullptr;
 		}
 
-		if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS) {
+		if (vkCreateInstance(&createInfo, allocationCallbacks(LveMemoryTag::Device), &instance) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create instance!");
 		}
 
@@ -131,14 +176,34 @@ namespace lve {
 		//	throw std::runtime_error("failed to find a suitable GPU!");
 		//}
 
-		for (const auto& device : devices) {
-			int score = rateDeviceSuitability(device);
-			candidates.insert(std::make_pair(score, device));
+		// LVE_PHYSICAL_DEVICE=<name substring> pins a device, e.g. "llvmpipe" to force lavapipe on CI nodes
+		const char* requestedDevice = std::getenv("LVE_PHYSICAL_DEVICE");
+		if (requestedDevice != nullptr) {
+			for (const auto& device : devices) {
+				VkPhysicalDeviceProperties deviceProperties;
+				vkGetPhysicalDeviceProperties(device, &deviceProperties);
+				if (std::strstr(deviceProperties.deviceName, requestedDevice) != nullptr) {
+					physicalDevice = device;
+					break;
+				}
+			}
+			if (physicalDevice == VK_NULL_HANDLE) {
+				throw std::runtime_error(std::string("failed to find requested GPU: ") + requestedDevice);
+			}
 		}
+		else {
+			for (const auto& device : devices) {
+				int score = rateDeviceSuitability(device);
+				candidates.insert(std::make_pair(score, device));
+			}
 
-		// Check if the best candidate is suitable at all
-		if (candidates.rbegin()->first > 0) {
-			physicalDevice = candidates.rbegin()->second;
+			// Check if the best candidate is suitable at all
+			if (candidates.rbegin()->first > 0) {
+				physicalDevice = candidates.rbegin()->second;
+			}
+			else {
+				throw std::runtime_error("failed to find a suitable GPU!");
+			}
 		}
 
 		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
@@ -175,6 +240,9 @@ namespace lve {
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily };
+		if (indices.computeFamilyHasValue) {
+			uniqueQueueFamilies.insert(indices.computeFamily);
+		}
 
 		float queuePriority = 1.0f;
 		for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -186,18 +254,104 @@ namespace lve {
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
-		VkPhysicalDeviceFeatures deviceFeatures = {};
-		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		// timeline semaphores are core in 1.2 and mandatory; frame pacing, uploads and deferred destruction use them
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		timelineFeatures.timelineSemaphore = VK_TRUE;
+
+		VkPhysicalDeviceFeatures2 deviceFeatures2 = {};
+		deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		deviceFeatures2.pNext = &timelineFeatures;
+		deviceFeatures2.features.samplerAnisotropy = VK_TRUE;
+
+		// optional: pipeline statistics queries, used by LvePipelineStatistics when present
+		{
+			VkPhysicalDeviceFeatures supported;
+			vkGetPhysicalDeviceFeatures(physicalDevice, &supported);
+			deviceFeatures2.features.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+			pipelineStatisticsQuerySupported = supported.pipelineStatisticsQuery == VK_TRUE;
+		}
+		std::cout << "Pipeline statistics queries: " << (pipelineStatisticsQuerySupported ? "enabled" : "unavailable") << std::endl;
+
+		std::vector<const char*> enabledExtensions = requiredDeviceExtensions();
+
+		// optional: VK_EXT_graphics_pipeline_library, used by LvePipelineLibrary when present
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures = {};
+		pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		if (hasDeviceExtension(physicalDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+			hasDeviceExtension(physicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+			VkPhysicalDeviceFeatures2 supported = {};
+			supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supported.pNext = &pipelineLibraryFeatures;
+			vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+			pipelineLibraryFeatures.pNext = nullptr;
+
+			if (pipelineLibraryFeatures.graphicsPipelineLibrary) {
+				enabledExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+				enabledExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+				pipelineLibraryFeatures.pNext = deviceFeatures2.pNext;
+				deviceFeatures2.pNext = &pipelineLibraryFeatures;
+				graphicsPipelineLibrarySupported = true;
+			}
+		}
+		std::cout << "Graphics pipeline library: " << (graphicsPipelineLibrarySupported ? "enabled" : "unavailable") << std::endl;
+
+		// optional: descriptor indexing (core in 1.2), used by LveBindlessDescriptors when present
+		VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+		{
+			VkPhysicalDeviceFeatures2 supported = {};
+			supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supported.pNext = &indexingFeatures;
+			vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+		}
+		if (indexingFeatures.runtimeDescriptorArray &&
+			indexingFeatures.descriptorBindingPartiallyBound &&
+			indexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+			indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+			indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+			indexingFeatures.shaderSampledImageArrayNonUniformIndexing) {
+			// enable only what the bindless set uses
+			VkPhysicalDeviceDescriptorIndexingFeatures supportedIndexing = indexingFeatures;
+			indexingFeatures = {};
+			indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+			indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+			indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+			indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+			indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+			indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+			indexingFeatures.shaderStorageBufferArrayNonUniformIndexing = supportedIndexing.shaderStorageBufferArrayNonUniformIndexing;
+			indexingFeatures.pNext = deviceFeatures2.pNext;
+			deviceFeatures2.pNext = &indexingFeatures;
+			descriptorIndexingSupported = true;
+
+			descriptorIndexingProperties = {};
+			descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+			VkPhysicalDeviceProperties2 properties2 = {};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			properties2.pNext = &descriptorIndexingProperties;
+			vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+			descriptorIndexingProperties.pNext = nullptr;
+		}
+		std::cout << "Descriptor indexing: " << (descriptorIndexingSupported ? "enabled" : "unavailable") << std::endl;
+
+		// optional: VK_KHR_push_descriptor, used by push-descriptor set layouts
+		if (hasDeviceExtension(physicalDevice, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)) {
+			enabledExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+			pushDescriptorSupported = true;
+		}
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = &deviceFeatures2;
 
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
-		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+		createInfo.pEnabledFeatures = nullptr;
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 		// might not really be necessary anymore because device specific validation layers
 		// have been deprecated
@@ -209,12 +363,24 @@ namespace lve {
 			createInfo.enabledLayerCount = 0;
 		}
 
-		if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device_) != VK_SUCCESS) {
+		if (vkCreateDevice(physicalDevice, &createInfo, allocationCallbacks(LveMemoryTag::Device), &device_) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create logical device!");
 		}
 
 		vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
 		vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+
+		// without a compute-only family, compute work shares the graphics queue and runs serialized with it
+		computeQueueFamily_ = indices.computeFamilyHasValue ? indices.computeFamily : indices.graphicsFamily;
+		vkGetDeviceQueue(device_, computeQueueFamily_, 0, &computeQueue_);
+		std::cout << "Async compute: " << (indices.computeFamilyHasValue
+			? "dedicated queue family " + std::to_string(computeQueueFamily_)
+			: std::string("unavailable, sharing the graphics queue")) << std::endl;
+
+		if (pushDescriptorSupported) {
+			pushDescriptorSetWithTemplate = reinterpret_cast<PFN_vkCmdPushDescriptorSetWithTemplateKHR>(
+				vkGetDeviceProcAddr(device_, "vkCmdPushDescriptorSetWithTemplateKHR"));
+		}
 	}
 
 	void LveDevice::createCommandPool() {
@@ -226,20 +392,171 @@ namespace lve {
 		poolInfo.flags =
 			VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-		if (vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+		if (vkCreateCommandPool(device_, &poolInfo, allocationCallbacks(LveMemoryTag::Device), &commandPool) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create command pool!");
 		}
 	}
 
-	void LveDevice::createSurface() { window.createWindowSurface(instance, &surface_); }
+	VkCommandPool LveDevice::getSingleTimeCommandPool() {
+		// a pool and everything recorded from it must stay on one thread at a time, and uploads run on workers
+		// while the main thread records frames from commandPool, so each thread gets its own transient pool
+		std::lock_guard<std::mutex> lock(singleTimeCommandPoolsMutex);
+		auto it = singleTimeCommandPools.find(std::this_thread::get_id());
+		if (it != singleTimeCommandPools.end()) {
+			return it->second;
+		}
+
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = findPhysicalQueueFamilies().graphicsFamily;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		VkCommandPool pool;
+		if (vkCreateCommandPool(device_, &poolInfo, allocationCallbacks(LveMemoryTag::Device), &pool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create single time command pool!");
+		}
+		singleTimeCommandPools.emplace(std::this_thread::get_id(), pool);
+		return pool;
+	}
+
+	void LveDevice::createPipelineCache() {
+		std::vector<char> initialData = loadPipelineCacheData();
+		pipelineCacheLoaded = !initialData.empty();
+
+		// one cache shared by every compile thread: without EXTERNALLY_SYNCHRONIZED the driver locks it internally,
+		// which costs less than keeping a cache per thread and merging them
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = initialData.size();
+		cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+		if (vkCreatePipelineCache(device_, &cacheInfo, allocationCallbacks(LveMemoryTag::Device), &pipelineCache_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+		std::cout << "Pipeline cache: " << (pipelineCacheLoaded ? "warm" : "cold") << std::endl;
+	}
+
+	void LveDevice::resetPipelineCache() {
+		// for measuring compile cost from cold: nothing may be compiling, and the emptied cache is not written back
+		// so the warm file on disk survives the measurement
+		vkDestroyPipelineCache(device_, pipelineCache_, allocationCallbacks(LveMemoryTag::Device));
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		if (vkCreatePipelineCache(device_, &cacheInfo, allocationCallbacks(LveMemoryTag::Device), &pipelineCache_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+		pipelineCacheLoaded = false;
+		pipelineCachePersistent = false;
+	}
+
+	std::vector<char> LveDevice::loadPipelineCacheData() {
+		std::ifstream file(PIPELINE_CACHE_FILE, std::ios::binary);
+		if (!file.is_open()) {
+			return {};
+		}
+
+		PipelineCacheFileHeader fileHeader{};
+		file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+		if (!file || fileHeader.magic != PIPELINE_CACHE_FILE_MAGIC ||
+			fileHeader.version != PIPELINE_CACHE_FILE_VERSION) {
+			std::cout << "Pipeline cache: discarding file with unknown version" << std::endl;
+			return {};
+		}
+
+		// the size comes from disk, so check it against what the file holds before allocating for it
+		const std::streampos dataStart = file.tellg();
+		file.seekg(0, std::ios::end);
+		const std::streamoff remaining = file.tellg() - dataStart;
+		if (!file || remaining < 0 || fileHeader.dataSize > static_cast<uint64_t>(remaining)) {
+			std::cout << "Pipeline cache: discarding truncated or corrupt file" << std::endl;
+			return {};
+		}
+		file.seekg(dataStart);
+
+		std::vector<char> data(static_cast<size_t>(fileHeader.dataSize));
+		file.read(data.data(), data.size());
+		if (!file || !isPipelineCacheCompatible(data)) {
+			std::cout << "Pipeline cache: discarding file from a different device or driver" << std::endl;
+			return {};
+		}
+		return data;
+	}
+
+	bool LveDevice::isPipelineCacheCompatible(const std::vector<char>& data) {
+		// layout of VkPipelineCacheHeaderVersionOne, read field by field to stay independent of padding
+		constexpr size_t headerSize = 16 + VK_UUID_SIZE;
+		if (data.size() < headerSize) {
+			return false;
+		}
+
+		uint32_t length, version, vendorID, deviceID;
+		memcpy(&length, data.data() + 0, sizeof(uint32_t));
+		memcpy(&version, data.data() + 4, sizeof(uint32_t));
+		memcpy(&vendorID, data.data() + 8, sizeof(uint32_t));
+		memcpy(&deviceID, data.data() + 12, sizeof(uint32_t));
+
+		return length >= headerSize &&
+			version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			vendorID == properties.vendorID &&
+			deviceID == properties.deviceID &&
+			memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+
+	void LveDevice::savePipelineCache() {
+		if (!pipelineCachePersistent) {
+			return;
+		}
+		size_t dataSize = 0;
+		if (vkGetPipelineCacheData(device_, pipelineCache_, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+			return;
+		}
+		std::vector<char> data(dataSize);
+		if (vkGetPipelineCacheData(device_, pipelineCache_, &dataSize, data.data()) != VK_SUCCESS) {
+			return;
+		}
+
+		// write next to the real file and swap it in, so a crash mid-write never leaves a torn cache
+		const std::string tmpPath = std::string(PIPELINE_CACHE_FILE) + ".tmp";
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				std::cerr << "failed to write pipeline cache!" << std::endl;
+				return;
+			}
+			PipelineCacheFileHeader fileHeader{ PIPELINE_CACHE_FILE_MAGIC, PIPELINE_CACHE_FILE_VERSION, dataSize };
+			file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+			file.write(data.data(), dataSize);
+			if (!file) {
+				std::cerr << "failed to write pipeline cache!" << std::endl;
+				return;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, PIPELINE_CACHE_FILE, ec);
+		if (ec) {
+			std::cerr << "failed to replace pipeline cache: " << ec.message() << std::endl;
+			std::filesystem::remove(tmpPath, ec);
+		}
+	}
+
+	void LveDevice::createSurface() {
+		if (isHeadless()) return;
+		window->createWindowSurface(instance, &surface_);
+	}
+
+	std::vector<const char*> LveDevice::requiredDeviceExtensions() const {
+		if (isHeadless()) return {};
+		return std::vector<const char*>(deviceExtensions.begin(), deviceExtensions.end());
+	}
 
 	bool LveDevice::isDeviceSuitable(VkPhysicalDevice device) {
 		QueueFamilyIndices indices = findQueueFamilies(device);
 
 		bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-		bool swapChainAdequate = false;
-		if (extensionsSupported) {
+		bool swapChainAdequate = isHeadless();
+		if (extensionsSupported && !isHeadless()) {
 			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
 			swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
 		}
@@ -268,7 +585,7 @@ namespace lve {
 		if (!enableValidationLayers) return;
 		VkDebugUtilsMessengerCreateInfoEXT createInfo;
 		populateDebugMessengerCreateInfo(createInfo);
-		if (CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
+		if (CreateDebugUtilsMessengerEXT(instance, &createInfo, allocationCallbacks(LveMemoryTag::Device), &debugMessenger) != VK_SUCCESS) {
 			throw std::runtime_error("failed to set up debug messenger!");
 		}
 	}
@@ -299,11 +616,13 @@ namespace lve {
 	}
 
 	std::vector<const char*> LveDevice::getRequiredExtensions() {
-		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		std::vector<const char*> extensions{};
+		if (!isHeadless()) {
+			uint32_t glfwExtensionCount = 0;
+			const char** glfwExtensions;
+			glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+			extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		}
 
 		if (enableValidationLayers) {
 			extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -346,7 +665,8 @@ namespace lve {
 			&extensionCount,
 			availableExtensions.data());
 
-		std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+		auto required = requiredDeviceExtensions();
+		std::set<std::string> requiredExtensions(required.begin(), required.end());
 
 		for (const auto& extension : availableExtensions) {
 			requiredExtensions.erase(extension.extensionName);
@@ -355,6 +675,31 @@ namespace lve {
 		return requiredExtensions.empty();
 	}
 
+	void LveDevice::cmdPushDescriptorSetWithTemplate(
+		VkCommandBuffer commandBuffer,
+		VkDescriptorUpdateTemplate updateTemplate,
+		VkPipelineLayout pipelineLayout,
+		uint32_t set,
+		const void* data) {
+		assert(pushDescriptorSetWithTemplate != nullptr && "VK_KHR_push_descriptor is not enabled");
+		pushDescriptorSetWithTemplate(commandBuffer, updateTemplate, pipelineLayout, set, data);
+	}
+
+	bool LveDevice::hasDeviceExtension(VkPhysicalDevice device, const char* extensionName) {
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const auto& extension : availableExtensions) {
+			if (strcmp(extension.extensionName, extensionName) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
 		QueueFamilyIndices indices;
 
@@ -371,7 +716,13 @@ namespace lve {
 				indices.graphicsFamilyHasValue = true;
 			}
 			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+			if (isHeadless()) {
+				// nothing is presented; alias the graphics family so the present queue stays valid
+				presentSupport = indices.graphicsFamilyHasValue && indices.graphicsFamily == static_cast<uint32_t>(i);
+			}
+			else {
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+			}
 			if (queueFamily.queueCount > 0 && presentSupport) {
 				indices.presentFamily = i;
 				indices.presentFamilyHasValue = true;
@@ -383,6 +734,18 @@ namespace lve {
 			i++;
 		}
 
+		// optional and looked for separately, since the loop above stops at the first complete set; a family
+		// without graphics is what lets compute run alongside the graphics queue instead of between its submissions
+		for (uint32_t family = 0; family < queueFamilyCount; family++) {
+			const auto& queueFamily = queueFamilies[family];
+			if (queueFamily.queueCount > 0 && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+				!(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+				indices.computeFamily = family;
+				indices.computeFamilyHasValue = true;
+				break;
+			}
+		}
+
 		return indices;
 	}
 
@@ -430,16 +793,26 @@ namespace lve {
 	}
 
 	uint32_t LveDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+		uint32_t memoryTypeIndex;
+		if (tryFindMemoryType(typeFilter, properties, memoryTypeIndex)) {
+			return memoryTypeIndex;
+		}
+
+		throw std::runtime_error("failed to find suitable memory type!");
+	}
+
+	// for optional properties such as LAZILY_ALLOCATED that callers fall back from
+	bool LveDevice::tryFindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t& memoryTypeIndex) {
 		VkPhysicalDeviceMemoryProperties memProperties;
 		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
 		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
 			if ((typeFilter & (1 << i)) &&
 				(memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-				return i;
+				memoryTypeIndex = i;
+				return true;
 			}
 		}
-
-		throw std::runtime_error("failed to find suitable memory type!");
+		return false;
 	}
 
 	void LveDevice::createBuffer(
@@ -454,7 +827,7 @@ namespace lve {
 		bufferInfo.usage = usage;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+		if (vkCreateBuffer(device_, &bufferInfo, allocationCallbacks(LveMemoryTag::Device), &buffer) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create vertex buffer!");
 		}
 
@@ -466,18 +839,102 @@ namespace lve {
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
-		if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+		if (vkAllocateMemory(device_, &allocInfo, allocationCallbacks(LveMemoryTag::Device), &bufferMemory) != VK_SUCCESS) {
 			throw std::runtime_error("failed to allocate vertex buffer memory!");
 		}
 
 		vkBindBufferMemory(device_, buffer, bufferMemory, 0);
 	}
 
+	void LveDevice::createTimeline() {
+		VkSemaphoreTypeCreateInfo typeInfo = {};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+		if (vkCreateSemaphore(device_, &semaphoreInfo, allocationCallbacks(LveMemoryTag::Device), &timeline_) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create timeline semaphore!");
+		}
+	}
+
+	std::unique_lock<std::mutex> LveDevice::lockGraphicsQueue() {
+		return std::unique_lock<std::mutex>(graphicsQueueMutex);
+	}
+
+	uint64_t LveDevice::nextTimelineValue() {
+		// signal values must reach the queue in increasing order, so callers hold lockGraphicsQueue() from here
+		// until the submission carrying the value is made
+		return ++lastTimelineValue;
+	}
+
+	uint64_t LveDevice::completedTimelineValue() {
+		uint64_t value = completedTimelineValue_.load();
+		// the cached value answers most queries without a driver call
+		if (value >= lastTimelineValue.load()) return value;
+
+		if (vkGetSemaphoreCounterValue(device_, timeline_, &value) != VK_SUCCESS) {
+			throw std::runtime_error("failed to query timeline semaphore!");
+		}
+		uint64_t cached = completedTimelineValue_.load();
+		while (cached < value && !completedTimelineValue_.compare_exchange_weak(cached, value)) {}
+		return value;
+	}
+
+	bool LveDevice::hasReached(uint64_t value) {
+		return completedTimelineValue_.load() >= value || completedTimelineValue() >= value;
+	}
+
+	void LveDevice::waitForTimeline(uint64_t value) {
+		if (hasReached(value)) return;
+		LVE_PROFILE_ZONE("LveDevice::waitForTimeline");
+
+		VkSemaphoreWaitInfo waitInfo = {};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &timeline_;
+		waitInfo.pValues = &value;
+		if (vkWaitSemaphores(device_, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to wait for timeline semaphore!");
+		}
+		uint64_t cached = completedTimelineValue_.load();
+		while (cached < value && !completedTimelineValue_.compare_exchange_weak(cached, value)) {}
+	}
+
+	void LveDevice::deferDestruction(LveDeletionQueue::Deleter deleter) {
+		// while a frame is being recorded its command buffer may reference the object, and its value is not known
+		// until it is submitted: uploads from other threads can take the next values first
+		deletionQueue.pushAfterSubmitted(lastTimelineValue.load(), std::move(deleter));
+	}
+
+	void LveDevice::deferDestructionAfterNextFrame(LveDeletionQueue::Deleter deleter) {
+		deletionQueue.pushAfterNextSubmission(std::move(deleter));
+	}
+
+	void LveDevice::beginFrameSubmission() {
+		deletionQueue.beginSubmission();
+	}
+
+	void LveDevice::endFrameSubmission(uint64_t timelineValue) {
+		deletionQueue.endSubmission(timelineValue);
+	}
+
+	LveDeletionQueue::Hold LveDevice::holdDeferredDestruction() {
+		return deletionQueue.hold();
+	}
+
+	size_t LveDevice::flushDeletionQueue() {
+		return deletionQueue.flush(completedTimelineValue());
+	}
+
 	VkCommandBuffer LveDevice::beginSingleTimeCommands() {
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = commandPool;
+		allocInfo.commandPool = getSingleTimeCommandPool();
 		allocInfo.commandBufferCount = 1;
 
 		VkCommandBuffer commandBuffer;
@@ -494,15 +951,30 @@ namespace lve {
 	void LveDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
 		vkEndCommandBuffer(commandBuffer);
 
+		// waiting on our own timeline value leaves any frames already in flight running
+		auto queueLock = lockGraphicsQueue();
+		uint64_t signalValue = nextTimelineValue();
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &signalValue;
+
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &timeline_;
 
-		vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(graphicsQueue_);
+		if (vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit single time commands!");
+		}
+		queueLock.unlock();
+		waitForTimeline(signalValue);
 
-		vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
+		// begin and end run on the same thread, so this is the pool the buffer came from
+		vkFreeCommandBuffers(device_, getSingleTimeCommandPool(), 1, &commandBuffer);
 	}
 
 	void LveDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
@@ -549,7 +1021,7 @@ namespace lve {
 		VkMemoryPropertyFlags properties,
 		VkImage& image,
 		VkDeviceMemory& imageMemory) {
-		if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+		if (vkCreateImage(device_, &imageInfo, allocationCallbacks(LveMemoryTag::Device), &image) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create image!");
 		}
 
@@ -561,7 +1033,7 @@ namespace lve {
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
-		if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
+		if (vkAllocateMemory(device_, &allocInfo, allocationCallbacks(LveMemoryTag::Device), &imageMemory) != VK_SUCCESS) {
 			throw std::runtime_error("failed to allocate image memory!");
 		}
 
@@ -0,0 +1,497 @@
+#include "lve_dynamic_resolution.hpp"
+
+#include "lve_allocation_tracker.hpp"
+#include "lve_renderer_config.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+	namespace {
+		// frames after a scale change during which samples still come from the old scale (frames in flight)
+		constexpr uint32_t SETTLE_FRAMES = LveRendererConfig::MAX_FRAMES_IN_FLIGHT;
+
+		struct UpscalePushConstants {
+			glm::vec2 uvScale;
+			glm::vec2 uvMax;
+			glm::vec2 texelSize;
+			float sharpness;
+		};
+
+		float readFloat(const char* name, float fallback) {
+			const char* value = std::getenv(name);
+			return value != nullptr ? std::strtof(value, nullptr) : fallback;
+		}
+	}
+
+	// *************** Resolution Controller *********************
+
+	LveResolutionController::LveResolutionController(const Settings& settings)
+		: settings{ settings }, scale{ settings.maxScale } {
+		assert(settings.minScale > 0.0f && settings.minScale <= settings.maxScale && "Invalid resolution scale range");
+		assert(settings.growThreshold < settings.shrinkThreshold && "Grow threshold must lie below shrink threshold");
+	}
+
+	float LveResolutionController::update(float gpuFrameMs) {
+		smoothedFrameMs = smoothedFrameMs == 0.0f
+			? gpuFrameMs
+			: smoothedFrameMs + settings.smoothing * (gpuFrameMs - smoothedFrameMs);
+
+		if (settleFrames > 0) {
+			settleFrames--;
+			return scale;
+		}
+
+		const float shrinkMs = settings.targetFrameMs * settings.shrinkThreshold;
+		const float growMs = settings.targetFrameMs * settings.growThreshold;
+		const float centerMs = 0.5f * (shrinkMs + growMs);
+
+		float desired = scale;
+		if (smoothedFrameMs > shrinkMs) {
+			framesUnderBudget = 0;
+			desired = scale * std::sqrt(centerMs / smoothedFrameMs);
+		}
+		else if (smoothedFrameMs < growMs) {
+			if (++framesUnderBudget >= settings.growDelayFrames) {
+				framesUnderBudget = 0;
+				desired = scale * std::sqrt(centerMs / smoothedFrameMs);
+			}
+		}
+		else {
+			framesUnderBudget = 0;
+		}
+
+		desired = std::clamp(desired, scale - settings.maxStep, scale + settings.maxStep);
+		desired = std::clamp(desired, settings.minScale, settings.maxScale);
+		if (desired != scale) {
+			scale = desired;
+			settleFrames = SETTLE_FRAMES;
+		}
+		return scale;
+	}
+
+	// *************** Dynamic Resolution *********************
+
+	LveDynamicResolution::Settings LveDynamicResolution::Settings::fromEnvironment() {
+		Settings settings{};
+		auto& controller = settings.controller;
+		controller.targetFrameMs = std::max(readFloat("LVE_DRS_TARGET_MS", controller.targetFrameMs), 0.1f);
+		controller.maxScale = std::clamp(readFloat("LVE_DRS_MAX_SCALE", controller.maxScale), 0.1f, 1.0f);
+		controller.minScale = std::clamp(readFloat("LVE_DRS_MIN_SCALE", controller.minScale), 0.1f, controller.maxScale);
+		settings.sharpness = std::clamp(readFloat("LVE_DRS_SHARPNESS", settings.sharpness), 0.0f, 1.0f);
+		if (const char* value = std::getenv("LVE_DRS_LOG")) {
+			settings.logPath = value;
+		}
+		return settings;
+	}
+
+	LveDynamicResolution::LveDynamicResolution(
+		LveDevice& device,
+		LveRenderer& renderer,
+		LvePipelineRegistry& pipelineRegistry,
+		LveDescriptorLayoutCache& layoutCache,
+		LveDescriptorSetCache& setCache,
+		const Settings& settings)
+		: lveDevice{ device },
+		lveRenderer{ renderer },
+		pipelineRegistry{ pipelineRegistry },
+		setCache{ setCache },
+		settings{ settings },
+		controller{ settings.controller },
+		colorFormat{ renderer.getSwapChainImageFormat() },
+		depthFormat{ renderer.getSwapChainDepthFormat() } {
+		upscaleSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.build(layoutCache);
+
+		createSceneRenderPass();
+		createTarget(lveRenderer.getSwapChainExtent());
+		createSampler();
+		createQueryPool();
+		createPipelineLayout();
+		createPipeline(pipelineRegistry);
+
+		if (!this->settings.logPath.empty()) {
+			log.open(this->settings.logPath);
+			if (!log) {
+				throw std::runtime_error("failed to open dynamic resolution log " + this->settings.logPath + "!");
+			}
+			log << "frame,scale,width,height,gpu_ms,smoothed_ms,next_scale\n";
+		}
+	}
+
+	LveDynamicResolution::~LveDynamicResolution() {
+		destroyTarget();
+		pipelineRegistry.releasePipelineLayout(pipelineLayout);
+		lveDevice.deferDestruction([device = lveDevice.device(), renderPass = sceneRenderPass, sampler = sampler,
+			queryPool = timestampQueryPool, layout = pipelineLayout]() {
+			vkDestroyPipelineLayout(device, layout, allocationCallbacks(LveMemoryTag::Rendering));
+			if (queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(device, queryPool, allocationCallbacks(LveMemoryTag::Rendering));
+			vkDestroySampler(device, sampler, allocationCallbacks(LveMemoryTag::Rendering));
+			vkDestroyRenderPass(device, renderPass, allocationCallbacks(LveMemoryTag::Rendering));
+		});
+	}
+
+	void LveDynamicResolution::createSceneRenderPass() {
+		// same formats, sample counts and subpass layout as the swap chain render pass, so the two are compatible
+		VkAttachmentDescription colorAttachment{};
+		colorAttachment.format = colorFormat;
+		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkAttachmentDescription depthAttachment{};
+		depthAttachment.format = depthFormat;
+		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference colorAttachmentRef{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference depthAttachmentRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments = &colorAttachmentRef;
+		subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+		// one target is shared by all frames in flight: the previous frame's upscale must finish sampling
+		// and its depth writes must land before this frame clears them
+		std::array<VkSubpassDependency, 2> dependencies{};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask =
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[0].dstStageMask =
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependencies[0].dstAccessMask =
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		// and the upscale in this frame samples what the scene pass wrote
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
+
+		if (vkCreateRenderPass(lveDevice.device(), &renderPassInfo, allocationCallbacks(LveMemoryTag::Rendering), &sceneRenderPass) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create scene render pass!");
+		}
+	}
+
+	void LveDynamicResolution::createTarget(VkExtent2D extent) {
+		targetExtent = extent;
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = { extent.width, extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = colorFormat;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, colorImage, colorMemory);
+
+		imageInfo.format = depthFormat;
+		imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage, depthMemory);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		viewInfo.image = colorImage;
+		viewInfo.format = colorFormat;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		if (vkCreateImageView(lveDevice.device(), &viewInfo, allocationCallbacks(LveMemoryTag::Rendering), &colorView) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create scene color view!");
+		}
+
+		viewInfo.image = depthImage;
+		viewInfo.format = depthFormat;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (vkCreateImageView(lveDevice.device(), &viewInfo, allocationCallbacks(LveMemoryTag::Rendering), &depthView) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create scene depth view!");
+		}
+
+		std::array<VkImageView, 2> attachments = { colorView, depthView };
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = sceneRenderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		framebufferInfo.pAttachments = attachments.data();
+		framebufferInfo.width = extent.width;
+		framebufferInfo.height = extent.height;
+		framebufferInfo.layers = 1;
+		if (vkCreateFramebuffer(lveDevice.device(), &framebufferInfo, allocationCallbacks(LveMemoryTag::Rendering), &framebuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create scene framebuffer!");
+		}
+
+		sceneExtent = scaledExtent(controller.getScale());
+	}
+
+	void LveDynamicResolution::destroyTarget() {
+		// a new target may get the old view's handle back and must not hit the set written for the old one
+		setCache.invalidate(colorView);
+		// frames still in flight may be rendering into or sampling the old target
+		lveDevice.deferDestruction([device = lveDevice.device(), framebuffer = framebuffer,
+			views = std::array<VkImageView, 2>{ colorView, depthView },
+			images = std::array<VkImage, 2>{ colorImage, depthImage },
+			memories = std::array<VkDeviceMemory, 2>{ colorMemory, depthMemory }]() {
+			vkDestroyFramebuffer(device, framebuffer, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto view : views) vkDestroyImageView(device, view, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto image : images) vkDestroyImage(device, image, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto memory : memories) vkFreeMemory(device, memory, allocationCallbacks(LveMemoryTag::Rendering));
+		});
+	}
+
+	void LveDynamicResolution::createSampler() {
+		// bilinear, clamped: the shader keeps coordinates inside the rendered region, so edges never pick up
+		// stale texels from the unused part of the target
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.maxLod = 0.0f;
+		if (vkCreateSampler(lveDevice.device(), &samplerInfo, allocationCallbacks(LveMemoryTag::Rendering), &sampler) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create upscale sampler!");
+		}
+	}
+
+	void LveDynamicResolution::createQueryPool() {
+		frameTimings.assign(LveRendererConfig::MAX_FRAMES_IN_FLIGHT, FrameTiming{});
+		if (!lveDevice.properties.limits.timestampComputeAndGraphics) {
+			std::cerr << "Dynamic resolution: timestamps unsupported, scale stays at "
+				<< controller.getScale() << std::endl;
+			return;
+		}
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = 2 * LveRendererConfig::MAX_FRAMES_IN_FLIGHT;
+		if (vkCreateQueryPool(lveDevice.device(), &queryPoolInfo, allocationCallbacks(LveMemoryTag::Rendering), &timestampQueryPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create timestamp query pool!");
+		}
+	}
+
+	void LveDynamicResolution::createPipelineLayout() {
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(UpscalePushConstants);
+
+		VkDescriptorSetLayout setLayout = upscaleSetLayout->getDescriptorSetLayout();
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, allocationCallbacks(LveMemoryTag::Rendering), &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+	}
+
+	void LveDynamicResolution::createPipeline(LvePipelineRegistry& pipelineRegistry) {
+		assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+		PipelineConfigInfo pipelineConfig{};
+		LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
+		// fullscreen triangle generated from gl_VertexIndex; it covers the whole swap chain image, so no depth
+		pipelineConfig.attributeDescriptions.clear();
+		pipelineConfig.bindingDescriptions.clear();
+		pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+		pipelineConfig.renderPass = lveRenderer.getSwapChainRenderPass();
+		pipelineConfig.pipelineLayout = pipelineLayout;
+		upscalePipeline = pipelineRegistry.requestPipeline(
+			"shaders/upscale.vert.spv",
+			"shaders/upscale.frag.spv",
+			pipelineConfig
+		);
+	}
+
+	VkExtent2D LveDynamicResolution::scaledExtent(float scale) const {
+		return {
+			std::clamp(static_cast<uint32_t>(std::lround(targetExtent.width * scale)), 1u, targetExtent.width),
+			std::clamp(static_cast<uint32_t>(std::lround(targetExtent.height * scale)), 1u, targetExtent.height) };
+	}
+
+	void LveDynamicResolution::collectTimestamps(int frameIndex) {
+		FrameTiming& timing = frameTimings[frameIndex];
+		if (!timing.pending) return;
+
+		// LveRenderer::beginFrame waited for this slot's timeline value, so the results are available; no WAIT flag
+		std::array<uint64_t, 2> timestamps{};
+		VkResult result = vkGetQueryPoolResults(
+			lveDevice.device(),
+			timestampQueryPool,
+			2 * frameIndex,
+			2,
+			sizeof(timestamps),
+			timestamps.data(),
+			sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS) return;
+		timing.pending = false;
+
+		float gpuFrameMs = static_cast<float>(
+			(timestamps[1] - timestamps[0]) * lveDevice.properties.limits.timestampPeriod / 1e6);
+		float previousScale = controller.getScale();
+		float scale = controller.update(gpuFrameMs);
+
+		stats.measuredFrames++;
+		if (gpuFrameMs > controller.getSettings().targetFrameMs) stats.framesOverBudget++;
+		if (scale != previousScale) stats.scaleChanges++;
+		stats.averageScale += (scale - stats.averageScale) / stats.measuredFrames;
+		stats.averageFrameMs += (gpuFrameMs - stats.averageFrameMs) / stats.measuredFrames;
+		stats.minScale = std::min(stats.minScale, scale);
+		stats.maxScale = std::max(stats.maxScale, scale);
+
+		if (log.is_open()) {
+			log << stats.measuredFrames << "," << timing.scale << "," << timing.extent.width << ","
+				<< timing.extent.height << "," << gpuFrameMs << "," << controller.getSmoothedFrameMs() << ","
+				<< scale << "\n";
+		}
+	}
+
+	void LveDynamicResolution::beginFrame(VkCommandBuffer commandBuffer, int frameIndex) {
+		currentFrameIndex = frameIndex;
+
+		VkExtent2D swapChainExtent = lveRenderer.getSwapChainExtent();
+		if (swapChainExtent.width != targetExtent.width || swapChainExtent.height != targetExtent.height) {
+			destroyTarget();
+			createTarget(swapChainExtent);
+		}
+
+		if (timestampQueryPool == VK_NULL_HANDLE) return;
+		collectTimestamps(frameIndex);
+		sceneExtent = scaledExtent(controller.getScale());
+		frameTimings[frameIndex].scale = controller.getScale();
+		frameTimings[frameIndex].extent = sceneExtent;
+
+		vkCmdResetQueryPool(commandBuffer, timestampQueryPool, 2 * frameIndex, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, 2 * frameIndex);
+	}
+
+	void LveDynamicResolution::beginScenePass(VkCommandBuffer commandBuffer) {
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = sceneRenderPass;
+		renderPassInfo.framebuffer = framebuffer;
+		// only the scaled region is cleared, rendered and later sampled
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = sceneExtent;
+
+		std::array<VkClearValue, 2> clearValues{};
+		clearValues[0].color = { 0.1f, 0.1f, 0.1f, 1.0f };
+		clearValues[1].depthStencil = { 1.0f, 0 };
+		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+		renderPassInfo.pClearValues = clearValues.data();
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		VkViewport viewport{};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(sceneExtent.width);
+		viewport.height = static_cast<float>(sceneExtent.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		VkRect2D scissor{ {0, 0}, sceneExtent };
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	}
+
+	void LveDynamicResolution::endScenePass(VkCommandBuffer commandBuffer) {
+		vkCmdEndRenderPass(commandBuffer);
+	}
+
+	void LveDynamicResolution::upscale(VkCommandBuffer commandBuffer) {
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.sampler = sampler;
+		imageInfo.imageView = colorView;
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		VkDescriptorSet sceneSet;
+		LveDescriptorWriter(*upscaleSetLayout)
+			.writeImage(0, &imageInfo)
+			.build(sceneSet, setCache);
+
+		glm::vec2 targetSize{ targetExtent.width, targetExtent.height };
+		glm::vec2 sceneSize{ sceneExtent.width, sceneExtent.height };
+		UpscalePushConstants push{};
+		push.uvScale = sceneSize / targetSize;
+		// half a texel inside the rendered region, so bilinear taps never reach past its edge
+		push.uvMax = (sceneSize - 0.5f) / targetSize;
+		push.texelSize = 1.0f / targetSize;
+		push.sharpness = settings.sharpness;
+
+		upscalePipeline->bind(commandBuffer);
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			pipelineLayout,
+			0,
+			1,
+			&sceneSet,
+			0,
+			nullptr);
+		vkCmdPushConstants(
+			commandBuffer,
+			pipelineLayout,
+			VK_SHADER_STAGE_FRAGMENT_BIT,
+			0,
+			sizeof(UpscalePushConstants),
+			&push);
+		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+	}
+
+	void LveDynamicResolution::endFrame(VkCommandBuffer commandBuffer) {
+		if (timestampQueryPool == VK_NULL_HANDLE) return;
+		vkCmdWriteTimestamp(
+			commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, 2 * currentFrameIndex + 1);
+		frameTimings[currentFrameIndex].pending = true;
+	}
+}
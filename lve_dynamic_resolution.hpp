@@ -0,0 +1,159 @@
+#pragma once
+
+#include "lve_descriptor_cache.hpp"
+#include "lve_descriptors.hpp"
+#include "lve_device.hpp"
+#include "lve_pipeline_registry.hpp"
+#include "lve_renderer.hpp"
+
+// std
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lve {
+	// Picks a render scale from measured GPU frame times. Pixel cost is assumed to grow with the square of the
+	// scale, so each step aims the smoothed frame time at the middle of the [growThreshold, shrinkThreshold]
+	// band around the budget. Over budget it shrinks at once; under the band it only grows after
+	// growDelayFrames consecutive frames, so the scale does not oscillate around the budget.
+	class LveResolutionController {
+	public:
+		struct Settings {
+			float targetFrameMs = 1000.0f / 60.0f;
+			float minScale = 0.5f;
+			float maxScale = 1.0f;
+			// fractions of targetFrameMs
+			float growThreshold = 0.85f;
+			float shrinkThreshold = 1.0f;
+			uint32_t growDelayFrames = 30;
+			// largest scale change per frame
+			float maxStep = 0.05f;
+			// weight of the newest sample in the exponential moving average
+			float smoothing = 0.2f;
+		};
+
+		explicit LveResolutionController(const Settings& settings);
+
+		// returns the scale to render the next frame at
+		float update(float gpuFrameMs);
+
+		float getScale() const { return scale; }
+		float getSmoothedFrameMs() const { return smoothedFrameMs; }
+		const Settings& getSettings() const { return settings; }
+
+	private:
+		Settings settings;
+		float scale;
+		float smoothedFrameMs = 0.0f;
+		uint32_t framesUnderBudget = 0;
+		uint32_t settleFrames = 0;
+	};
+
+	// Renders the scene into an offscreen color and depth target and upscales it into the swap chain render pass.
+	// The target is allocated at swap chain size and only its render area shrinks, so scale changes never
+	// reallocate. GPU time is measured with a timestamp pair per frame slot, read back without stalling once
+	// beginFrame has waited for the slot's timeline value; the measured frame therefore lags by framesInFlight.
+	// Usage per frame, after LveRenderer::beginFrame:
+	//   beginFrame -> beginScenePass -> draw -> endScenePass -> beginSwapChainRenderPass -> upscale -> end passes -> endFrame
+	class LveDynamicResolution {
+	public:
+		struct Settings {
+			LveResolutionController::Settings controller{};
+			// 0 is plain bilinear; up to 1 adds a cross-shaped unsharp mask to recover detail lost to upscaling
+			float sharpness = 0.2f;
+			// CSV of scale versus GPU frame time, one row per measured frame; empty disables the log
+			std::string logPath{};
+
+			// reads LVE_DRS_TARGET_MS, LVE_DRS_MIN_SCALE, LVE_DRS_MAX_SCALE, LVE_DRS_SHARPNESS and LVE_DRS_LOG
+			static Settings fromEnvironment();
+		};
+
+		struct Stats {
+			uint64_t measuredFrames = 0;
+			uint64_t framesOverBudget = 0;
+			uint64_t scaleChanges = 0;
+			double averageScale = 0.0;
+			double averageFrameMs = 0.0;
+			float minScale = 1.0f;
+			float maxScale = 0.0f;
+		};
+
+		LveDynamicResolution(
+			LveDevice& device,
+			LveRenderer& renderer,
+			LvePipelineRegistry& pipelineRegistry,
+			LveDescriptorLayoutCache& layoutCache,
+			LveDescriptorSetCache& setCache,
+			const Settings& settings);
+		~LveDynamicResolution();
+
+		LveDynamicResolution(const LveDynamicResolution&) = delete;
+		LveDynamicResolution& operator=(const LveDynamicResolution&) = delete;
+
+		// reads the timestamps this frame slot wrote last time, updates the scale and starts timing this frame
+		void beginFrame(VkCommandBuffer commandBuffer, int frameIndex);
+		void beginScenePass(VkCommandBuffer commandBuffer);
+		void endScenePass(VkCommandBuffer commandBuffer);
+		// draws the fullscreen upscale; must be inside the swap chain render pass
+		void upscale(VkCommandBuffer commandBuffer);
+		void endFrame(VkCommandBuffer commandBuffer);
+
+		// compatible with the swap chain render pass, so scene pipelines are shared between the two
+		VkRenderPass getSceneRenderPass() const { return sceneRenderPass; }
+		VkExtent2D getSceneExtent() const { return sceneExtent; }
+		float getScale() const { return controller.getScale(); }
+		bool isTimingSupported() const { return timestampQueryPool != VK_NULL_HANDLE; }
+		const Stats& getStats() const { return stats; }
+
+	private:
+		void createSceneRenderPass();
+		void createTarget(VkExtent2D extent);
+		void destroyTarget();
+		void createSampler();
+		void createQueryPool();
+		void createPipelineLayout();
+		void createPipeline(LvePipelineRegistry& pipelineRegistry);
+		void collectTimestamps(int frameIndex);
+		VkExtent2D scaledExtent(float scale) const;
+
+		LveDevice& lveDevice;
+		LveRenderer& lveRenderer;
+		LvePipelineRegistry& pipelineRegistry;
+		// the upscale set is cached by the target's view, so the cache is told whenever the target is replaced
+		LveDescriptorSetCache& setCache;
+		Settings settings;
+		LveResolutionController controller;
+		Stats stats{};
+		std::ofstream log{};
+
+		VkFormat colorFormat;
+		VkFormat depthFormat;
+		VkRenderPass sceneRenderPass = VK_NULL_HANDLE;
+		VkExtent2D targetExtent{};
+		VkExtent2D sceneExtent{};
+		VkImage colorImage = VK_NULL_HANDLE;
+		VkDeviceMemory colorMemory = VK_NULL_HANDLE;
+		VkImageView colorView = VK_NULL_HANDLE;
+		VkImage depthImage = VK_NULL_HANDLE;
+		VkDeviceMemory depthMemory = VK_NULL_HANDLE;
+		VkImageView depthView = VK_NULL_HANDLE;
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		VkSampler sampler = VK_NULL_HANDLE;
+
+		VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+		struct FrameTiming {
+			// timestamps written and not read back yet
+			bool pending = false;
+			float scale = 1.0f;
+			VkExtent2D extent{};
+		};
+		std::vector<FrameTiming> frameTimings{};
+		int currentFrameIndex = 0;
+
+		std::shared_ptr<LveDescriptorSetLayout> upscaleSetLayout;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		LvePipelineHandle upscalePipeline{};
+	};
+}
@@ -0,0 +1,127 @@
+#include "lve_gpu_profiler.hpp"
+
+#include "lve_allocation_tracker.hpp"
+#include "lve_percentile.hpp"
+#include "lve_renderer_config.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+namespace lve {
+	LveGpuProfiler::LveGpuProfiler(LveDevice& device, uint32_t maxZonesPerFrame, uint32_t window)
+		: lveDevice{ device }, maxZonesPerFrame{ maxZonesPerFrame }, window{ window } {
+		assert(maxZonesPerFrame > 0 && window > 0 && "GPU profiler needs room for at least one zone and sample");
+		if (!lveDevice.properties.limits.timestampComputeAndGraphics) {
+			std::cerr << "GPU profiler: timestamps unsupported, zones are not timed" << std::endl;
+			return;
+		}
+		msPerTick = lveDevice.properties.limits.timestampPeriod / 1e6;
+
+		frameSlots.resize(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+		for (auto& slot : frameSlots) {
+			VkQueryPoolCreateInfo queryPoolInfo{};
+			queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolInfo.queryCount = 2 * maxZonesPerFrame;
+			if (vkCreateQueryPool(lveDevice.device(), &queryPoolInfo, allocationCallbacks(LveMemoryTag::Profiling), &slot.queryPool) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create timestamp query pool!");
+			}
+			slot.zoneNames.reserve(maxZonesPerFrame);
+			slot.results.resize(4 * maxZonesPerFrame);
+		}
+	}
+
+	LveGpuProfiler::~LveGpuProfiler() {
+		// the last frames' command buffers may still write into the pools
+		for (auto& slot : frameSlots) {
+			lveDevice.deferDestruction([device = lveDevice.device(), queryPool = slot.queryPool]() {
+				vkDestroyQueryPool(device, queryPool, allocationCallbacks(LveMemoryTag::Profiling));
+			});
+		}
+	}
+
+	void LveGpuProfiler::beginFrame(VkCommandBuffer commandBuffer, int frameIndex) {
+		if (frameSlots.empty()) return;
+		currentSlot = &frameSlots[frameIndex];
+		collect(*currentSlot);
+		vkCmdResetQueryPool(commandBuffer, currentSlot->queryPool, 0, 2 * maxZonesPerFrame);
+	}
+
+	uint32_t LveGpuProfiler::beginZone(VkCommandBuffer commandBuffer, const char* name) {
+		if (currentSlot == nullptr || currentSlot->zoneNames.size() == maxZonesPerFrame) return NO_ZONE;
+		uint32_t zone = static_cast<uint32_t>(currentSlot->zoneNames.size());
+		currentSlot->zoneNames.push_back(name);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, currentSlot->queryPool, 2 * zone);
+		return zone;
+	}
+
+	void LveGpuProfiler::endZone(VkCommandBuffer commandBuffer, uint32_t zone) {
+		if (zone == NO_ZONE) return;
+		assert(currentSlot != nullptr && zone < currentSlot->zoneNames.size() && "Ending a zone of another frame");
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentSlot->queryPool, 2 * zone + 1);
+	}
+
+	void LveGpuProfiler::collect(FrameSlot& slot) {
+		if (slot.zoneNames.empty()) return;
+
+		// value and availability per query, so a zone that was never ended only loses its own sample
+		const uint32_t queryCount = 2 * static_cast<uint32_t>(slot.zoneNames.size());
+		std::vector<uint64_t>& results = slot.results;
+		VkResult result = vkGetQueryPoolResults(
+			lveDevice.device(),
+			slot.queryPool,
+			0,
+			queryCount,
+			2 * queryCount * sizeof(uint64_t),
+			results.data(),
+			2 * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (result == VK_SUCCESS || result == VK_NOT_READY) {
+			for (size_t zone = 0; zone < slot.zoneNames.size(); zone++) {
+				const uint64_t* begin = &results[4 * zone];
+				const uint64_t* end = begin + 2;
+				if (begin[1] == 0 || end[1] == 0 || end[0] < begin[0]) continue;
+				addSample(slot.zoneNames[zone], (end[0] - begin[0]) * msPerTick);
+			}
+		}
+		slot.zoneNames.clear();
+	}
+
+	void LveGpuProfiler::addSample(const char* name, double durationMs) {
+		auto [index, inserted] = zoneIndices.try_emplace(name, zones.size());
+		if (inserted) {
+			zones.push_back({ name });
+			zones.back().durationsMs.reserve(window);
+		}
+
+		ZoneHistory& zone = zones[index->second];
+		if (zone.durationsMs.size() < window) {
+			zone.durationsMs.push_back(durationMs);
+		}
+		else {
+			zone.durationsMs[zone.samples % window] = durationMs;
+		}
+		zone.samples++;
+	}
+
+	std::vector<LveGpuProfiler::ZoneStats> LveGpuProfiler::getStats() const {
+		std::vector<ZoneStats> stats{};
+		stats.reserve(zones.size());
+		for (const auto& zone : zones) {
+			std::vector<double> sorted = zone.durationsMs;
+			std::sort(sorted.begin(), sorted.end());
+			ZoneStats zoneStats{};
+			zoneStats.name = zone.name;
+			zoneStats.samples = zone.samples;
+			zoneStats.minMs = sorted.front();
+			zoneStats.averageMs = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+			zoneStats.p99Ms = percentile(sorted, 99);
+			stats.push_back(zoneStats);
+		}
+		return stats;
+	}
+}
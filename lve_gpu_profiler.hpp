@@ -0,0 +1,97 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+	// Times named GPU zones with timestamp queries, one query pool per frame in flight. A slot's results are read
+	// when the slot comes around again: LveRenderer::beginFrame already waited for its timeline value, so reading
+	// never stalls, and zones whose queries are somehow not available yet are skipped rather than waited for.
+	//
+	// Per frame, after LveRenderer::beginFrame and outside any render pass:
+	//   beginFrame(cb, frameIndex) -> beginZone / endZone or LveGpuZone ... (inside render passes is fine)
+	class LveGpuProfiler {
+	public:
+		static constexpr uint32_t NO_ZONE = ~0u;
+
+		struct ZoneStats {
+			std::string name;
+			uint64_t samples = 0;
+			double minMs = 0.0;
+			double averageMs = 0.0;
+			double p99Ms = 0.0;
+		};
+
+		// maxZonesPerFrame bounds the zones recorded per frame; window is how many recent samples the stats cover
+		LveGpuProfiler(LveDevice& device, uint32_t maxZonesPerFrame = 32, uint32_t window = 240);
+		~LveGpuProfiler();
+
+		LveGpuProfiler(const LveGpuProfiler&) = delete;
+		LveGpuProfiler& operator=(const LveGpuProfiler&) = delete;
+
+		// collects the results this slot recorded framesInFlight frames ago and resets its queries
+		void beginFrame(VkCommandBuffer commandBuffer, int frameIndex);
+		// name must outlive the profiler, e.g. a string literal; returns NO_ZONE when the frame's zones ran out
+		uint32_t beginZone(VkCommandBuffer commandBuffer, const char* name);
+		void endZone(VkCommandBuffer commandBuffer, uint32_t zone);
+
+		bool isEnabled() const { return !frameSlots.empty(); }
+		// in the order the zones were first seen
+		std::vector<ZoneStats> getStats() const;
+
+	private:
+		struct FrameSlot {
+			VkQueryPool queryPool = VK_NULL_HANDLE;
+			std::vector<const char*> zoneNames{};
+			// value and availability per query, sized for maxZonesPerFrame up front
+			std::vector<uint64_t> results{};
+		};
+
+		struct ZoneHistory {
+			std::string name;
+			uint64_t samples = 0;
+			// ring of the last `window` durations
+			std::vector<double> durationsMs{};
+		};
+
+		void collect(FrameSlot& slot);
+		void addSample(const char* name, double durationMs);
+
+		LveDevice& lveDevice;
+		const uint32_t maxZonesPerFrame;
+		const uint32_t window;
+		double msPerTick = 0.0;
+
+		std::vector<FrameSlot> frameSlots{};
+		FrameSlot* currentSlot = nullptr;
+
+		std::vector<ZoneHistory> zones{};
+		// keyed by the name pointer, which is stable for the literals zones are named with
+		std::unordered_map<const char*, size_t> zoneIndices{};
+	};
+
+	// times the commands recorded during its lifetime; a null profiler records nothing
+	class LveGpuZone {
+	public:
+		LveGpuZone(LveGpuProfiler* profiler, VkCommandBuffer commandBuffer, const char* name)
+			: profiler{ profiler }, commandBuffer{ commandBuffer } {
+			if (profiler != nullptr) zone = profiler->beginZone(commandBuffer, name);
+		}
+		~LveGpuZone() {
+			if (profiler != nullptr) profiler->endZone(commandBuffer, zone);
+		}
+
+		LveGpuZone(const LveGpuZone&) = delete;
+		LveGpuZone& operator=(const LveGpuZone&) = delete;
+
+	private:
+		LveGpuProfiler* profiler;
+		VkCommandBuffer commandBuffer;
+		uint32_t zone = LveGpuProfiler::NO_ZONE;
+	};
+}
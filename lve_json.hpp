@@ -0,0 +1,32 @@
+#pragma once
+
+// std
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+namespace lve {
+	// writes value as a quoted JSON string, escaping quotes, backslashes and control characters
+	inline void writeJsonString(std::ostream& out, const std::string& value) {
+		out << '"';
+		for (char c : value) {
+			switch (c) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\r': out << "\\r"; break;
+			case '\t': out << "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[7];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+					out << escaped;
+				}
+				else {
+					out << c;
+				}
+			}
+		}
+		out << '"';
+	}
+}
@@ -0,0 +1,63 @@
+#include "lve_latency_tracker.hpp"
+
+#include "lve_percentile.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace lve {
+	LveLatencyTracker::LveLatencyTracker(uint32_t window) : window{ window } {
+		assert(window > 0 && "Latency tracker needs room for at least one sample");
+		latenciesMs.reserve(window);
+	}
+
+	void LveLatencyTracker::markInputSampled() {
+		inputTime = Clock::now();
+		inputSampled = true;
+	}
+
+	void LveLatencyTracker::frameSubmitted(uint64_t timelineValue) {
+		if (!inputSampled) return;
+		pendingFrames.push_back({ timelineValue, inputTime });
+		inputSampled = false;
+	}
+
+	void LveLatencyTracker::collect(LveDevice& device) {
+		auto now = Clock::now();
+		// timeline values complete in submission order, so only the front can be ready
+		while (!pendingFrames.empty() && device.hasReached(pendingFrames.front().timelineValue)) {
+			double latencyMs = std::chrono::duration<double, std::milli>(now - pendingFrames.front().inputTime).count();
+			if (latenciesMs.size() < window) {
+				latenciesMs.push_back(latencyMs);
+			}
+			else {
+				latenciesMs[samples % window] = latencyMs;
+			}
+			samples++;
+			pendingFrames.pop_front();
+		}
+	}
+
+	LveLatencyTracker::Stats LveLatencyTracker::getStats() const {
+		Stats stats{};
+		if (latenciesMs.empty()) return stats;
+
+		std::vector<double> sorted = latenciesMs;
+		std::sort(sorted.begin(), sorted.end());
+		stats.frames = samples;
+		stats.averageMs = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+		stats.p99Ms = percentile(sorted, 99);
+		stats.maxMs = sorted.back();
+		return stats;
+	}
+
+	void LveLatencyTracker::reset() {
+		// frames still pending were built under the previous settings
+		pendingFrames.clear();
+		latenciesMs.clear();
+		samples = 0;
+		inputSampled = false;
+	}
+}
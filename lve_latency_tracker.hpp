@@ -0,0 +1,51 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace lve {
+	// Measures input-to-present latency per frame: from the moment input is sampled until the frame's
+	// timeline value is seen as reached, which is when its present can proceed. Samples resolve whenever the
+	// renderer next observes the timeline, so they are exact when the CPU waits and frame-granular otherwise.
+	class LveLatencyTracker {
+	public:
+		// frames counts every measured frame; the latencies cover the last `window` of them
+		struct Stats {
+			uint64_t frames = 0;
+			double averageMs = 0.0;
+			double p99Ms = 0.0;
+			double maxMs = 0.0;
+		};
+
+		explicit LveLatencyTracker(uint32_t window = 240);
+
+		void markInputSampled();
+		// ties the last input sample to the timeline value that completes the frame built from it
+		void frameSubmitted(uint64_t timelineValue);
+		void collect(LveDevice& device);
+
+		Stats getStats() const;
+		void reset();
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct PendingFrame {
+			uint64_t timelineValue;
+			Clock::time_point inputTime;
+		};
+
+		bool inputSampled = false;
+		Clock::time_point inputTime{};
+		std::deque<PendingFrame> pendingFrames{};
+		const uint32_t window;
+		uint64_t samples = 0;
+		// ring of the last `window` latencies
+		std::vector<double> latenciesMs{};
+	};
+}
@@ -1,4 +1,5 @@
 #include "lve_model.hpp"
+#include "lve_allocation_tracker.hpp"
 #include "lve_utils.hpp"
 
 #define TINYOBJLOADER_IMPLEMENTATION
@@ -99,12 +100,12 @@ namespace lve {
 		lveDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
 	}
 
-	void LveModel::draw(VkCommandBuffer commandBuffer) {
+	void LveModel::draw(VkCommandBuffer commandBuffer, uint32_t firstInstance) {
 		if (hasIndexBuffer) {
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+			vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, firstInstance);
 		}
 		else {
-			vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+			vkCmdDraw(commandBuffer, vertexCount, 1, 0, firstInstance);
 		}
 	}
 
@@ -138,6 +139,7 @@ namespace lve {
 	}
 
 	void LveModel::Builder::loadModel(const std::string& filepath) {
+		LVE_MEMORY_SCOPE(LveMemoryTag::Assets);
 		tinyobj::attrib_t attrib;
 		std::vector<tinyobj::shape_t> shapes;
 		std::vector<tinyobj::material_t> materials;
@@ -0,0 +1,17 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace lve {
+	// nearest-rank percentile of an ascending sample set, e.g. percentile(sorted, 99) for p99
+	inline double percentile(const std::vector<double>& sorted, size_t p) {
+		assert(!sorted.empty() && p <= 100 && "Percentile needs samples and p in [0, 100]");
+		// the smallest sample with at least p% of the set at or below it: rank ceil(N * p / 100), 1-based
+		size_t rank = static_cast<size_t>(std::ceil(sorted.size() * p / 100.0));
+		return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+	}
+}
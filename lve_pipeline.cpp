@@ -1,5 +1,8 @@
 #include "lve_pipeline.hpp"
+#include "lve_allocation_tracker.hpp"
 #include "lve_model.hpp"
+#include "lve_shader_module.hpp"
+#include "lve_specialization.hpp"
 
 #include <vector>
 #include <fstream>
@@ -12,13 +15,36 @@
 
 namespace lve {
 	LvePipeline::LvePipeline(LveDevice& device, const std::string& vert_file_path, const std::string& frag_file_path, const PipelineConfigInfo& configInfo) : lveDevice(device) {
-		createGraphicsPipeline(vert_file_path, frag_file_path, configInfo);
+		vertShaderModule = std::make_shared<LveShaderModule>(lveDevice, readFile(vert_file_path));
+		fragShaderModule = std::make_shared<LveShaderModule>(lveDevice, readFile(frag_file_path));
+		createGraphicsPipeline(configInfo);
+	}
+
+	LvePipeline::LvePipeline(
+		LveDevice& device,
+		std::shared_ptr<LveShaderModule> vertShader,
+		std::shared_ptr<LveShaderModule> fragShader,
+		const PipelineConfigInfo& configInfo)
+		: lveDevice(device), vertShaderModule(std::move(vertShader)), fragShaderModule(std::move(fragShader)) {
+		createGraphicsPipeline(configInfo);
+	}
+
+	LvePipeline::LvePipeline(LveDevice& device, VkPipeline pipeline) : lveDevice(device) {
+		graphicsPipeline = pipeline;
 	}
 
 	LvePipeline::~LvePipeline() {
-		vkDestroyShaderModule(lveDevice.device(), fragShaderModule, nullptr);
-		vkDestroyShaderModule(lveDevice.device(), vertShaderModule, nullptr);
-		vkDestroyPipeline(lveDevice.device(), graphicsPipeline, nullptr);
+		lveDevice.deferDestruction([device = lveDevice.device(), pipeline = graphicsPipeline.load()]() {
+			vkDestroyPipeline(device, pipeline, allocationCallbacks(LveMemoryTag::Pipelines));
+		});
+	}
+
+	void LvePipeline::replacePipeline(VkPipeline pipeline) {
+		VkPipeline previous = graphicsPipeline.exchange(pipeline);
+		// command buffers in flight may still reference the old handle
+		lveDevice.deferDestruction([device = lveDevice.device(), previous]() {
+			vkDestroyPipeline(device, previous, allocationCallbacks(LveMemoryTag::Pipelines));
+		});
 	}
 
 	void LvePipeline::bind(VkCommandBuffer commandBuffer) {
@@ -43,33 +69,31 @@ namespace lve {
 		return buffer;
 	}
 
-	void LvePipeline::createGraphicsPipeline(const std::string& vert_file_path, const std::string& frag_file_path, const PipelineConfigInfo& configInfo) {
+	void LvePipeline::createGraphicsPipeline(const PipelineConfigInfo& configInfo) {
 		
 		assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline:: no pipelineLayout provided in configInfo");
 		assert(configInfo.renderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline:: no renderPass provided in configInfo");
-		
-		auto vertShaderCode = readFile(vert_file_path);
-		auto fragShaderCode = readFile(frag_file_path);
+		assert(vertShaderModule && fragShaderModule && "Cannot create graphics pipeline:: missing shader module");
 
-		createShaderModule(vertShaderCode, &vertShaderModule);
-		createShaderModule(fragShaderCode, &fragShaderModule);
+		VkSpecializationInfo vertSpecializationInfo = configInfo.vertSpecialization.getInfo();
+		VkSpecializationInfo fragSpecializationInfo = configInfo.fragSpecialization.getInfo();
 
 		VkPipelineShaderStageCreateInfo shaderStages[2];
 		shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		shaderStages[0].module = vertShaderModule;
+		shaderStages[0].module = vertShaderModule->getShaderModule();
 		shaderStages[0].pName = "main";
 		shaderStages[0].flags = 0;
 		shaderStages[0].pNext = nullptr;
-		shaderStages[0].pSpecializationInfo = nullptr;
+		shaderStages[0].pSpecializationInfo = configInfo.vertSpecialization.empty() ? nullptr : &vertSpecializationInfo;
 
 		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		shaderStages[1].module = fragShaderModule;
+		shaderStages[1].module = fragShaderModule->getShaderModule();
 		shaderStages[1].pName = "main";
 		shaderStages[1].flags = 0;
 		shaderStages[1].pNext = nullptr;
-		shaderStages[1].pSpecializationInfo = nullptr;
+		shaderStages[1].pSpecializationInfo = configInfo.fragSpecialization.empty() ? nullptr : &fragSpecializationInfo;
 
 		auto& bindingDescriptions = configInfo.bindingDescriptions;
 		auto& attributeDescriptions = configInfo.attributeDescriptions;
@@ -101,20 +125,11 @@ namespace lve {
 		pipelineInfo.basePipelineIndex = -1; // Optional
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
 
-		if (vkCreateGraphicsPipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(lveDevice.device(), lveDevice.pipelineCache(), 1, &pipelineInfo, allocationCallbacks(LveMemoryTag::Pipelines), &pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create graphics pipeline!");
 		}
-	}
-
-	VkShaderModule LvePipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-		if (vkCreateShaderModule(lveDevice.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create shader module!");
-		}
+		graphicsPipeline = pipeline;
 	}
 
 	void LvePipeline::defaultPipelineConfigInfo(PipelineConfigInfo& configInfo) {
@@ -189,6 +204,33 @@ namespace lve {
 		configInfo.attributeDescriptions = LveModel::Vertex::getAttributeDescriptions();
 	}
 
+	void LvePipeline::copyPipelineConfigInfo(const PipelineConfigInfo& src, PipelineConfigInfo& dst) {
+		dst.bindingDescriptions = src.bindingDescriptions;
+		dst.attributeDescriptions = src.attributeDescriptions;
+		dst.viewportInfo = src.viewportInfo;
+		dst.inputAssemblyInfo = src.inputAssemblyInfo;
+		dst.rasterizerInfo = src.rasterizerInfo;
+		dst.multisamplInfo = src.multisamplInfo;
+		dst.colorBlendAttachment = src.colorBlendAttachment;
+		dst.colorBlendInfo = src.colorBlendInfo;
+		dst.depthStencilInfo = src.depthStencilInfo;
+		dst.dynamicStateEnables = src.dynamicStateEnables;
+		dst.dynamicStateInfo = src.dynamicStateInfo;
+		dst.pipelineLayout = src.pipelineLayout;
+		dst.renderPass = src.renderPass;
+		dst.subpass = src.subpass;
+		dst.vertSpecialization = src.vertSpecialization;
+		dst.fragSpecialization = src.fragSpecialization;
+
+		// re-point the create infos that referenced storage inside src
+		if (src.colorBlendInfo.pAttachments == &src.colorBlendAttachment) {
+			dst.colorBlendInfo.pAttachments = &dst.colorBlendAttachment;
+		}
+		if (src.dynamicStateInfo.pDynamicStates == src.dynamicStateEnables.data()) {
+			dst.dynamicStateInfo.pDynamicStates = dst.dynamicStateEnables.data();
+		}
+	}
+
 	void LvePipeline::enableAlphaBlending(PipelineConfigInfo& configInfo) {
 		configInfo.colorBlendAttachment.blendEnable = VK_TRUE;
 
@@ -0,0 +1,91 @@
+#include "lve_pipeline_key.hpp"
+
+namespace lve {
+	void appendKey(std::string& key, const VkStencilOpState& state) {
+		appendKey(key, state.failOp);
+		appendKey(key, state.passOp);
+		appendKey(key, state.depthFailOp);
+		appendKey(key, state.compareOp);
+		appendKey(key, state.compareMask);
+		appendKey(key, state.writeMask);
+		appendKey(key, state.reference);
+	}
+
+	void appendKey(std::string& key, const LveSpecializationConstants& constants) {
+		appendKey(key, constants.getEntries().size());
+		for (const auto& entry : constants.getEntries()) {
+			appendKey(key, entry.constantID);
+			appendKey(key, entry.offset);
+			appendKey(key, entry.size);
+		}
+		appendKey(key, constants.getData());
+	}
+
+	static void appendMultisampleKey(std::string& key, const VkPipelineMultisampleStateCreateInfo& multisample) {
+		appendKey(key, multisample.rasterizationSamples);
+		appendKey(key, multisample.sampleShadingEnable);
+		appendKey(key, multisample.minSampleShading);
+		appendKey(key, multisample.pSampleMask != nullptr ? *multisample.pSampleMask : ~VkSampleMask{ 0 });
+		appendKey(key, multisample.alphaToCoverageEnable);
+		appendKey(key, multisample.alphaToOneEnable);
+	}
+
+	void appendVertexInputKey(std::string& key, const PipelineConfigInfo& configInfo) {
+		appendKey(key, configInfo.bindingDescriptions);
+		appendKey(key, configInfo.attributeDescriptions);
+		appendKey(key, configInfo.inputAssemblyInfo.topology);
+		appendKey(key, configInfo.inputAssemblyInfo.primitiveRestartEnable);
+	}
+
+	void appendPreRasterizationKey(std::string& key, const PipelineConfigInfo& configInfo, uint64_t vertShaderId) {
+		appendKey(key, vertShaderId);
+		appendKey(key, configInfo.vertSpecialization);
+		appendKey(key, configInfo.pipelineLayout);
+
+		appendKey(key, configInfo.viewportInfo.viewportCount);
+		appendKey(key, configInfo.viewportInfo.scissorCount);
+
+		const auto& raster = configInfo.rasterizerInfo;
+		appendKey(key, raster.depthClampEnable);
+		appendKey(key, raster.rasterizerDiscardEnable);
+		appendKey(key, raster.polygonMode);
+		appendKey(key, raster.cullMode);
+		appendKey(key, raster.frontFace);
+		appendKey(key, raster.depthBiasEnable);
+		appendKey(key, raster.depthBiasConstantFactor);
+		appendKey(key, raster.depthBiasClamp);
+		appendKey(key, raster.depthBiasSlopeFactor);
+		appendKey(key, raster.lineWidth);
+
+		appendKey(key, configInfo.dynamicStateEnables);
+	}
+
+	void appendFragmentShaderKey(std::string& key, const PipelineConfigInfo& configInfo, uint64_t fragShaderId) {
+		appendKey(key, fragShaderId);
+		appendKey(key, configInfo.fragSpecialization);
+		appendKey(key, configInfo.pipelineLayout);
+		appendMultisampleKey(key, configInfo.multisamplInfo);
+
+		const auto& depth = configInfo.depthStencilInfo;
+		appendKey(key, depth.depthTestEnable);
+		appendKey(key, depth.depthWriteEnable);
+		appendKey(key, depth.depthCompareOp);
+		appendKey(key, depth.depthBoundsTestEnable);
+		appendKey(key, depth.stencilTestEnable);
+		appendKey(key, depth.front);
+		appendKey(key, depth.back);
+		appendKey(key, depth.minDepthBounds);
+		appendKey(key, depth.maxDepthBounds);
+	}
+
+	void appendFragmentOutputKey(std::string& key, const PipelineConfigInfo& configInfo) {
+		appendMultisampleKey(key, configInfo.multisamplInfo);
+
+		// VkPipelineColorBlendAttachmentState is all 32-bit fields, so it has no padding
+		appendKey(key, configInfo.colorBlendAttachment);
+		appendKey(key, configInfo.colorBlendInfo.logicOpEnable);
+		appendKey(key, configInfo.colorBlendInfo.logicOp);
+		appendKey(key, configInfo.colorBlendInfo.attachmentCount);
+		appendKey(key, configInfo.colorBlendInfo.blendConstants);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "lve_pipeline.hpp"
+#include "lve_specialization.hpp"
+
+// std
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace lve {
+	// Byte-string keys for pipeline state. State is serialized field by field so Vulkan struct padding and
+	// pNext pointers never leak into a key; equal keys mean interchangeable pipelines (or library parts).
+
+	template <typename T>
+	void appendKey(std::string& key, const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "key fields must be trivially copyable");
+		key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	void appendKey(std::string& key, const std::vector<T>& values) {
+		appendKey(key, values.size());
+		for (const auto& value : values) {
+			appendKey(key, value);
+		}
+	}
+
+	void appendKey(std::string& key, const VkStencilOpState& state);
+	void appendKey(std::string& key, const LveSpecializationConstants& constants);
+
+	// One function per VK_EXT_graphics_pipeline_library part; together they cover all of PipelineConfigInfo.
+	// Shaders are keyed by LveShaderModule::getId(), so only the same deduplicated module matches.
+	void appendVertexInputKey(std::string& key, const PipelineConfigInfo& configInfo);
+	void appendPreRasterizationKey(std::string& key, const PipelineConfigInfo& configInfo, uint64_t vertShaderId);
+	void appendFragmentShaderKey(std::string& key, const PipelineConfigInfo& configInfo, uint64_t fragShaderId);
+	void appendFragmentOutputKey(std::string& key, const PipelineConfigInfo& configInfo);
+}
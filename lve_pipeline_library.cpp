@@ -0,0 +1,240 @@
+#include "lve_pipeline_library.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_pipeline_key.hpp"
+
+// std
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace lve {
+	namespace {
+		enum PartTag : uint8_t {
+			VERTEX_INPUT_PART = 0,
+			PRE_RASTERIZATION_PART = 1,
+			FRAGMENT_SHADER_PART = 2,
+			FRAGMENT_OUTPUT_PART = 3,
+		};
+
+		double millisecondsSince(std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	LvePipelineLibrary::LvePipelineLibrary(LveDevice& device) : lveDevice{ device } {
+		assert(lveDevice.supportsGraphicsPipelineLibrary() && "VK_EXT_graphics_pipeline_library is not enabled");
+	}
+
+	LvePipelineLibrary::~LvePipelineLibrary() {
+		for (auto& kv : parts) {
+			vkDestroyPipeline(lveDevice.device(), kv.second, allocationCallbacks(LveMemoryTag::Pipelines));
+		}
+	}
+
+	VkPipeline LvePipelineLibrary::link(
+		const LveShaderModule& vertShader,
+		const LveShaderModule& fragShader,
+		const PipelineConfigInfo& configInfo,
+		const std::string& renderPassKey,
+		bool optimize) {
+		assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "Cannot link graphics pipeline:: no pipelineLayout provided in configInfo");
+		assert(configInfo.renderPass != VK_NULL_HANDLE && "Cannot link graphics pipeline:: no renderPass provided in configInfo");
+
+		std::string key;
+		key.push_back(VERTEX_INPUT_PART);
+		appendVertexInputKey(key, configInfo);
+		VkPipeline vertexInput = getPart(key, VK_NULL_HANDLE, [&]() { return createVertexInputPart(configInfo); });
+
+		key.assign(1, PRE_RASTERIZATION_PART);
+		key += renderPassKey;
+		appendPreRasterizationKey(key, configInfo, vertShader.getId());
+		VkPipeline preRasterization = getPart(key, configInfo.pipelineLayout, [&]() { return createPreRasterizationPart(vertShader, configInfo); });
+
+		key.assign(1, FRAGMENT_SHADER_PART);
+		key += renderPassKey;
+		appendFragmentShaderKey(key, configInfo, fragShader.getId());
+		VkPipeline fragmentShader = getPart(key, configInfo.pipelineLayout, [&]() { return createFragmentShaderPart(fragShader, configInfo); });
+
+		key.assign(1, FRAGMENT_OUTPUT_PART);
+		key += renderPassKey;
+		appendFragmentOutputKey(key, configInfo);
+		VkPipeline fragmentOutput = getPart(key, VK_NULL_HANDLE, [&]() { return createFragmentOutputPart(configInfo); });
+
+		VkPipeline libraries[] = { vertexInput, preRasterization, fragmentShader, fragmentOutput };
+
+		VkPipelineLibraryCreateInfoKHR linkInfo{};
+		linkInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		linkInfo.libraryCount = 4;
+		linkInfo.pLibraries = libraries;
+
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = &linkInfo;
+		pipelineInfo.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+		pipelineInfo.layout = configInfo.pipelineLayout;
+		pipelineInfo.basePipelineIndex = -1;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		auto start = std::chrono::steady_clock::now();
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(lveDevice.device(), lveDevice.pipelineCache(), 1, &pipelineInfo, allocationCallbacks(LveMemoryTag::Pipelines), &pipeline) != VK_SUCCESS) {
+			throw std::runtime_error("failed to link graphics pipeline library!");
+		}
+		double linkMs = millisecondsSince(start);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (optimize) {
+			stats.optimizedLinks++;
+			stats.optimizedLinkMs += linkMs;
+		}
+		else {
+			stats.fastLinks++;
+			stats.fastLinkMs += linkMs;
+		}
+		return pipeline;
+	}
+
+	void LvePipelineLibrary::releaseLayout(VkPipelineLayout layout) {
+		std::vector<VkPipeline> released{};
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto [first, last] = partKeysByLayout.equal_range(layout);
+			for (auto it = first; it != last; ++it) {
+				auto part = parts.find(it->second);
+				if (part == parts.end()) continue;
+				released.push_back(part->second);
+				parts.erase(part);
+			}
+			partKeysByLayout.erase(layout);
+		}
+		if (released.empty()) return;
+
+		// a link queued before the release may still be reading the parts
+		lveDevice.deferDestruction([device = lveDevice.device(), released]() {
+			for (auto part : released) vkDestroyPipeline(device, part, allocationCallbacks(LveMemoryTag::Pipelines));
+		});
+	}
+
+	LvePipelineLibrary::Stats LvePipelineLibrary::getStats() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return stats;
+	}
+
+	VkPipeline LvePipelineLibrary::getPart(const std::string& key, VkPipelineLayout layout, const std::function<VkPipeline()>& createPart) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = parts.find(key);
+			if (it != parts.end()) {
+				stats.partHits++;
+				return it->second;
+			}
+		}
+
+		// compiled outside the lock so independent parts build in parallel
+		auto start = std::chrono::steady_clock::now();
+		VkPipeline part = createPart();
+		double compileMs = millisecondsSince(start);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.partMisses++;
+		stats.partCompileMs += compileMs;
+		auto inserted = parts.emplace(key, part);
+		if (!inserted.second) {
+			// another thread built the same part meanwhile
+			vkDestroyPipeline(lveDevice.device(), part, allocationCallbacks(LveMemoryTag::Pipelines));
+		}
+		else if (layout != VK_NULL_HANDLE) {
+			partKeysByLayout.emplace(layout, key);
+		}
+		return inserted.first->second;
+	}
+
+	VkPipeline LvePipelineLibrary::createPart(VkGraphicsPipelineCreateInfo& pipelineInfo, VkGraphicsPipelineLibraryFlagsEXT flags) {
+		VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+		libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+		libraryInfo.flags = flags;
+
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = &libraryInfo;
+		// retain LTO info so the background optimized link can inline across parts
+		pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+		pipelineInfo.basePipelineIndex = -1;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		VkPipeline part;
+		if (vkCreateGraphicsPipelines(lveDevice.device(), lveDevice.pipelineCache(), 1, &pipelineInfo, allocationCallbacks(LveMemoryTag::Pipelines), &part) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create graphics pipeline library part!");
+		}
+		return part;
+	}
+
+	VkPipeline LvePipelineLibrary::createVertexInputPart(const PipelineConfigInfo& configInfo) {
+		auto& bindingDescriptions = configInfo.bindingDescriptions;
+		auto& attributeDescriptions = configInfo.attributeDescriptions;
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &configInfo.inputAssemblyInfo;
+		return createPart(pipelineInfo, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+	}
+
+	VkPipeline LvePipelineLibrary::createPreRasterizationPart(const LveShaderModule& vertShader, const PipelineConfigInfo& configInfo) {
+		VkSpecializationInfo specializationInfo = configInfo.vertSpecialization.getInfo();
+
+		VkPipelineShaderStageCreateInfo shaderStage{};
+		shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		shaderStage.module = vertShader.getShaderModule();
+		shaderStage.pName = "main";
+		shaderStage.pSpecializationInfo = configInfo.vertSpecialization.empty() ? nullptr : &specializationInfo;
+
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.stageCount = 1;
+		pipelineInfo.pStages = &shaderStage;
+		pipelineInfo.pViewportState = &configInfo.viewportInfo;
+		pipelineInfo.pRasterizationState = &configInfo.rasterizerInfo;
+		pipelineInfo.pDynamicState = &configInfo.dynamicStateInfo;
+		pipelineInfo.layout = configInfo.pipelineLayout;
+		pipelineInfo.renderPass = configInfo.renderPass;
+		pipelineInfo.subpass = configInfo.subpass;
+		return createPart(pipelineInfo, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+	}
+
+	VkPipeline LvePipelineLibrary::createFragmentShaderPart(const LveShaderModule& fragShader, const PipelineConfigInfo& configInfo) {
+		VkSpecializationInfo specializationInfo = configInfo.fragSpecialization.getInfo();
+
+		VkPipelineShaderStageCreateInfo shaderStage{};
+		shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		shaderStage.module = fragShader.getShaderModule();
+		shaderStage.pName = "main";
+		shaderStage.pSpecializationInfo = configInfo.fragSpecialization.empty() ? nullptr : &specializationInfo;
+
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.stageCount = 1;
+		pipelineInfo.pStages = &shaderStage;
+		pipelineInfo.pMultisampleState = &configInfo.multisamplInfo;
+		pipelineInfo.pDepthStencilState = &configInfo.depthStencilInfo;
+		pipelineInfo.layout = configInfo.pipelineLayout;
+		pipelineInfo.renderPass = configInfo.renderPass;
+		pipelineInfo.subpass = configInfo.subpass;
+		return createPart(pipelineInfo, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+	}
+
+	VkPipeline LvePipelineLibrary::createFragmentOutputPart(const PipelineConfigInfo& configInfo) {
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.pMultisampleState = &configInfo.multisamplInfo;
+		pipelineInfo.pColorBlendState = &configInfo.colorBlendInfo;
+		pipelineInfo.renderPass = configInfo.renderPass;
+		pipelineInfo.subpass = configInfo.subpass;
+		return createPart(pipelineInfo, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_pipeline.hpp"
+#include "lve_shader_module.hpp"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace lve {
+	// Builds PipelineConfigInfo permutations from VK_EXT_graphics_pipeline_library parts. The four parts
+	// (vertex input, pre-rasterization, fragment shader, fragment output) are compiled once per distinct
+	// sub-state and cached, so a new blend or depth variant only costs a link. Requires
+	// LveDevice::supportsGraphicsPipelineLibrary().
+	class LvePipelineLibrary {
+	public:
+		struct Stats {
+			uint64_t partHits = 0;
+			uint64_t partMisses = 0;
+			uint64_t fastLinks = 0;
+			uint64_t optimizedLinks = 0;
+			double partCompileMs = 0.0;
+			double fastLinkMs = 0.0;
+			double optimizedLinkMs = 0.0;
+		};
+
+		LvePipelineLibrary(LveDevice& device);
+		~LvePipelineLibrary();
+
+		LvePipelineLibrary(const LvePipelineLibrary&) = delete;
+		LvePipelineLibrary& operator=(const LvePipelineLibrary&) = delete;
+
+		// optimize = false links without link-time optimization, which is fast enough to do on demand;
+		// optimize = true produces the pipeline a monolithic compile would, for swapping in later.
+		VkPipeline link(
+			const LveShaderModule& vertShader,
+			const LveShaderModule& fragShader,
+			const PipelineConfigInfo& configInfo,
+			const std::string& renderPassKey,
+			bool optimize);
+
+		// parts are keyed by layout handle, which the driver may hand out again once the layout is destroyed; call
+		// before destroying a layout so its parts are released rather than matched by a new layout
+		void releaseLayout(VkPipelineLayout layout);
+
+		Stats getStats() const;
+
+	private:
+		// layout is the one the part was created against, VK_NULL_HANDLE for parts that take none
+		VkPipeline getPart(const std::string& key, VkPipelineLayout layout, const std::function<VkPipeline()>& createPart);
+		VkPipeline createPart(VkGraphicsPipelineCreateInfo& pipelineInfo, VkGraphicsPipelineLibraryFlagsEXT flags);
+
+		VkPipeline createVertexInputPart(const PipelineConfigInfo& configInfo);
+		VkPipeline createPreRasterizationPart(const LveShaderModule& vertShader, const PipelineConfigInfo& configInfo);
+		VkPipeline createFragmentShaderPart(const LveShaderModule& fragShader, const PipelineConfigInfo& configInfo);
+		VkPipeline createFragmentOutputPart(const PipelineConfigInfo& configInfo);
+
+		LveDevice& lveDevice;
+
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, VkPipeline> parts{};
+		std::unordered_multimap<VkPipelineLayout, std::string> partKeysByLayout{};
+		Stats stats{};
+	};
+}
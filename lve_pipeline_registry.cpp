@@ -0,0 +1,319 @@
+#include "lve_pipeline_registry.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_pipeline_key.hpp"
+
+// std
+#include <cassert>
+#include <exception>
+
+namespace lve {
+	bool LvePipelineHandle::isReady() const {
+		return pipeline != nullptr ||
+			(future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	}
+
+	LvePipeline& LvePipelineHandle::get() {
+		assert(future.valid() && "Cannot use a pipeline handle that was never requested");
+		if (!pipeline) {
+			pipeline = future.get();
+		}
+		return *pipeline;
+	}
+
+	std::shared_ptr<LvePipeline> LvePipelineHandle::share() {
+		get();
+		return pipeline;
+	}
+
+	LvePipelineRegistry::LvePipelineRegistry(LveDevice& device, LveThreadPool* threadPool, bool allowPipelineLibrary)
+		: lveDevice{ device }, threadPool{ threadPool } {
+		if (allowPipelineLibrary && lveDevice.supportsGraphicsPipelineLibrary()) {
+			pipelineLibrary = std::make_unique<LvePipelineLibrary>(lveDevice);
+		}
+	}
+
+	LvePipelineRegistry::~LvePipelineRegistry() {
+		// jobs still in flight reference this registry
+		waitIdle();
+	}
+
+	std::shared_ptr<LveShaderModule> LvePipelineRegistry::getShaderModule(const std::string& filepath) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = shaderModulesByPath.find(filepath);
+			if (it != shaderModulesByPath.end()) {
+				stats.shaderHits++;
+				return it->second;
+			}
+		}
+
+		auto code = LvePipeline::readFile(filepath);
+		size_t codeHash = LveShaderModule::hashCode(code);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto [first, last] = shaderModulesByCode.equal_range(codeHash);
+		for (auto it = first; it != last; ++it) {
+			if (it->second->getCode() != code) continue;
+			// same SPIR-V reached through a different path
+			stats.shaderHits++;
+			shaderModulesByPath[filepath] = it->second;
+			return it->second;
+		}
+
+		stats.shaderMisses++;
+		auto shaderModule = std::make_shared<LveShaderModule>(lveDevice, code);
+		shaderModulesByCode.emplace(codeHash, shaderModule);
+		shaderModulesByPath[filepath] = shaderModule;
+		return shaderModule;
+	}
+
+	LvePipelineHandle LvePipelineRegistry::requestPipeline(
+		const std::string& vertFilepath,
+		const std::string& fragFilepath,
+		const PipelineConfigInfo& configInfo) {
+		LVE_MEMORY_SCOPE(LveMemoryTag::Pipelines);
+		auto vertShader = getShaderModule(vertFilepath);
+		auto fragShader = getShaderModule(fragFilepath);
+
+		std::shared_ptr<std::packaged_task<std::shared_ptr<LvePipeline>()>> task;
+		PipelineFuture future;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::string passKey = renderPassKey(configInfo.renderPass, configInfo.subpass);
+			std::string key = makePipelineKey(
+				configInfo,
+				passKey,
+				vertShader->getId(),
+				fragShader->getId());
+
+			auto it = pipelines.find(key);
+			if (it != pipelines.end()) {
+				stats.pipelineHits++;
+				return LvePipelineHandle{ it->second };
+			}
+			stats.pipelineMisses++;
+			if (!hasRequests) {
+				firstRequestTime = std::chrono::steady_clock::now();
+				hasRequests = true;
+			}
+
+			auto ownedConfig = std::make_shared<PipelineConfigInfo>();
+			LvePipeline::copyPipelineConfigInfo(configInfo, *ownedConfig);
+			// the config's layout and render pass are not owned; until the job has run, holding the deletion queue
+			// keeps their owners' deferred destruction from freeing them, whatever order those owners go in
+			auto handles = lveDevice.holdDeferredDestruction();
+			task = std::make_shared<std::packaged_task<std::shared_ptr<LvePipeline>()>>(
+				[this, vertShader, fragShader, ownedConfig, passKey, handles]() {
+					return compilePipeline(vertShader, fragShader, ownedConfig, passKey, handles);
+				});
+			future = task->get_future().share();
+			pipelineKeysByLayout.emplace(configInfo.pipelineLayout, key);
+			pipelines.emplace(std::move(key), future);
+		}
+
+		if (threadPool != nullptr) {
+			threadPool->submit([task]() { (*task)(); });
+		}
+		else {
+			(*task)();
+		}
+		return LvePipelineHandle{ future };
+	}
+
+	std::shared_ptr<LvePipeline> LvePipelineRegistry::getPipeline(
+		const std::string& vertFilepath,
+		const std::string& fragFilepath,
+		const PipelineConfigInfo& configInfo) {
+		return requestPipeline(vertFilepath, fragFilepath, configInfo).share();
+	}
+
+	std::shared_ptr<LvePipeline> LvePipelineRegistry::compilePipeline(
+		std::shared_ptr<LveShaderModule> vertShader,
+		std::shared_ptr<LveShaderModule> fragShader,
+		std::shared_ptr<PipelineConfigInfo> configInfo,
+		const std::string& renderPassKey,
+		LveDeletionQueue::Hold handles) {
+		auto start = std::chrono::steady_clock::now();
+		// the device pipeline cache is internally synchronized, so workers share it directly
+		std::shared_ptr<LvePipeline> pipeline;
+		if (pipelineLibrary) {
+			// without workers to optimize later, link the optimized pipeline right away
+			bool optimizeNow = threadPool == nullptr;
+			VkPipeline linked = pipelineLibrary->link(*vertShader, *fragShader, *configInfo, renderPassKey, optimizeNow);
+			pipeline = std::make_shared<LvePipeline>(lveDevice, linked);
+		}
+		else {
+			pipeline = std::make_shared<LvePipeline>(lveDevice, vertShader, fragShader, *configInfo);
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.compileCpuMs += std::chrono::duration<double, std::milli>(end - start).count();
+		stats.compileWallMs = std::chrono::duration<double, std::milli>(end - firstRequestTime).count();
+
+		if (pipelineLibrary && threadPool != nullptr) {
+			// the relink builds against the same layout and render pass, so it inherits the compile's hold; the
+			// registry's own map keeps the pipeline alive, so the weak reference alone would not stop it
+			std::weak_ptr<LvePipeline> weakPipeline = pipeline;
+			optimizeJobs.push_back(threadPool->submit(
+				[this, weakPipeline, vertShader, fragShader, configInfo, renderPassKey, handles]() {
+					optimizePipeline(weakPipeline, vertShader, fragShader, configInfo, renderPassKey);
+				}));
+		}
+		return pipeline;
+	}
+
+	void LvePipelineRegistry::optimizePipeline(
+		std::weak_ptr<LvePipeline> pipeline,
+		std::shared_ptr<LveShaderModule> vertShader,
+		std::shared_ptr<LveShaderModule> fragShader,
+		std::shared_ptr<PipelineConfigInfo> configInfo,
+		const std::string& renderPassKey) {
+		if (pipeline.expired()) return;
+
+		VkPipeline optimized;
+		try {
+			optimized = pipelineLibrary->link(*vertShader, *fragShader, *configInfo, renderPassKey, true);
+		}
+		catch (const std::exception&) {
+			// the fast-linked pipeline stays in use
+			return;
+		}
+
+		if (auto target = pipeline.lock()) {
+			target->replacePipeline(optimized);
+		}
+		else {
+			vkDestroyPipeline(lveDevice.device(), optimized, allocationCallbacks(LveMemoryTag::Pipelines));
+		}
+	}
+
+	void LvePipelineRegistry::waitIdle() {
+		std::vector<PipelineFuture> pending;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto& kv : pipelines) {
+				pending.push_back(kv.second);
+			}
+		}
+		for (auto& future : pending) {
+			future.wait();
+		}
+
+		// optimize jobs are queued by compile jobs, so collect them only once those finished
+		std::vector<std::future<void>> optimizing;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			optimizing.swap(optimizeJobs);
+		}
+		for (auto& job : optimizing) {
+			job.wait();
+		}
+	}
+
+	void LvePipelineRegistry::registerRenderPass(VkRenderPass renderPass, const RenderPassCompatibility& compatibility) {
+		std::lock_guard<std::mutex> lock(mutex);
+		renderPasses[renderPass] = compatibility;
+	}
+
+	void LvePipelineRegistry::unregisterRenderPass(VkRenderPass renderPass) {
+		std::lock_guard<std::mutex> lock(mutex);
+		renderPasses.erase(renderPass);
+	}
+
+	void LvePipelineRegistry::releaseUnused() {
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto it = pipelines.begin(); it != pipelines.end();) {
+			if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				++it;
+				continue;
+			}
+			bool unused;
+			try {
+				unused = it->second.get().use_count() == 1;
+			}
+			catch (const std::exception&) {
+				// failed compiles are forgotten so the next request retries them
+				unused = true;
+			}
+			it = unused ? pipelines.erase(it) : std::next(it);
+		}
+		for (auto it = pipelineKeysByLayout.begin(); it != pipelineKeysByLayout.end();) {
+			it = pipelines.count(it->second) == 0 ? pipelineKeysByLayout.erase(it) : std::next(it);
+		}
+
+		std::unordered_map<LveShaderModule*, long> registryRefs{};
+		for (auto& kv : shaderModulesByPath) {
+			registryRefs[kv.second.get()]++;
+		}
+		for (auto it = shaderModulesByCode.begin(); it != shaderModulesByCode.end();) {
+			auto* shaderModule = it->second.get();
+			if (it->second.use_count() - 1 - registryRefs[shaderModule] > 0) {
+				++it;
+				continue;
+			}
+			for (auto pathIt = shaderModulesByPath.begin(); pathIt != shaderModulesByPath.end();) {
+				pathIt = pathIt->second.get() == shaderModule ? shaderModulesByPath.erase(pathIt) : std::next(pathIt);
+			}
+			it = shaderModulesByCode.erase(it);
+		}
+	}
+
+	void LvePipelineRegistry::releasePipelineLayout(VkPipelineLayout layout) {
+		// a compile or relink still queued against the layout would put its parts back after the release
+		waitIdle();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			// handles already given out keep their pipelines; only new requests stop matching them
+			auto [first, last] = pipelineKeysByLayout.equal_range(layout);
+			for (auto it = first; it != last; ++it) {
+				pipelines.erase(it->second);
+			}
+			pipelineKeysByLayout.erase(layout);
+		}
+		if (pipelineLibrary) {
+			pipelineLibrary->releaseLayout(layout);
+		}
+	}
+
+	LvePipelineRegistry::Stats LvePipelineRegistry::getStats() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		Stats result = stats;
+		if (pipelineLibrary) {
+			result.usesPipelineLibrary = true;
+			result.library = pipelineLibrary->getStats();
+		}
+		return result;
+	}
+
+	std::string LvePipelineRegistry::renderPassKey(VkRenderPass renderPass, uint32_t subpass) const {
+		std::string key;
+		appendKey(key, subpass);
+
+		auto it = renderPasses.find(renderPass);
+		if (it == renderPasses.end()) {
+			appendKey(key, renderPass);
+			return key;
+		}
+		appendKey(key, it->second.colorFormats);
+		appendKey(key, it->second.depthFormat);
+		appendKey(key, it->second.samples);
+		return key;
+	}
+
+	std::string LvePipelineRegistry::makePipelineKey(
+		const PipelineConfigInfo& configInfo,
+		const std::string& renderPassKey,
+		uint64_t vertShaderId,
+		uint64_t fragShaderId) {
+		std::string key;
+		key.reserve(512);
+
+		key += renderPassKey;
+		appendVertexInputKey(key, configInfo);
+		appendPreRasterizationKey(key, configInfo, vertShaderId);
+		appendFragmentShaderKey(key, configInfo, fragShaderId);
+		appendFragmentOutputKey(key, configInfo);
+		return key;
+	}
+}
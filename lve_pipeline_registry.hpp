@@ -0,0 +1,138 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_pipeline.hpp"
+#include "lve_pipeline_library.hpp"
+#include "lve_shader_module.hpp"
+#include "lve_specialization.hpp"
+#include "lve_thread_pool.hpp"
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+	// The parts of a render pass that decide whether a pipeline built against it may be reused
+	// with another one (see "Render Pass Compatibility" in the Vulkan spec).
+	struct RenderPassCompatibility {
+		std::vector<VkFormat> colorFormats{};
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+	};
+
+	// A pipeline that may still be compiling. Only the first access blocks, and only if the
+	// worker has not finished yet; compile errors are rethrown from there.
+	class LvePipelineHandle {
+	public:
+		LvePipelineHandle() = default;
+		explicit LvePipelineHandle(std::shared_future<std::shared_ptr<LvePipeline>> future) : future{ std::move(future) } {}
+
+		bool isReady() const;
+		LvePipeline& get();
+		std::shared_ptr<LvePipeline> share();
+		LvePipeline* operator->() { return &get(); }
+		explicit operator bool() const { return future.valid(); }
+
+	private:
+		std::shared_future<std::shared_ptr<LvePipeline>> future{};
+		std::shared_ptr<LvePipeline> pipeline{};
+	};
+
+	// Deduplicates shader modules and graphics pipelines. Two requests with identical
+	// PipelineConfigInfo state, shaders and a compatible render pass share one LvePipeline.
+	class LvePipelineRegistry {
+	public:
+		struct Stats {
+			uint64_t pipelineHits = 0;
+			uint64_t pipelineMisses = 0;
+			uint64_t shaderHits = 0;
+			uint64_t shaderMisses = 0;
+			// summed time spent inside vkCreateGraphicsPipelines, and first request to last completion
+			double compileCpuMs = 0.0;
+			double compileWallMs = 0.0;
+			// filled in when pipelines are linked from graphics pipeline library parts
+			bool usesPipelineLibrary = false;
+			LvePipelineLibrary::Stats library{};
+		};
+
+		// With a thread pool, requestPipeline compiles on its workers; otherwise on the calling thread.
+		// When the device supports VK_EXT_graphics_pipeline_library and allowPipelineLibrary is set, new
+		// pipelines are fast-linked from cached parts and swapped for an optimized link in the background.
+		LvePipelineRegistry(LveDevice& device, LveThreadPool* threadPool = nullptr, bool allowPipelineLibrary = true);
+		~LvePipelineRegistry();
+
+		LvePipelineRegistry(const LvePipelineRegistry&) = delete;
+		LvePipelineRegistry& operator=(const LvePipelineRegistry&) = delete;
+
+		// Declares a pipeline and returns immediately. configInfo is copied, so it may go out of scope; its layout
+		// and render pass must be destroyed through LveDevice::deferDestruction, which waits for queued jobs.
+		LvePipelineHandle requestPipeline(
+			const std::string& vertFilepath,
+			const std::string& fragFilepath,
+			const PipelineConfigInfo& configInfo);
+		std::shared_ptr<LvePipeline> getPipeline(
+			const std::string& vertFilepath,
+			const std::string& fragFilepath,
+			const PipelineConfigInfo& configInfo);
+		void waitIdle();
+		std::shared_ptr<LveShaderModule> getShaderModule(const std::string& filepath);
+
+		// Without a registered description, render passes are only considered compatible with themselves.
+		void registerRenderPass(VkRenderPass renderPass, const RenderPassCompatibility& compatibility);
+		void unregisterRenderPass(VkRenderPass renderPass);
+
+		// Drops pipelines and shader modules that are no longer referenced outside the registry.
+		void releaseUnused();
+		// Forgets pipelines and library parts built against the layout, whose handle value may be reused once it is
+		// destroyed. Owners call it right before handing the layout to LveDevice::deferDestruction; it waits for
+		// queued compiles first, so it belongs at teardown rather than in the frame loop.
+		void releasePipelineLayout(VkPipelineLayout layout);
+
+		Stats getStats() const;
+
+		static std::string makePipelineKey(
+			const PipelineConfigInfo& configInfo,
+			const std::string& renderPassKey,
+			uint64_t vertShaderId,
+			uint64_t fragShaderId);
+
+	private:
+		using PipelineFuture = std::shared_future<std::shared_ptr<LvePipeline>>;
+
+		std::string renderPassKey(VkRenderPass renderPass, uint32_t subpass) const;
+		std::shared_ptr<LvePipeline> compilePipeline(
+			std::shared_ptr<LveShaderModule> vertShader,
+			std::shared_ptr<LveShaderModule> fragShader,
+			std::shared_ptr<PipelineConfigInfo> configInfo,
+			const std::string& renderPassKey,
+			LveDeletionQueue::Hold handles);
+		void optimizePipeline(
+			std::weak_ptr<LvePipeline> pipeline,
+			std::shared_ptr<LveShaderModule> vertShader,
+			std::shared_ptr<LveShaderModule> fragShader,
+			std::shared_ptr<PipelineConfigInfo> configInfo,
+			const std::string& renderPassKey);
+
+		LveDevice& lveDevice;
+		LveThreadPool* threadPool;
+		std::unique_ptr<LvePipelineLibrary> pipelineLibrary{};
+
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, std::shared_ptr<LveShaderModule>> shaderModulesByPath{};
+		// bucketed by code hash; modules in a bucket are told apart by comparing their code
+		std::unordered_multimap<size_t, std::shared_ptr<LveShaderModule>> shaderModulesByCode{};
+		std::unordered_map<std::string, PipelineFuture> pipelines{};
+		std::unordered_multimap<VkPipelineLayout, std::string> pipelineKeysByLayout{};
+		std::vector<std::future<void>> optimizeJobs{};
+		std::unordered_map<VkRenderPass, RenderPassCompatibility> renderPasses{};
+		Stats stats{};
+		std::chrono::steady_clock::time_point firstRequestTime{};
+		bool hasRequests = false;
+	};
+}
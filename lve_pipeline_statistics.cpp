@@ -0,0 +1,163 @@
+#include "lve_pipeline_statistics.hpp"
+
+#include "lve_allocation_tracker.hpp"
+#include "lve_renderer_config.hpp"
+
+// std
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+	namespace {
+		// results come back in bit order, which is also the order of the fields in Counters
+		constexpr VkQueryPipelineStatisticFlags STATISTICS =
+			VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+		constexpr uint32_t STATISTIC_COUNT = 7;
+		// the counters followed by the availability word
+		constexpr uint32_t RESULT_WORDS = STATISTIC_COUNT + 1;
+	}
+
+	LvePipelineStatistics::Counters& LvePipelineStatistics::Counters::operator+=(const Counters& other) {
+		inputAssemblyVertices += other.inputAssemblyVertices;
+		inputAssemblyPrimitives += other.inputAssemblyPrimitives;
+		vertexShaderInvocations += other.vertexShaderInvocations;
+		clippingInvocations += other.clippingInvocations;
+		clippingPrimitives += other.clippingPrimitives;
+		fragmentShaderInvocations += other.fragmentShaderInvocations;
+		computeShaderInvocations += other.computeShaderInvocations;
+		return *this;
+	}
+
+	LvePipelineStatistics::LvePipelineStatistics(LveDevice& device, uint32_t maxPassesPerFrame)
+		: lveDevice{ device }, maxPassesPerFrame{ maxPassesPerFrame } {
+		assert(maxPassesPerFrame > 0 && "Pipeline statistics need room for at least one pass");
+		if (!lveDevice.supportsPipelineStatisticsQuery()) {
+			std::cerr << "Pipeline statistics: queries unsupported, passes are not counted" << std::endl;
+			return;
+		}
+
+		frameSlots.resize(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
+		for (auto& slot : frameSlots) {
+			VkQueryPoolCreateInfo queryPoolInfo{};
+			queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+			queryPoolInfo.queryCount = maxPassesPerFrame;
+			queryPoolInfo.pipelineStatistics = STATISTICS;
+			if (vkCreateQueryPool(lveDevice.device(), &queryPoolInfo, allocationCallbacks(LveMemoryTag::Profiling), &slot.queryPool) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create pipeline statistics query pool!");
+			}
+			slot.passes.reserve(maxPassesPerFrame);
+			slot.results.resize(RESULT_WORDS * maxPassesPerFrame);
+		}
+	}
+
+	LvePipelineStatistics::~LvePipelineStatistics() {
+		// the last frames' command buffers may still write into the pools
+		for (auto& slot : frameSlots) {
+			lveDevice.deferDestruction([device = lveDevice.device(), queryPool = slot.queryPool]() {
+				vkDestroyQueryPool(device, queryPool, allocationCallbacks(LveMemoryTag::Profiling));
+			});
+		}
+	}
+
+	void LvePipelineStatistics::beginFrame(VkCommandBuffer commandBuffer, int frameIndex) {
+		if (frameSlots.empty()) return;
+		assert(!passActive && "Cannot begin a frame while a pipeline statistics pass is active");
+		currentSlot = &frameSlots[frameIndex];
+		collect(*currentSlot);
+		vkCmdResetQueryPool(commandBuffer, currentSlot->queryPool, 0, maxPassesPerFrame);
+	}
+
+	uint32_t LvePipelineStatistics::beginPass(VkCommandBuffer commandBuffer, const char* name, VkExtent2D extent) {
+		if (currentSlot == nullptr || currentSlot->passes.size() == maxPassesPerFrame) return NO_PASS;
+		assert(!passActive && "Pipeline statistics passes cannot nest");
+		uint32_t pass = static_cast<uint32_t>(currentSlot->passes.size());
+		currentSlot->passes.push_back({ name, extent, false });
+		vkCmdBeginQuery(commandBuffer, currentSlot->queryPool, pass, 0);
+		passActive = true;
+		return pass;
+	}
+
+	void LvePipelineStatistics::endPass(VkCommandBuffer commandBuffer, uint32_t pass) {
+		if (pass == NO_PASS) return;
+		assert(currentSlot != nullptr && pass + 1 == currentSlot->passes.size() && "Ending a pass that is not active");
+		vkCmdEndQuery(commandBuffer, currentSlot->queryPool, pass);
+		currentSlot->passes[pass].ended = true;
+		passActive = false;
+	}
+
+	void LvePipelineStatistics::collect(FrameSlot& slot) {
+		if (slot.passes.empty()) return;
+
+		// LveRenderer::beginFrame waited for this slot's timeline value, so the results are there; no WAIT flag
+		const uint32_t queryCount = static_cast<uint32_t>(slot.passes.size());
+		std::vector<uint64_t>& results = slot.results;
+		VkResult result = vkGetQueryPoolResults(
+			lveDevice.device(),
+			slot.queryPool,
+			0,
+			queryCount,
+			RESULT_WORDS * queryCount * sizeof(uint64_t),
+			results.data(),
+			RESULT_WORDS * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (result == VK_SUCCESS || result == VK_NOT_READY) {
+			for (size_t pass = 0; pass < slot.passes.size(); pass++) {
+				const uint64_t* words = &results[RESULT_WORDS * pass];
+				if (!slot.passes[pass].ended || words[STATISTIC_COUNT] == 0) continue;
+				Counters counters{};
+				counters.inputAssemblyVertices = words[0];
+				counters.inputAssemblyPrimitives = words[1];
+				counters.vertexShaderInvocations = words[2];
+				counters.clippingInvocations = words[3];
+				counters.clippingPrimitives = words[4];
+				counters.fragmentShaderInvocations = words[5];
+				counters.computeShaderInvocations = words[6];
+				addSample(slot.passes[pass], counters);
+			}
+		}
+		slot.passes.clear();
+	}
+
+	void LvePipelineStatistics::addSample(const RecordedPass& pass, const Counters& counters) {
+		auto [index, inserted] = passIndices.try_emplace(pass.name, passes.size());
+		if (inserted) passes.push_back({ pass.name });
+
+		PassTotals& totals = passes[index->second];
+		const uint64_t pixels = static_cast<uint64_t>(pass.extent.width) * pass.extent.height;
+		totals.frames++;
+		totals.last = counters;
+		totals.sum += counters;
+		totals.lastOverdraw = pixels > 0 ? static_cast<double>(counters.fragmentShaderInvocations) / pixels : 0.0;
+		totals.overdrawSum += totals.lastOverdraw;
+	}
+
+	std::vector<LvePipelineStatistics::PassStats> LvePipelineStatistics::getStats() const {
+		std::vector<PassStats> stats{};
+		stats.reserve(passes.size());
+		for (const auto& totals : passes) {
+			PassStats pass{};
+			pass.name = totals.name;
+			pass.frames = totals.frames;
+			pass.last = totals.last;
+			pass.average.inputAssemblyVertices = totals.sum.inputAssemblyVertices / totals.frames;
+			pass.average.inputAssemblyPrimitives = totals.sum.inputAssemblyPrimitives / totals.frames;
+			pass.average.vertexShaderInvocations = totals.sum.vertexShaderInvocations / totals.frames;
+			pass.average.clippingInvocations = totals.sum.clippingInvocations / totals.frames;
+			pass.average.clippingPrimitives = totals.sum.clippingPrimitives / totals.frames;
+			pass.average.fragmentShaderInvocations = totals.sum.fragmentShaderInvocations / totals.frames;
+			pass.average.computeShaderInvocations = totals.sum.computeShaderInvocations / totals.frames;
+			pass.lastOverdraw = totals.lastOverdraw;
+			pass.averageOverdraw = totals.overdrawSum / totals.frames;
+			stats.push_back(pass);
+		}
+		return stats;
+	}
+}
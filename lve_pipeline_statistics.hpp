@@ -0,0 +1,127 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+	// Counts what the GPU did inside named passes with VK_QUERY_TYPE_PIPELINE_STATISTICS queries, one query pool
+	// per frame in flight, read back when the slot comes around again like LveGpuProfiler's timestamps. Each
+	// pass also records the extent it rendered at, so fragment shader invocations turn into overdraw.
+	//
+	// Per frame, after LveRenderer::beginFrame and outside any render pass:
+	//   beginFrame(cb, frameIndex) -> beginPass / endPass or LvePipelineStatisticsScope ...
+	// Passes must not nest: only one pipeline statistics query can be active in a command buffer. A pass that
+	// begins inside a render pass must end in the same subpass.
+	class LvePipelineStatistics {
+	public:
+		static constexpr uint32_t NO_PASS = ~0u;
+
+		struct Counters {
+			uint64_t inputAssemblyVertices = 0;
+			uint64_t inputAssemblyPrimitives = 0;
+			uint64_t vertexShaderInvocations = 0;
+			uint64_t clippingInvocations = 0;
+			uint64_t clippingPrimitives = 0;
+			uint64_t fragmentShaderInvocations = 0;
+			uint64_t computeShaderInvocations = 0;
+
+			Counters& operator+=(const Counters& other);
+		};
+
+		struct PassStats {
+			std::string name;
+			uint64_t frames = 0;
+			Counters last{};
+			// per frame, averaged over all frames the pass was counted in
+			Counters average{};
+			// fragment shader invocations per pixel of the pass's extent
+			double lastOverdraw = 0.0;
+			double averageOverdraw = 0.0;
+			// share of primitives entering clipping that left it, i.e. survived frustum clipping and culling
+			double averageClippedFraction() const {
+				return average.clippingInvocations > 0
+					? static_cast<double>(average.clippingPrimitives) / average.clippingInvocations
+					: 0.0;
+			}
+		};
+
+		LvePipelineStatistics(LveDevice& device, uint32_t maxPassesPerFrame = 16);
+		~LvePipelineStatistics();
+
+		LvePipelineStatistics(const LvePipelineStatistics&) = delete;
+		LvePipelineStatistics& operator=(const LvePipelineStatistics&) = delete;
+
+		// collects the counters this slot recorded framesInFlight frames ago and resets its queries
+		void beginFrame(VkCommandBuffer commandBuffer, int frameIndex);
+		// name must outlive the object, e.g. a string literal; extent is the area the pass renders to
+		uint32_t beginPass(VkCommandBuffer commandBuffer, const char* name, VkExtent2D extent);
+		void endPass(VkCommandBuffer commandBuffer, uint32_t pass);
+
+		bool isEnabled() const { return !frameSlots.empty(); }
+		// in the order the passes were first seen
+		std::vector<PassStats> getStats() const;
+
+	private:
+		struct RecordedPass {
+			const char* name;
+			VkExtent2D extent;
+			bool ended;
+		};
+
+		struct FrameSlot {
+			VkQueryPool queryPool = VK_NULL_HANDLE;
+			std::vector<RecordedPass> passes{};
+			// counters and availability per query, sized for maxPassesPerFrame up front
+			std::vector<uint64_t> results{};
+		};
+
+		struct PassTotals {
+			std::string name;
+			uint64_t frames = 0;
+			Counters last{};
+			Counters sum{};
+			double lastOverdraw = 0.0;
+			double overdrawSum = 0.0;
+		};
+
+		void collect(FrameSlot& slot);
+		void addSample(const RecordedPass& pass, const Counters& counters);
+
+		LveDevice& lveDevice;
+		const uint32_t maxPassesPerFrame;
+
+		std::vector<FrameSlot> frameSlots{};
+		FrameSlot* currentSlot = nullptr;
+		bool passActive = false;
+
+		std::vector<PassTotals> passes{};
+		// keyed by the name pointer, which is stable for the literals passes are named with
+		std::unordered_map<const char*, size_t> passIndices{};
+	};
+
+	// counts the commands recorded during its lifetime; a null object records nothing
+	class LvePipelineStatisticsScope {
+	public:
+		LvePipelineStatisticsScope(
+			LvePipelineStatistics* statistics, VkCommandBuffer commandBuffer, const char* name, VkExtent2D extent)
+			: statistics{ statistics }, commandBuffer{ commandBuffer } {
+			if (statistics != nullptr) pass = statistics->beginPass(commandBuffer, name, extent);
+		}
+		~LvePipelineStatisticsScope() {
+			if (statistics != nullptr) statistics->endPass(commandBuffer, pass);
+		}
+
+		LvePipelineStatisticsScope(const LvePipelineStatisticsScope&) = delete;
+		LvePipelineStatisticsScope& operator=(const LvePipelineStatisticsScope&) = delete;
+
+	private:
+		LvePipelineStatistics* statistics;
+		VkCommandBuffer commandBuffer;
+		uint32_t pass = LvePipelineStatistics::NO_PASS;
+	};
+}
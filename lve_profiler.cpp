@@ -0,0 +1,180 @@
+#include "lve_profiler.hpp"
+
+#ifdef LVE_ENABLE_PROFILING
+
+#include "lve_json.hpp"
+#include "lve_percentile.hpp"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace lve {
+	namespace {
+		// per thread; at ~24 bytes an event, 1.5 MB covers several thousand frames of a few dozen zones
+		constexpr uint64_t RING_CAPACITY = 1 << 16;
+
+		struct Event {
+			const char* name;
+			int64_t startNs;
+			int64_t durationNs;
+		};
+
+		struct ThreadRing {
+			uint32_t threadId = 0;
+			std::string threadName{};
+			std::unique_ptr<Event[]> events{ new Event[RING_CAPACITY] };
+			// written only by the owning thread; release so a reader that sees head also sees the events below it
+			std::atomic<uint64_t> head{ 0 };
+		};
+
+		struct Registry {
+			std::mutex mutex;
+			// rings outlive their threads so pool workers that already exited still show up in the trace
+			std::vector<std::unique_ptr<ThreadRing>> rings{};
+			LveProfiler::Clock::time_point epoch = LveProfiler::Clock::now();
+		};
+
+		Registry& registry() {
+			static Registry instance;
+			return instance;
+		}
+
+		ThreadRing* registerThread() {
+			Registry& reg = registry();
+			std::lock_guard<std::mutex> lock(reg.mutex);
+			reg.rings.push_back(std::make_unique<ThreadRing>());
+			reg.rings.back()->threadId = static_cast<uint32_t>(reg.rings.size() - 1);
+			return reg.rings.back().get();
+		}
+
+		ThreadRing& threadRing() {
+			// the only lock a thread ever takes to record, once on its first zone
+			thread_local ThreadRing* ring = registerThread();
+			return *ring;
+		}
+
+		struct ThreadEvents {
+			uint32_t threadId;
+			std::string threadName;
+			std::vector<Event> events;
+		};
+
+		std::vector<ThreadEvents> snapshot() {
+			Registry& reg = registry();
+			std::lock_guard<std::mutex> lock(reg.mutex);
+			std::vector<ThreadEvents> threads{};
+			threads.reserve(reg.rings.size());
+			for (const auto& ring : reg.rings) {
+				uint64_t head = ring->head.load(std::memory_order_acquire);
+				uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+				ThreadEvents thread{ ring->threadId, ring->threadName, {} };
+				thread.events.reserve(static_cast<size_t>(head - first));
+				for (uint64_t i = first; i < head; i++) {
+					thread.events.push_back(ring->events[i % RING_CAPACITY]);
+				}
+				threads.push_back(std::move(thread));
+			}
+			return threads;
+		}
+	}
+
+	void LveProfiler::record(const char* name, Clock::time_point start, Clock::time_point end) {
+		ThreadRing& ring = threadRing();
+		const auto epoch = registry().epoch;
+		uint64_t head = ring.head.load(std::memory_order_relaxed);
+		ring.events[head % RING_CAPACITY] = {
+			name,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count(),
+			std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() };
+		ring.head.store(head + 1, std::memory_order_release);
+	}
+
+	void LveProfiler::setThreadName(const char* name) {
+		threadRing().threadName = name;
+	}
+
+	std::vector<LveProfiler::ZoneStats> LveProfiler::getStats() {
+		std::unordered_map<std::string, std::vector<double>> durations{};
+		for (const auto& thread : snapshot()) {
+			for (const auto& event : thread.events) {
+				durations[event.name].push_back(event.durationNs / 1e6);
+			}
+		}
+
+		std::vector<ZoneStats> stats{};
+		stats.reserve(durations.size());
+		for (auto& [name, samples] : durations) {
+			std::sort(samples.begin(), samples.end());
+			ZoneStats zone{};
+			zone.name = name;
+			zone.count = samples.size();
+			for (double ms : samples) zone.totalMs += ms;
+			zone.averageMs = zone.totalMs / samples.size();
+			zone.p99Ms = percentile(samples, 99);
+			zone.maxMs = samples.back();
+			stats.push_back(zone);
+		}
+		std::sort(stats.begin(), stats.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.totalMs > b.totalMs; });
+		return stats;
+	}
+
+	bool LveProfiler::exportChromeTrace(const std::string& path) {
+		std::ofstream out{ path };
+		if (!out) return false;
+
+		out << "{\"traceEvents\":[";
+		bool first = true;
+		auto separator = [&]() {
+			if (!first) out << ",";
+			out << "\n";
+			first = false;
+		};
+		for (const auto& thread : snapshot()) {
+			if (!thread.threadName.empty()) {
+				separator();
+				out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread.threadId << ",\"args\":{\"name\":";
+				writeJsonString(out, thread.threadName);
+				out << "}}";
+			}
+			for (const auto& event : thread.events) {
+				separator();
+				// complete events, timestamps in microseconds
+				out << "{\"name\":";
+				writeJsonString(out, event.name);
+				out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread.threadId << ",\"ts\":" << event.startNs / 1e3
+					<< ",\"dur\":" << event.durationNs / 1e3 << "}";
+			}
+		}
+		out << "\n]}\n";
+		return static_cast<bool>(out);
+	}
+
+	void LveProfiler::shutdown() {
+		auto stats = getStats();
+		if (stats.empty()) return;
+
+		std::cout << "CPU zones (total / avg / p99 / max ms, count):" << std::endl;
+		for (const auto& zone : stats) {
+			std::cout << "  " << zone.name << ": " << zone.totalMs << " / " << zone.averageMs << " / " << zone.p99Ms
+				<< " / " << zone.maxMs << ", " << zone.count << std::endl;
+		}
+
+		const char* value = std::getenv("LVE_TRACE_FILE");
+		std::string path = value != nullptr ? value : "lve_trace.json";
+		if (exportChromeTrace(path)) {
+			std::cout << "Chrome trace written to " << path << std::endl;
+		}
+		else {
+			std::cerr << "failed to write Chrome trace to " << path << std::endl;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+// CPU instrumentation. Everything below is compiled in only when LVE_ENABLE_PROFILING is defined; otherwise the
+// LVE_PROFILE_* macros expand to nothing and no profiler code or data ends up in the binary.
+//
+//   LVE_PROFILE_ZONE("name");     times the rest of the enclosing scope; name must be a string literal
+//   LVE_PROFILE_THREAD("name");   labels the calling thread in the trace
+//   LVE_PROFILE_SHUTDOWN();       prints per-zone stats and writes the Chrome trace (LVE_TRACE_FILE or lve_trace.json)
+
+#ifdef LVE_ENABLE_PROFILING
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+	// Each thread records finished zones into its own fixed-size ring, so recording takes no lock and only the
+	// newest events of a thread are kept. Reading the rings (stats, export) is meant for when the recording
+	// threads are idle, e.g. at exit.
+	class LveProfiler {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		struct ZoneStats {
+			std::string name;
+			uint64_t count = 0;
+			double totalMs = 0.0;
+			double averageMs = 0.0;
+			double p99Ms = 0.0;
+			double maxMs = 0.0;
+		};
+
+		static void record(const char* name, Clock::time_point start, Clock::time_point end);
+		static void setThreadName(const char* name);
+
+		// over the events still held by the rings, sorted by total time
+		static std::vector<ZoneStats> getStats();
+		// chrome://tracing / Perfetto JSON; returns false when the file cannot be written
+		static bool exportChromeTrace(const std::string& path);
+		static void shutdown();
+	};
+
+	class LveProfileZone {
+	public:
+		explicit LveProfileZone(const char* name) : name{ name }, start{ LveProfiler::Clock::now() } {}
+		~LveProfileZone() { LveProfiler::record(name, start, LveProfiler::Clock::now()); }
+
+		LveProfileZone(const LveProfileZone&) = delete;
+		LveProfileZone& operator=(const LveProfileZone&) = delete;
+
+	private:
+		const char* name;
+		LveProfiler::Clock::time_point start;
+	};
+}
+
+#define LVE_PROFILE_CONCAT_INNER(a, b) a##b
+#define LVE_PROFILE_CONCAT(a, b) LVE_PROFILE_CONCAT_INNER(a, b)
+#define LVE_PROFILE_ZONE(name) ::lve::LveProfileZone LVE_PROFILE_CONCAT(lveProfileZone, __LINE__){ name }
+#define LVE_PROFILE_THREAD(name) ::lve::LveProfiler::setThreadName(name)
+#define LVE_PROFILE_SHUTDOWN() ::lve::LveProfiler::shutdown()
+
+#else
+
+#define LVE_PROFILE_ZONE(name) ((void)0)
+#define LVE_PROFILE_THREAD(name) ((void)0)
+#define LVE_PROFILE_SHUTDOWN() ((void)0)
+
+#endif
@@ -0,0 +1,416 @@
+#include "lve_readback.hpp"
+
+#include "lve_allocation_tracker.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+	namespace {
+		constexpr uint32_t BYTES_PER_PIXEL = 4;
+
+		uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+			static const std::array<uint32_t, 256> table = []() {
+				std::array<uint32_t, 256> entries{};
+				for (uint32_t n = 0; n < 256; n++) {
+					uint32_t c = n;
+					for (int k = 0; k < 8; k++) {
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					}
+					entries[n] = c;
+				}
+				return entries;
+			}();
+
+			crc = ~crc;
+			for (size_t i = 0; i < size; i++) {
+				crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+			}
+			return ~crc;
+		}
+
+		void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		void writeChunk(std::ofstream& file, const char type[4], const std::vector<uint8_t>& data) {
+			std::vector<uint8_t> header{};
+			appendBigEndian(header, static_cast<uint32_t>(data.size()));
+			header.insert(header.end(), type, type + 4);
+			uint32_t crc = crc32(0, reinterpret_cast<const uint8_t*>(type), 4);
+			crc = crc32(crc, data.data(), data.size());
+			std::vector<uint8_t> footer{};
+			appendBigEndian(footer, crc);
+
+			file.write(reinterpret_cast<const char*>(header.data()), header.size());
+			file.write(reinterpret_cast<const char*>(data.data()), data.size());
+			file.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+		}
+
+		bool isBgra(VkFormat format) {
+			return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+		}
+	}
+
+	LveReadback::LveReadback(LveDevice& device, uint32_t ringSize) : lveDevice{ device }, slots(ringSize) {
+		assert(ringSize > 0 && "Readback ring needs at least one slot");
+	}
+
+	LveReadback::~LveReadback() {
+		flush();
+		for (auto& slot : slots) {
+			destroyBuffer(slot);
+		}
+	}
+
+	bool LveReadback::isSupportedFormat(VkFormat format) {
+		return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB || isBgra(format);
+	}
+
+	void LveReadback::destroyBuffer(Slot& slot) {
+		if (slot.buffer == VK_NULL_HANDLE) return;
+		vkUnmapMemory(lveDevice.device(), slot.memory);
+		vkDestroyBuffer(lveDevice.device(), slot.buffer, allocationCallbacks(LveMemoryTag::Buffers));
+		vkFreeMemory(lveDevice.device(), slot.memory, allocationCallbacks(LveMemoryTag::Buffers));
+		slot.buffer = VK_NULL_HANDLE;
+		slot.memory = VK_NULL_HANDLE;
+		slot.mapped = nullptr;
+		slot.size = 0;
+	}
+
+	void LveReadback::ensureCapacity(Slot& slot, VkDeviceSize size) {
+		if (slot.size >= size) return;
+		// only free slots are resized, so neither the GPU nor the encoder still uses the old buffer
+		destroyBuffer(slot);
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(lveDevice.device(), &bufferInfo, allocationCallbacks(LveMemoryTag::Buffers), &slot.buffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create readback buffer!");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(lveDevice.device(), slot.buffer, &memRequirements);
+
+		// cached memory makes the CPU reads fast; uncached write-combined memory reads an order of magnitude slower
+		uint32_t memoryType;
+		const VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		if (lveDevice.tryFindMemoryType(memRequirements.memoryTypeBits, cached | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memoryType)) {
+			slot.coherent = true;
+		}
+		else if (lveDevice.tryFindMemoryType(memRequirements.memoryTypeBits, cached, memoryType)) {
+			slot.coherent = false;
+		}
+		else {
+			memoryType = lveDevice.findMemoryType(
+				memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			slot.coherent = true;
+		}
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memRequirements.size;
+		allocInfo.memoryTypeIndex = memoryType;
+		if (vkAllocateMemory(lveDevice.device(), &allocInfo, allocationCallbacks(LveMemoryTag::Buffers), &slot.memory) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate readback memory!");
+		}
+		vkBindBufferMemory(lveDevice.device(), slot.buffer, slot.memory, 0);
+		if (vkMapMemory(lveDevice.device(), slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS) {
+			throw std::runtime_error("failed to map readback memory!");
+		}
+		slot.size = size;
+	}
+
+	bool LveReadback::capture(
+		VkCommandBuffer commandBuffer,
+		VkImage image,
+		VkFormat format,
+		VkExtent2D extent,
+		VkImageLayout currentLayout,
+		Request request) {
+		assert(isSupportedFormat(format) && "Readback only handles 4-byte RGBA/BGRA formats");
+
+		Slot* slot = nullptr;
+		for (auto& candidate : slots) {
+			if (candidate.state == SlotState::Free) {
+				slot = &candidate;
+				break;
+			}
+		}
+		if (slot == nullptr) {
+			dropped++;
+			return false;
+		}
+
+		ensureCapacity(*slot, static_cast<VkDeviceSize>(extent.width) * extent.height * BYTES_PER_PIXEL);
+
+		VkImageMemoryBarrier toTransfer{};
+		toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		toTransfer.oldLayout = currentLayout;
+		toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.image = image;
+		toTransfer.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0,
+			0,
+			nullptr,
+			0,
+			nullptr,
+			1,
+			&toTransfer);
+
+		VkBufferImageCopy region{};
+		region.bufferOffset = 0;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { extent.width, extent.height, 1 };
+		vkCmdCopyImageToBuffer(
+			commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->buffer, 1, &region);
+
+		// back to where the caller left it; presentation waits on a semaphore, so no later stage needs to wait here
+		if (currentLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+			VkImageMemoryBarrier restore = toTransfer;
+			restore.srcAccessMask = 0;
+			restore.dstAccessMask = 0;
+			restore.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			restore.newLayout = currentLayout;
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0,
+				0,
+				nullptr,
+				0,
+				nullptr,
+				1,
+				&restore);
+		}
+
+		VkBufferMemoryBarrier toHost{};
+		toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.buffer = slot->buffer;
+		toHost.offset = 0;
+		toHost.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_HOST_BIT,
+			0,
+			0,
+			nullptr,
+			1,
+			&toHost,
+			0,
+			nullptr);
+
+		slot->state = SlotState::Recorded;
+		slot->image = { extent.width, extent.height, format, static_cast<const uint8_t*>(slot->mapped) };
+		slot->request = std::move(request);
+		captured++;
+		return true;
+	}
+
+	bool LveReadback::captureSwapChain(VkCommandBuffer commandBuffer, LveRenderer& renderer, Request request) {
+		if (!renderer.supportsSwapChainReadback()) {
+			if (!warnedSwapChainUnsupported) {
+				std::cerr << "readback: surface does not support transfer from swap chain images, captures dropped" << std::endl;
+				warnedSwapChainUnsupported = true;
+			}
+			dropped++;
+			return false;
+		}
+		// headless images end the render pass ready for transfer, windowed ones ready for present
+		VkImageLayout layout = lveDevice.isHeadless()
+			? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+			: VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		return capture(
+			commandBuffer,
+			renderer.getCurrentSwapChainImage(),
+			renderer.getSwapChainImageFormat(),
+			renderer.getSwapChainExtent(),
+			layout,
+			std::move(request));
+	}
+
+	void LveReadback::frameSubmitted(uint64_t timelineValue) {
+		for (auto& slot : slots) {
+			if (slot.state == SlotState::Recorded) {
+				slot.state = SlotState::Copying;
+				slot.timelineValue = timelineValue;
+			}
+		}
+	}
+
+	void LveReadback::encode(Slot& slot) {
+		if (!slot.coherent) {
+			VkMappedMemoryRange range{};
+			range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+			range.memory = slot.memory;
+			range.offset = 0;
+			range.size = VK_WHOLE_SIZE;
+			vkInvalidateMappedMemoryRanges(lveDevice.device(), 1, &range);
+		}
+
+		slot.state = SlotState::Encoding;
+		slot.encoding = encoder.submit([this, image = slot.image, request = std::move(slot.request)]() {
+			auto start = std::chrono::steady_clock::now();
+			// a failed write must not take the frame loop down with it
+			try {
+				if (request.fileFormat == FileFormat::Png) writePng(request.path, image);
+				else if (request.fileFormat == FileFormat::Raw) writeRaw(request.path, image);
+				if (request.onReady) request.onReady(image);
+			}
+			catch (const std::exception& e) {
+				std::cerr << "readback: " << e.what() << std::endl;
+			}
+			auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+			encodeMicroseconds += static_cast<uint64_t>(elapsed.count());
+			encoded++;
+		});
+		slot.request = {};
+	}
+
+	void LveReadback::poll() {
+		for (auto& slot : slots) {
+			if (slot.state == SlotState::Copying && lveDevice.hasReached(slot.timelineValue)) {
+				encode(slot);
+			}
+			if (slot.state == SlotState::Encoding &&
+				slot.encoding.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+				slot.encoding.get();
+				slot.state = SlotState::Free;
+			}
+		}
+	}
+
+	void LveReadback::flush() {
+		for (auto& slot : slots) {
+			assert(slot.state != SlotState::Recorded && "Readback flushed before the capturing frame was submitted");
+			if (slot.state == SlotState::Copying) {
+				lveDevice.waitForTimeline(slot.timelineValue);
+				encode(slot);
+			}
+		}
+		for (auto& slot : slots) {
+			if (slot.state == SlotState::Encoding) {
+				slot.encoding.get();
+				slot.state = SlotState::Free;
+			}
+		}
+	}
+
+	LveReadback::Stats LveReadback::getStats() const {
+		Stats stats{};
+		stats.captured = captured;
+		stats.dropped = dropped;
+		stats.encoded = encoded.load();
+		stats.encodeMs = stats.encoded > 0 ? encodeMicroseconds.load() / 1000.0 / stats.encoded : 0.0;
+		return stats;
+	}
+
+	void LveReadback::writePng(const std::string& path, const LveReadbackImage& image) {
+		// filter byte 0 (none) per row, then RGBA; alpha is forced opaque since swap chains do not keep it meaningful
+		const size_t rowSize = 1 + static_cast<size_t>(image.width) * BYTES_PER_PIXEL;
+		std::vector<uint8_t> scanlines(rowSize * image.height);
+		const bool bgra = isBgra(image.format);
+		for (uint32_t y = 0; y < image.height; y++) {
+			uint8_t* row = scanlines.data() + y * rowSize;
+			const uint8_t* src = image.pixels + static_cast<size_t>(y) * image.width * BYTES_PER_PIXEL;
+			row[0] = 0;
+			for (uint32_t x = 0; x < image.width; x++) {
+				uint8_t* dst = row + 1 + x * BYTES_PER_PIXEL;
+				const uint8_t* pixel = src + x * BYTES_PER_PIXEL;
+				dst[0] = bgra ? pixel[2] : pixel[0];
+				dst[1] = pixel[1];
+				dst[2] = bgra ? pixel[0] : pixel[2];
+				dst[3] = 0xFF;
+			}
+		}
+
+		// zlib stream of stored deflate blocks: no compression, so encoding costs little more than the copy above
+		constexpr size_t MAX_STORED_BLOCK = 65535;
+		std::vector<uint8_t> zlib{};
+		zlib.reserve(scanlines.size() + scanlines.size() / MAX_STORED_BLOCK * 5 + 16);
+		zlib.push_back(0x78);
+		zlib.push_back(0x01);
+		uint32_t adlerA = 1;
+		uint32_t adlerB = 0;
+		size_t offset = 0;
+		do {
+			size_t length = std::min(MAX_STORED_BLOCK, scanlines.size() - offset);
+			bool last = offset + length >= scanlines.size();
+			zlib.push_back(last ? 1 : 0);
+			zlib.push_back(static_cast<uint8_t>(length));
+			zlib.push_back(static_cast<uint8_t>(length >> 8));
+			zlib.push_back(static_cast<uint8_t>(~length));
+			zlib.push_back(static_cast<uint8_t>(~length >> 8));
+			zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+			for (size_t i = offset; i < offset + length; i++) {
+				adlerA = (adlerA + scanlines[i]) % 65521;
+				adlerB = (adlerB + adlerA) % 65521;
+			}
+			offset += length;
+		} while (offset < scanlines.size());
+		appendBigEndian(zlib, (adlerB << 16) | adlerA);
+
+		std::vector<uint8_t> header{};
+		appendBigEndian(header, image.width);
+		appendBigEndian(header, image.height);
+		// 8 bits per channel, color type 6 (RGBA), default compression, filter and no interlace
+		header.insert(header.end(), { 8, 6, 0, 0, 0 });
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open " + path + "!");
+		}
+		static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+		writeChunk(file, "IHDR", header);
+		writeChunk(file, "IDAT", zlib);
+		writeChunk(file, "IEND", {});
+		if (!file) {
+			throw std::runtime_error("failed to write " + path + "!");
+		}
+	}
+
+	void LveReadback::writeRaw(const std::string& path, const LveReadbackImage& image) {
+		// exactly the copied bytes, rows top to bottom in the image's own channel order
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open " + path + "!");
+		}
+		file.write(
+			reinterpret_cast<const char*>(image.pixels),
+			static_cast<std::streamsize>(image.width) * image.height * BYTES_PER_PIXEL);
+		if (!file) {
+			throw std::runtime_error("failed to write " + path + "!");
+		}
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_renderer.hpp"
+#include "lve_thread_pool.hpp"
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace lve {
+	// Pixels copied back from the GPU; rows are tightly packed, 4 bytes per pixel in the image's format.
+	struct LveReadbackImage {
+		uint32_t width;
+		uint32_t height;
+		VkFormat format;
+		const uint8_t* pixels;
+	};
+
+	// Copies images into a ring of host-cached buffers at the end of a frame and hands the pixels to a background
+	// encoder once the frame's timeline value is reached. Nothing waits on the GPU: a capture finds a free slot
+	// or is dropped, and completed copies are only collected by poll().
+	//
+	// Per frame: capture(...) while recording, frameSubmitted(value) after the submit, poll() once per frame.
+	class LveReadback {
+	public:
+		enum class FileFormat { None, Png, Raw };
+
+		struct Request {
+			// written on the encoder thread; FileFormat::None skips the file
+			std::string path{};
+			FileFormat fileFormat = FileFormat::Png;
+			// runs on the encoder thread after the file is written; the pixels are only valid during the call
+			std::function<void(const LveReadbackImage& image)> onReady{};
+		};
+
+		struct Stats {
+			uint64_t captured = 0;
+			// no slot was free because the encoder or the GPU fell behind
+			uint64_t dropped = 0;
+			uint64_t encoded = 0;
+			double encodeMs = 0.0;
+		};
+
+		// ringSize bounds how many captures can be copying or encoding at once
+		LveReadback(LveDevice& device, uint32_t ringSize = 4);
+		~LveReadback();
+
+		LveReadback(const LveReadback&) = delete;
+		LveReadback& operator=(const LveReadback&) = delete;
+
+		// records the copy of a 4-byte-per-pixel color image; the image is returned to currentLayout afterwards.
+		// Must be outside a render pass. Returns false when the capture was dropped.
+		bool capture(
+			VkCommandBuffer commandBuffer,
+			VkImage image,
+			VkFormat format,
+			VkExtent2D extent,
+			VkImageLayout currentLayout,
+			Request request);
+		// the swap chain image being rendered, after endSwapChainRenderPass. Dropped when the surface does not allow
+		// its images to be transfer sources
+		bool captureSwapChain(VkCommandBuffer commandBuffer, LveRenderer& renderer, Request request);
+		// ties the captures recorded since the last call to the timeline value of the submission carrying them
+		void frameSubmitted(uint64_t timelineValue);
+		// hands completed copies to the encoder and recycles slots whose encoding finished
+		void poll();
+		// waits for every capture to be copied and encoded
+		void flush();
+
+		Stats getStats() const;
+
+		static bool isSupportedFormat(VkFormat format);
+		static void writePng(const std::string& path, const LveReadbackImage& image);
+		static void writeRaw(const std::string& path, const LveReadbackImage& image);
+
+	private:
+		enum class SlotState { Free, Recorded, Copying, Encoding };
+
+		struct Slot {
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			void* mapped = nullptr;
+			bool coherent = false;
+
+			SlotState state = SlotState::Free;
+			uint64_t timelineValue = 0;
+			LveReadbackImage image{};
+			Request request{};
+			std::future<void> encoding{};
+		};
+
+		void ensureCapacity(Slot& slot, VkDeviceSize size);
+		void destroyBuffer(Slot& slot);
+		void encode(Slot& slot);
+
+		LveDevice& lveDevice;
+		std::vector<Slot> slots{};
+		// single worker, so frames are encoded and written in capture order
+		LveThreadPool encoder{ 1 };
+
+		uint64_t captured = 0;
+		uint64_t dropped = 0;
+		bool warnedSwapChainUnsupported = false;
+		std::atomic<uint64_t> encoded{ 0 };
+		std::atomic<uint64_t> encodeMicroseconds{ 0 };
+	};
+}
@@ -0,0 +1,938 @@
+#include "lve_render_graph.hpp"
+
+#include "lve_allocation_tracker.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+	// *************** Pass Builder *********************
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::writeColor(
+		LveRenderGraphResource image, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor) {
+		Access access{ image, AccessType::ColorAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, true, loadOp };
+		if (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) access.access |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+		access.clearValue.color = clearColor;
+		graph.addAccess(passIndex, access, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::writeDepth(
+		LveRenderGraphResource image, VkAttachmentLoadOp loadOp, float clearDepth) {
+		Access access{ image, AccessType::DepthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, true, loadOp };
+		access.clearValue.depthStencil = { clearDepth, 0 };
+		graph.addAccess(passIndex, access, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::readDepth(LveRenderGraphResource image) {
+		graph.addAccess(passIndex,
+			{ image, AccessType::DepthRead, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, false },
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::readAttachment(LveRenderGraphResource image) {
+		graph.addAccess(passIndex,
+			{ image, AccessType::InputAttachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT, false },
+			VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::readTexture(
+		LveRenderGraphResource image, VkPipelineStageFlags stages) {
+		graph.addAccess(passIndex,
+			{ image, AccessType::Texture, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, stages, VK_ACCESS_SHADER_READ_BIT, false },
+			VK_IMAGE_USAGE_SAMPLED_BIT);
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::readBuffer(
+		LveRenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+		graph.addAccess(passIndex, { buffer, AccessType::BufferRead, VK_IMAGE_LAYOUT_UNDEFINED, stages, access, false }, 0);
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::writeBuffer(
+		LveRenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+		// buffer writes may be partial, so earlier contents count as read and keep their producers alive
+		graph.addAccess(passIndex, { buffer, AccessType::BufferWrite, VK_IMAGE_LAYOUT_UNDEFINED, stages, access, true }, 0);
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::setSideEffects() {
+		graph.passes[passIndex].sideEffects = true;
+		return *this;
+	}
+
+	LveRenderGraph::PassBuilder& LveRenderGraph::PassBuilder::setExecute(ExecuteFn execute) {
+		graph.passes[passIndex].execute = std::move(execute);
+		return *this;
+	}
+
+	// *************** Render Graph *********************
+
+	LveRenderGraph::~LveRenderGraph() {
+		std::vector<VkFramebuffer> framebuffers{};
+		std::vector<VkRenderPass> renderPasses{};
+		for (auto& group : groups) {
+			for (auto& kv : group.framebuffers) framebuffers.push_back(kv.second);
+			if (group.renderPass != VK_NULL_HANDLE) renderPasses.push_back(group.renderPass);
+		}
+		std::vector<VkImageView> views{};
+		std::vector<VkImage> images{};
+		std::vector<VkBuffer> buffers{};
+		for (auto& resource : resources) {
+			if (resource.imported) continue;
+			if (resource.view != VK_NULL_HANDLE) views.push_back(resource.view);
+			if (resource.image != VK_NULL_HANDLE) images.push_back(resource.image);
+			if (resource.buffer != VK_NULL_HANDLE) buffers.push_back(resource.buffer);
+		}
+		std::vector<VkDeviceMemory> memories{};
+		for (auto& block : blocks) {
+			if (block.memory != VK_NULL_HANDLE) memories.push_back(block.memory);
+		}
+
+		// the last frames executed through the graph may still be in flight
+		lveDevice.deferDestruction([device = lveDevice.device(), framebuffers, renderPasses, views, images, buffers, memories]() {
+			for (auto framebuffer : framebuffers) vkDestroyFramebuffer(device, framebuffer, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto renderPass : renderPasses) vkDestroyRenderPass(device, renderPass, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto view : views) vkDestroyImageView(device, view, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto image : images) vkDestroyImage(device, image, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto buffer : buffers) vkDestroyBuffer(device, buffer, allocationCallbacks(LveMemoryTag::Rendering));
+			for (auto memory : memories) vkFreeMemory(device, memory, allocationCallbacks(LveMemoryTag::Rendering));
+		});
+	}
+
+	bool LveRenderGraph::isAttachment(AccessType type) {
+		return type == AccessType::ColorAttachment || type == AccessType::DepthAttachment ||
+			type == AccessType::DepthRead || type == AccessType::InputAttachment;
+	}
+
+	bool LveRenderGraph::isDepthFormat(VkFormat format) {
+		switch (format) {
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	LveRenderGraphResource LveRenderGraph::addResource(Resource resource) {
+		assert(!compiled && "Cannot add resources to a compiled render graph");
+		resources.push_back(std::move(resource));
+		return static_cast<LveRenderGraphResource>(resources.size() - 1);
+	}
+
+	LveRenderGraphResource LveRenderGraph::createImage(const std::string& name, const ImageDesc& desc) {
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = true;
+		resource.imageDesc = desc;
+		return addResource(std::move(resource));
+	}
+
+	LveRenderGraphResource LveRenderGraph::createBuffer(const std::string& name, const BufferDesc& desc) {
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = false;
+		resource.bufferDesc = desc;
+		return addResource(std::move(resource));
+	}
+
+	LveRenderGraphResource LveRenderGraph::importImage(
+		const std::string& name,
+		VkFormat format,
+		VkExtent2D extent,
+		VkImageLayout initialLayout,
+		VkImageLayout finalLayout,
+		VkPipelineStageFlags waitStage) {
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = true;
+		resource.imported = true;
+		resource.imageDesc = { format, extent };
+		resource.importedInitialLayout = initialLayout;
+		resource.importedFinalLayout = finalLayout;
+		resource.importedWaitStage = waitStage;
+		return addResource(std::move(resource));
+	}
+
+	LveRenderGraphResource LveRenderGraph::importBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size) {
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = false;
+		resource.imported = true;
+		resource.bufferDesc = { size, 0 };
+		resource.buffer = buffer;
+		return addResource(std::move(resource));
+	}
+
+	void LveRenderGraph::setImportedImage(LveRenderGraphResource image, VkImage handle, VkImageView view) {
+		assert(resources[image].imported && resources[image].isImage && "Only imported images can be rebound");
+		assert((resources[image].importedViews.empty() ||
+			std::find(resources[image].importedViews.begin(), resources[image].importedViews.end(), view) != resources[image].importedViews.end()) &&
+			"View is not one of those passed to setImportedViews");
+		resources[image].image = handle;
+		resources[image].view = view;
+	}
+
+	void LveRenderGraph::setImportedViews(LveRenderGraphResource image, const std::vector<VkImageView>& views, VkExtent2D extent) {
+		Resource& resource = resources[image];
+		assert(resource.imported && resource.isImage && "Only imported images can be rebound");
+		bool resized = extent.width != resource.imageDesc.extent.width || extent.height != resource.imageDesc.extent.height;
+		if (!resized && views == resource.importedViews) return;
+		resource.importedViews = views;
+		resource.imageDesc.extent = extent;
+		resource.view = VK_NULL_HANDLE;
+
+		std::vector<VkFramebuffer> framebuffers{};
+		for (auto& group : groups) {
+			if (std::find(group.attachments.begin(), group.attachments.end(), image) == group.attachments.end()) continue;
+			if (resized) {
+				assert(std::all_of(group.attachments.begin(), group.attachments.end(),
+					[&](LveRenderGraphResource attachment) { return resources[attachment].imported; }) &&
+					"Transient attachments are sized at compile, recompile the graph to resize passes using them");
+				group.extent = extent;
+			}
+			for (auto& kv : group.framebuffers) framebuffers.push_back(kv.second);
+			group.framebuffers.clear();
+		}
+		if (framebuffers.empty()) return;
+
+		// frames in flight may still render through them, and their views may already be gone
+		lveDevice.deferDestruction([device = lveDevice.device(), framebuffers]() {
+			for (auto framebuffer : framebuffers) vkDestroyFramebuffer(device, framebuffer, allocationCallbacks(LveMemoryTag::Rendering));
+		});
+	}
+
+	void LveRenderGraph::markOutput(LveRenderGraphResource resource) {
+		assert(!compiled && "Cannot change outputs of a compiled render graph");
+		resources[resource].output = true;
+	}
+
+	LveRenderGraph::PassBuilder LveRenderGraph::addPass(const std::string& name, PassType type) {
+		assert(!compiled && "Cannot add passes to a compiled render graph");
+		assert(passIndices.count(name) == 0 && "Render graph pass already exists");
+		Pass pass{};
+		pass.name = name;
+		pass.type = type;
+		passes.push_back(std::move(pass));
+		uint32_t passIndex = static_cast<uint32_t>(passes.size() - 1);
+		passIndices[name] = passIndex;
+		stats.declaredPasses++;
+		return PassBuilder{ *this, passIndex };
+	}
+
+	void LveRenderGraph::addAccess(uint32_t passIndex, Access access, VkImageUsageFlags usage) {
+		assert(access.resource < resources.size() && "Unknown render graph resource");
+		Resource& resource = resources[access.resource];
+		bool bufferAccess = access.type == AccessType::BufferRead || access.type == AccessType::BufferWrite;
+		assert(resource.isImage != bufferAccess && "Access type does not match the resource kind");
+		assert((!isAttachment(access.type) || passes[passIndex].type == PassType::Graphics) &&
+			"Only graphics passes can use attachments");
+		resource.imageUsage |= usage;
+		passes[passIndex].accesses.push_back(access);
+	}
+
+	VkExtent2D LveRenderGraph::passExtent(const Pass& pass) const {
+		VkExtent2D extent{ 0, 0 };
+		for (auto& access : pass.accesses) {
+			if (!isAttachment(access.type)) continue;
+			VkExtent2D attachmentExtent = resources[access.resource].imageDesc.extent;
+			assert((extent.width == 0 || (extent.width == attachmentExtent.width && extent.height == attachmentExtent.height)) &&
+				"Attachments of one pass must share an extent");
+			extent = attachmentExtent;
+		}
+		if (extent.width == 0) {
+			throw std::runtime_error("render graph pass '" + pass.name + "' has no attachments!");
+		}
+		return extent;
+	}
+
+	bool LveRenderGraph::canMerge(const Group& group, const Pass& pass) const {
+		if (!subpassMerging || !group.graphics || pass.type != PassType::Graphics) return false;
+
+		VkExtent2D extent = passExtent(pass);
+		if (extent.width != group.extent.width || extent.height != group.extent.height) return false;
+
+		// subpass dependencies can only order framebuffer-local accesses; anything sampled or stored outside
+		// the attachments needs a pipeline barrier, which cannot be recorded inside the render pass
+		for (auto& access : pass.accesses) {
+			for (uint32_t groupPass : group.passes) {
+				for (auto& earlier : passes[groupPass].accesses) {
+					if (earlier.resource != access.resource) continue;
+					bool bothLocal = isAttachment(access.type) && isAttachment(earlier.type);
+					if (!bothLocal && (access.write || earlier.write)) return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	const LveRenderGraph::Pass& LveRenderGraph::findPass(const std::string& passName) const {
+		auto it = passIndices.find(passName);
+		if (it == passIndices.end()) {
+			throw std::runtime_error("unknown render graph pass '" + passName + "'!");
+		}
+		return passes[it->second];
+	}
+
+	void LveRenderGraph::compile() {
+		assert(!compiled && "Render graph is already compiled");
+		cullPasses();
+		buildGroups();
+		computeLifetimes();
+		createTransientResources();
+		createRenderPasses();
+		buildBarriers();
+		compiled = true;
+	}
+
+	void LveRenderGraph::cullPasses() {
+		// walk backwards from the outputs: a pass survives if a surviving pass (or an output) reads what it writes
+		std::vector<bool> needed(resources.size(), false);
+		for (size_t i = 0; i < resources.size(); i++) {
+			needed[i] = resources[i].output || (resources[i].imported && resources[i].isImage);
+		}
+
+		for (size_t i = passes.size(); i-- > 0;) {
+			Pass& pass = passes[i];
+			bool keep = pass.sideEffects;
+			for (auto& access : pass.accesses) {
+				if (access.write && needed[access.resource]) keep = true;
+			}
+			pass.culled = !keep;
+			if (!keep) {
+				stats.culledPasses++;
+				continue;
+			}
+
+			// a full overwrite makes earlier contents dead; loads and reads keep their producers
+			for (auto& access : pass.accesses) {
+				if (access.write && access.loadOp != VK_ATTACHMENT_LOAD_OP_LOAD) needed[access.resource] = false;
+			}
+			for (auto& access : pass.accesses) {
+				if (!access.write || access.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) needed[access.resource] = true;
+			}
+		}
+	}
+
+	void LveRenderGraph::buildGroups() {
+		for (uint32_t i = 0; i < passes.size(); i++) {
+			Pass& pass = passes[i];
+			if (pass.culled) continue;
+
+			if (!groups.empty() && canMerge(groups.back(), pass)) {
+				pass.subpass = static_cast<uint32_t>(groups.back().passes.size());
+				groups.back().passes.push_back(i);
+			}
+			else {
+				Group group{};
+				group.graphics = pass.type == PassType::Graphics;
+				if (group.graphics) group.extent = passExtent(pass);
+				group.passes.push_back(i);
+				groups.push_back(std::move(group));
+				pass.subpass = 0;
+			}
+			pass.group = static_cast<int>(groups.size() - 1);
+		}
+	}
+
+	void LveRenderGraph::computeLifetimes() {
+		for (int g = 0; g < static_cast<int>(groups.size()); g++) {
+			for (uint32_t passIndex : groups[g].passes) {
+				for (auto& access : passes[passIndex].accesses) {
+					Resource& resource = resources[access.resource];
+					if (resource.firstGroup < 0) resource.firstGroup = g;
+					resource.lastGroup = g;
+				}
+			}
+		}
+		for (auto& resource : resources) {
+			// outputs are read after the frame, so they stay live to its end
+			if (resource.output && resource.firstGroup >= 0) resource.lastGroup = static_cast<int>(groups.size());
+		}
+	}
+
+	void LveRenderGraph::createTransientResources() {
+		std::vector<LveRenderGraphResource> transients{};
+		for (LveRenderGraphResource i = 0; i < resources.size(); i++) {
+			Resource& resource = resources[i];
+			if (resource.imported || resource.firstGroup < 0) continue;
+
+			if (resource.isImage) {
+				VkImageCreateInfo imageInfo{};
+				imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageInfo.extent.width = resource.imageDesc.extent.width;
+				imageInfo.extent.height = resource.imageDesc.extent.height;
+				imageInfo.extent.depth = 1;
+				imageInfo.mipLevels = 1;
+				imageInfo.arrayLayers = 1;
+				imageInfo.format = resource.imageDesc.format;
+				imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				imageInfo.usage = resource.imageUsage | resource.imageDesc.usage;
+				imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				if (vkCreateImage(lveDevice.device(), &imageInfo, allocationCallbacks(LveMemoryTag::Rendering), &resource.image) != VK_SUCCESS) {
+					throw std::runtime_error("failed to create render graph image!");
+				}
+				vkGetImageMemoryRequirements(lveDevice.device(), resource.image, &resource.requirements);
+			}
+			else {
+				VkBufferCreateInfo bufferInfo{};
+				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				bufferInfo.size = resource.bufferDesc.size;
+				bufferInfo.usage = resource.bufferDesc.usage;
+				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				if (vkCreateBuffer(lveDevice.device(), &bufferInfo, allocationCallbacks(LveMemoryTag::Rendering), &resource.buffer) != VK_SUCCESS) {
+					throw std::runtime_error("failed to create render graph buffer!");
+				}
+				vkGetBufferMemoryRequirements(lveDevice.device(), resource.buffer, &resource.requirements);
+			}
+			stats.transientBytes += resource.requirements.size;
+			transients.push_back(i);
+		}
+
+		// largest first, so every block is sized by its first occupant and later ones always fit at offset 0
+		std::sort(transients.begin(), transients.end(), [this](LveRenderGraphResource a, LveRenderGraphResource b) {
+			return resources[a].requirements.size > resources[b].requirements.size;
+		});
+
+		for (LveRenderGraphResource i : transients) {
+			Resource& resource = resources[i];
+			int chosen = -1;
+			if (memoryAliasing && !resource.output) {
+				for (int b = 0; b < static_cast<int>(blocks.size()) && chosen < 0; b++) {
+					MemoryBlock& block = blocks[b];
+					if (block.exclusive || (block.memoryTypeBits & resource.requirements.memoryTypeBits) == 0) continue;
+					bool overlaps = false;
+					for (LveRenderGraphResource occupant : block.occupants) {
+						const Resource& other = resources[occupant];
+						if (resource.firstGroup <= other.lastGroup && other.firstGroup <= resource.lastGroup) {
+							overlaps = true;
+							break;
+						}
+					}
+					if (!overlaps) chosen = b;
+				}
+			}
+			if (chosen < 0) {
+				blocks.push_back({ resource.requirements.memoryTypeBits, resource.requirements.size, resource.output });
+				chosen = static_cast<int>(blocks.size() - 1);
+			}
+			blocks[chosen].memoryTypeBits &= resource.requirements.memoryTypeBits;
+			blocks[chosen].occupants.push_back(i);
+			resource.block = chosen;
+		}
+
+		for (auto& block : blocks) {
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = block.size;
+			allocInfo.memoryTypeIndex = lveDevice.findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			if (vkAllocateMemory(lveDevice.device(), &allocInfo, allocationCallbacks(LveMemoryTag::Rendering), &block.memory) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate render graph memory!");
+			}
+			stats.allocatedBytes += block.size;
+			stats.memoryBlocks++;
+
+			std::sort(block.occupants.begin(), block.occupants.end(), [this](LveRenderGraphResource a, LveRenderGraphResource b) {
+				return resources[a].firstGroup < resources[b].firstGroup;
+			});
+			for (size_t k = 0; k < block.occupants.size(); k++) {
+				Resource& resource = resources[block.occupants[k]];
+				resource.aliasPredecessor = block.occupants[k == 0 ? block.occupants.size() - 1 : k - 1];
+				if (resource.isImage) {
+					vkBindImageMemory(lveDevice.device(), resource.image, block.memory, 0);
+				}
+				else {
+					vkBindBufferMemory(lveDevice.device(), resource.buffer, block.memory, 0);
+				}
+			}
+		}
+
+		for (LveRenderGraphResource i : transients) {
+			Resource& resource = resources[i];
+			if (!resource.isImage) continue;
+
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = resource.image;
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = resource.imageDesc.format;
+			viewInfo.subresourceRange.aspectMask =
+				isDepthFormat(resource.imageDesc.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+			if (vkCreateImageView(lveDevice.device(), &viewInfo, allocationCallbacks(LveMemoryTag::Rendering), &resource.view) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create render graph image view!");
+			}
+		}
+	}
+
+	void LveRenderGraph::createRenderPasses() {
+		for (int g = 0; g < static_cast<int>(groups.size()); g++) {
+			Group& group = groups[g];
+			if (!group.graphics) continue;
+
+			// attachments in order of first use, with the subpass range each one is used in
+			std::vector<int> firstSubpass{};
+			std::vector<int> lastSubpass{};
+			std::vector<const Access*> firstAccess{};
+			std::vector<const Access*> lastAccess{};
+			auto attachmentIndex = [&group](LveRenderGraphResource resource) {
+				auto it = std::find(group.attachments.begin(), group.attachments.end(), resource);
+				return it == group.attachments.end() ? -1 : static_cast<int>(it - group.attachments.begin());
+			};
+			for (int s = 0; s < static_cast<int>(group.passes.size()); s++) {
+				for (auto& access : passes[group.passes[s]].accesses) {
+					if (!isAttachment(access.type)) continue;
+					int index = attachmentIndex(access.resource);
+					if (index < 0) {
+						group.attachments.push_back(access.resource);
+						firstSubpass.push_back(s);
+						firstAccess.push_back(&access);
+						lastSubpass.push_back(s);
+						lastAccess.push_back(&access);
+					}
+					else {
+						lastSubpass[index] = s;
+						lastAccess[index] = &access;
+					}
+				}
+			}
+
+			std::vector<VkAttachmentDescription> attachments{};
+			for (size_t a = 0; a < group.attachments.size(); a++) {
+				const Resource& resource = resources[group.attachments[a]];
+				const Access& first = *firstAccess[a];
+
+				VkAttachmentLoadOp loadOp = first.write ? first.loadOp : VK_ATTACHMENT_LOAD_OP_LOAD;
+				// nothing earlier in the frame produced a transient's contents, so there is nothing to load
+				if (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD && !resource.imported && resource.firstGroup == g) {
+					loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				}
+				// only store what a later pass or the caller reads; merged G-buffers never leave tile memory
+				bool readLater = resource.imported || resource.lastGroup > g;
+
+				VkAttachmentDescription attachment{};
+				attachment.format = resource.imageDesc.format;
+				attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+				attachment.loadOp = loadOp;
+				attachment.storeOp = readLater ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				// transitions into and out of the render pass are explicit barriers, so the layouts match the first
+				// and last subpass and the render pass itself only transitions between subpasses
+				attachment.initialLayout = first.layout;
+				attachment.finalLayout = lastAccess[a]->layout;
+				attachments.push_back(attachment);
+
+				VkClearValue clearValue = first.clearValue;
+				group.clearValues.push_back(clearValue);
+			}
+
+			std::vector<std::vector<VkAttachmentReference>> colorRefs(group.passes.size());
+			std::vector<std::vector<VkAttachmentReference>> inputRefs(group.passes.size());
+			std::vector<VkAttachmentReference> depthRefs(group.passes.size(), { VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+			std::vector<std::vector<uint32_t>> preserved(group.passes.size());
+			std::vector<VkSubpassDescription> subpasses(group.passes.size());
+			for (int s = 0; s < static_cast<int>(group.passes.size()); s++) {
+				std::vector<bool> referenced(group.attachments.size(), false);
+				for (auto& access : passes[group.passes[s]].accesses) {
+					if (!isAttachment(access.type)) continue;
+					uint32_t index = static_cast<uint32_t>(attachmentIndex(access.resource));
+					assert(!referenced[index] && "A pass cannot use one image as two attachments");
+					referenced[index] = true;
+					switch (access.type) {
+					case AccessType::ColorAttachment:
+						colorRefs[s].push_back({ index, access.layout });
+						break;
+					case AccessType::DepthAttachment:
+					case AccessType::DepthRead:
+						assert(depthRefs[s].attachment == VK_ATTACHMENT_UNUSED && "A pass can only use one depth attachment");
+						depthRefs[s] = { index, access.layout };
+						break;
+					case AccessType::InputAttachment:
+						inputRefs[s].push_back({ index, access.layout });
+						break;
+					default:
+						break;
+					}
+				}
+				for (uint32_t a = 0; a < group.attachments.size(); a++) {
+					if (!referenced[a] && firstSubpass[a] < s && s < lastSubpass[a]) preserved[s].push_back(a);
+				}
+
+				VkSubpassDescription& subpass = subpasses[s];
+				subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+				subpass.colorAttachmentCount = static_cast<uint32_t>(colorRefs[s].size());
+				subpass.pColorAttachments = colorRefs[s].data();
+				subpass.inputAttachmentCount = static_cast<uint32_t>(inputRefs[s].size());
+				subpass.pInputAttachments = inputRefs[s].data();
+				subpass.pDepthStencilAttachment = depthRefs[s].attachment == VK_ATTACHMENT_UNUSED ? nullptr : &depthRefs[s];
+				subpass.preserveAttachmentCount = static_cast<uint32_t>(preserved[s].size());
+				subpass.pPreserveAttachments = preserved[s].data();
+			}
+
+			// order every attachment hazard between subpasses; all of them are framebuffer-local
+			std::map<std::pair<uint32_t, uint32_t>, VkSubpassDependency> dependencies{};
+			auto addDependency = [&dependencies](uint32_t src, uint32_t dst,
+				VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+				auto& dependency = dependencies[{ src, dst }];
+				dependency.srcSubpass = src;
+				dependency.dstSubpass = dst;
+				dependency.srcStageMask |= srcStages;
+				dependency.srcAccessMask |= srcAccess;
+				dependency.dstStageMask |= dstStages;
+				dependency.dstAccessMask |= dstAccess;
+				dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+			};
+			for (auto attachment : group.attachments) {
+				int writer = -1;
+				const Access* writeAccess = nullptr;
+				std::vector<std::pair<int, const Access*>> readers{};
+				for (int s = 0; s < static_cast<int>(group.passes.size()); s++) {
+					for (auto& access : passes[group.passes[s]].accesses) {
+						if (access.resource != attachment) continue;
+						if (writer >= 0 && writer != s) {
+							addDependency(writer, s, writeAccess->stages, writeAccess->access, access.stages, access.access);
+						}
+						if (access.write) {
+							for (auto& reader : readers) {
+								if (reader.first != s) addDependency(reader.first, s, reader.second->stages, 0, access.stages, access.access);
+							}
+							readers.clear();
+							writer = s;
+							writeAccess = &access;
+						}
+						else {
+							readers.push_back({ s, &access });
+						}
+					}
+				}
+			}
+			std::vector<VkSubpassDependency> dependencyList{};
+			for (auto& kv : dependencies) dependencyList.push_back(kv.second);
+
+			VkRenderPassCreateInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+			renderPassInfo.pAttachments = attachments.data();
+			renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+			renderPassInfo.pSubpasses = subpasses.data();
+			renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencyList.size());
+			renderPassInfo.pDependencies = dependencyList.data();
+
+			if (vkCreateRenderPass(lveDevice.device(), &renderPassInfo, allocationCallbacks(LveMemoryTag::Rendering), &group.renderPass) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create render graph render pass!");
+			}
+			stats.renderPasses++;
+			stats.subpasses += static_cast<uint32_t>(subpasses.size());
+			stats.subpassDependencies += static_cast<uint32_t>(dependencyList.size());
+		}
+	}
+
+	std::vector<LveRenderGraph::ResourceState> LveRenderGraph::simulateBarriers(std::vector<ResourceState> states, bool record) {
+		for (auto& group : groups) {
+			// accesses of one resource within a group are ordered by subpass dependencies (or are all reads),
+			// so a single barrier before the group covers the union of them
+			struct Combined {
+				VkImageLayout firstLayout;
+				VkImageLayout lastLayout;
+				VkPipelineStageFlags stages = 0;
+				VkAccessFlags access = 0;
+				bool write = false;
+				VkPipelineStageFlags writeStages = 0;
+				VkAccessFlags writeAccess = 0;
+				VkPipelineStageFlags readStagesAfterWrite = 0;
+			};
+			std::vector<LveRenderGraphResource> order{};
+			std::map<LveRenderGraphResource, Combined> combined{};
+			for (uint32_t passIndex : group.passes) {
+				for (auto& access : passes[passIndex].accesses) {
+					auto it = combined.find(access.resource);
+					if (it == combined.end()) {
+						order.push_back(access.resource);
+						it = combined.emplace(access.resource, Combined{ access.layout, access.layout }).first;
+					}
+					Combined& c = it->second;
+					c.lastLayout = access.layout;
+					c.stages |= access.stages;
+					c.access |= access.access;
+					if (access.write) {
+						c.write = true;
+						c.writeStages |= access.stages;
+						c.writeAccess |= access.access;
+						c.readStagesAfterWrite = 0;
+					}
+					else {
+						c.readStagesAfterWrite |= access.stages;
+					}
+				}
+			}
+
+			for (auto resourceIndex : order) {
+				const Combined& c = combined[resourceIndex];
+				ResourceState& state = states[resourceIndex];
+				bool layoutChange = resources[resourceIndex].isImage && c.firstLayout != state.layout;
+
+				bool needsBarrier;
+				VkPipelineStageFlags srcStages;
+				if (layoutChange || c.write) {
+					// write-after-read only needs execution order; layout changes and write-after-write need both
+					srcStages = state.writeStages | state.readStages;
+					needsBarrier = layoutChange || srcStages != 0;
+				}
+				else {
+					// read-after-read never needs a barrier; read-after-write only for stages not yet made visible
+					srcStages = state.writeStages;
+					needsBarrier = state.writeStages != 0 && (c.stages & ~state.readStages) != 0;
+				}
+				if (needsBarrier && record) {
+					group.barriers.push_back({
+						resourceIndex,
+						state.layout,
+						c.firstLayout,
+						srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+						c.stages,
+						state.writeAccess,
+						c.access });
+				}
+
+				state.layout = c.lastLayout;
+				if (c.write) {
+					state.writeStages = c.writeStages;
+					state.writeAccess = c.writeAccess;
+					state.readStages = c.readStagesAfterWrite;
+				}
+				else {
+					state.readStages |= c.stages;
+				}
+			}
+		}
+
+		for (LveRenderGraphResource i = 0; i < resources.size(); i++) {
+			const Resource& resource = resources[i];
+			ResourceState& state = states[i];
+			if (!resource.imported || !resource.isImage || state.layout == resource.importedFinalLayout) continue;
+			if (record) {
+				VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+				finalBarriers.push_back({
+					i,
+					state.layout,
+					resource.importedFinalLayout,
+					srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+					VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+					state.writeAccess,
+					0 });
+			}
+			state.layout = resource.importedFinalLayout;
+		}
+		return states;
+	}
+
+	void LveRenderGraph::buildBarriers() {
+		std::vector<ResourceState> initial(resources.size());
+		for (LveRenderGraphResource i = 0; i < resources.size(); i++) {
+			if (resources[i].imported && resources[i].isImage) {
+				initial[i].layout = resources[i].importedInitialLayout;
+				initial[i].writeStages = resources[i].importedWaitStage;
+			}
+		}
+
+		// transients start undefined every frame, but the previous frame (or the previous occupant of the same
+		// memory) may still be using them: seed each with where its predecessor ends, then record for real
+		std::vector<ResourceState> endOfFrame = simulateBarriers(initial, false);
+		for (LveRenderGraphResource i = 0; i < resources.size(); i++) {
+			const Resource& resource = resources[i];
+			if (resource.imported && resource.isImage) continue;
+			const ResourceState& previous = endOfFrame[resource.imported ? i : resource.aliasPredecessor];
+			initial[i].layout = resource.imported ? previous.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+			initial[i].writeStages = previous.writeStages | previous.readStages;
+			initial[i].writeAccess = previous.writeAccess;
+			initial[i].readStages = 0;
+		}
+		simulateBarriers(initial, true);
+
+		for (auto& group : groups) {
+			if (!group.barriers.empty()) stats.barrierBatches++;
+			for (auto& barrier : group.barriers) {
+				if (resources[barrier.resource].isImage) stats.imageBarriers++;
+				else stats.bufferBarriers++;
+			}
+		}
+		if (!finalBarriers.empty()) stats.barrierBatches++;
+		stats.imageBarriers += static_cast<uint32_t>(finalBarriers.size());
+	}
+
+	VkFramebuffer LveRenderGraph::getFramebuffer(Group& group) {
+		std::vector<VkImageView> views{};
+		views.reserve(group.attachments.size());
+		for (auto attachment : group.attachments) {
+			assert(resources[attachment].view != VK_NULL_HANDLE && "Imported image was not bound with setImportedImage");
+			views.push_back(resources[attachment].view);
+		}
+
+		auto it = group.framebuffers.find(views);
+		if (it != group.framebuffers.end()) return it->second;
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = group.renderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+		framebufferInfo.pAttachments = views.data();
+		framebufferInfo.width = group.extent.width;
+		framebufferInfo.height = group.extent.height;
+		framebufferInfo.layers = 1;
+
+		VkFramebuffer framebuffer;
+		if (vkCreateFramebuffer(lveDevice.device(), &framebufferInfo, allocationCallbacks(LveMemoryTag::Rendering), &framebuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create render graph framebuffer!");
+		}
+		group.framebuffers.emplace(std::move(views), framebuffer);
+		return framebuffer;
+	}
+
+	void LveRenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier>& barriers) const {
+		if (barriers.empty()) return;
+
+		std::vector<VkImageMemoryBarrier> imageBarriers{};
+		std::vector<VkBufferMemoryBarrier> bufferBarriers{};
+		VkPipelineStageFlags srcStages = 0;
+		VkPipelineStageFlags dstStages = 0;
+		for (auto& barrier : barriers) {
+			const Resource& resource = resources[barrier.resource];
+			srcStages |= barrier.srcStages;
+			dstStages |= barrier.dstStages;
+			if (resource.isImage) {
+				VkImageMemoryBarrier imageBarrier{};
+				imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageBarrier.srcAccessMask = barrier.srcAccess;
+				imageBarrier.dstAccessMask = barrier.dstAccess;
+				imageBarrier.oldLayout = barrier.oldLayout;
+				imageBarrier.newLayout = barrier.newLayout;
+				imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.image = resource.image;
+				imageBarrier.subresourceRange.aspectMask =
+					isDepthFormat(resource.imageDesc.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+				imageBarrier.subresourceRange.baseMipLevel = 0;
+				imageBarrier.subresourceRange.levelCount = 1;
+				imageBarrier.subresourceRange.baseArrayLayer = 0;
+				imageBarrier.subresourceRange.layerCount = 1;
+				imageBarriers.push_back(imageBarrier);
+			}
+			else {
+				VkBufferMemoryBarrier bufferBarrier{};
+				bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				bufferBarrier.srcAccessMask = barrier.srcAccess;
+				bufferBarrier.dstAccessMask = barrier.dstAccess;
+				bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.buffer = resource.buffer;
+				bufferBarrier.offset = 0;
+				bufferBarrier.size = VK_WHOLE_SIZE;
+				bufferBarriers.push_back(bufferBarrier);
+			}
+		}
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			srcStages,
+			dstStages,
+			0,
+			0,
+			nullptr,
+			static_cast<uint32_t>(bufferBarriers.size()),
+			bufferBarriers.data(),
+			static_cast<uint32_t>(imageBarriers.size()),
+			imageBarriers.data());
+	}
+
+	void LveRenderGraph::execute(VkCommandBuffer commandBuffer) {
+		assert(compiled && "Render graph must be compiled before it is executed");
+
+		for (auto& group : groups) {
+			recordBarriers(commandBuffer, group.barriers);
+
+			if (!group.graphics) {
+				const Pass& pass = passes[group.passes.front()];
+				if (pass.execute) pass.execute(commandBuffer);
+				continue;
+			}
+
+			VkRenderPassBeginInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = group.renderPass;
+			renderPassInfo.framebuffer = getFramebuffer(group);
+			renderPassInfo.renderArea.offset = { 0, 0 };
+			renderPassInfo.renderArea.extent = group.extent;
+			renderPassInfo.clearValueCount = static_cast<uint32_t>(group.clearValues.size());
+			renderPassInfo.pClearValues = group.clearValues.data();
+			vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			VkViewport viewport{};
+			viewport.x = 0.0f;
+			viewport.y = 0.0f;
+			viewport.width = static_cast<float>(group.extent.width);
+			viewport.height = static_cast<float>(group.extent.height);
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+			VkRect2D scissor{ {0, 0}, group.extent };
+
+			for (size_t s = 0; s < group.passes.size(); s++) {
+				if (s > 0) vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+				vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+				vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+				const Pass& pass = passes[group.passes[s]];
+				if (pass.execute) pass.execute(commandBuffer);
+			}
+
+			vkCmdEndRenderPass(commandBuffer);
+		}
+
+		recordBarriers(commandBuffer, finalBarriers);
+	}
+
+	bool LveRenderGraph::isCulled(const std::string& passName) const {
+		return findPass(passName).culled;
+	}
+
+	VkRenderPass LveRenderGraph::getRenderPass(const std::string& passName) const {
+		assert(compiled && "Render graph must be compiled before its render passes exist");
+		const Pass& pass = findPass(passName);
+		return pass.culled ? VK_NULL_HANDLE : groups[pass.group].renderPass;
+	}
+
+	uint32_t LveRenderGraph::getSubpass(const std::string& passName) const {
+		return findPass(passName).subpass;
+	}
+
+	VkImageView LveRenderGraph::getImageView(LveRenderGraphResource image) const {
+		return resources[image].view;
+	}
+
+	VkBuffer LveRenderGraph::getBuffer(LveRenderGraphResource buffer) const {
+		return resources[buffer].buffer;
+	}
+}
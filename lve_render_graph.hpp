@@ -0,0 +1,252 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+	using LveRenderGraphResource = uint32_t;
+
+	// Frame described as passes that declare reads and writes of named images and buffers. compile() then
+	//  - culls passes whose results never reach an output or a side-effecting pass,
+	//  - merges consecutive graphics passes that only exchange attachments into subpasses of one VkRenderPass,
+	//  - places transient resources with disjoint lifetimes in the same memory,
+	//  - derives every pipeline barrier and layout transition, batched into one vkCmdPipelineBarrier per pass.
+	// Passes must be added in execution order; the graph is compiled once and executed every frame.
+	class LveRenderGraph {
+	public:
+		enum class PassType { Graphics, Compute };
+		using ExecuteFn = std::function<void(VkCommandBuffer commandBuffer)>;
+
+		struct ImageDesc {
+			VkFormat format;
+			VkExtent2D extent;
+			// added to the usage implied by the declared accesses, e.g. TRANSFER_SRC for readback
+			VkImageUsageFlags usage = 0;
+		};
+
+		struct BufferDesc {
+			VkDeviceSize size;
+			VkBufferUsageFlags usage;
+		};
+
+		struct Stats {
+			uint32_t declaredPasses = 0;
+			uint32_t culledPasses = 0;
+			uint32_t renderPasses = 0;
+			uint32_t subpasses = 0;
+			uint32_t subpassDependencies = 0;
+			// per executed frame
+			uint32_t imageBarriers = 0;
+			uint32_t bufferBarriers = 0;
+			uint32_t barrierBatches = 0;
+			// transient memory with every resource in its own allocation, and as actually allocated
+			VkDeviceSize transientBytes = 0;
+			VkDeviceSize allocatedBytes = 0;
+			uint32_t memoryBlocks = 0;
+			VkDeviceSize memorySaved() const { return transientBytes - allocatedBytes; }
+		};
+
+		class PassBuilder {
+		public:
+			PassBuilder& writeColor(
+				LveRenderGraphResource image,
+				VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				VkClearColorValue clearColor = {});
+			PassBuilder& writeDepth(
+				LveRenderGraphResource image,
+				VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				float clearDepth = 1.0f);
+			// depth test against an earlier pass's depth without writing it
+			PassBuilder& readDepth(LveRenderGraphResource image);
+			// input attachment: free when merged with the writer, otherwise a load in a new render pass
+			PassBuilder& readAttachment(LveRenderGraphResource image);
+			PassBuilder& readTexture(
+				LveRenderGraphResource image, VkPipelineStageFlags stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+			PassBuilder& readBuffer(
+				LveRenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access = VK_ACCESS_SHADER_READ_BIT);
+			PassBuilder& writeBuffer(
+				LveRenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access = VK_ACCESS_SHADER_WRITE_BIT);
+			// keeps the pass even if nothing it writes is read, e.g. readback or debug capture
+			PassBuilder& setSideEffects();
+			PassBuilder& setExecute(ExecuteFn execute);
+
+		private:
+			friend class LveRenderGraph;
+			PassBuilder(LveRenderGraph& graph, uint32_t passIndex) : graph{ graph }, passIndex{ passIndex } {}
+
+			LveRenderGraph& graph;
+			uint32_t passIndex;
+		};
+
+		LveRenderGraph(LveDevice& lveDevice) : lveDevice{ lveDevice } {}
+		~LveRenderGraph();
+
+		LveRenderGraph(const LveRenderGraph&) = delete;
+		LveRenderGraph& operator=(const LveRenderGraph&) = delete;
+
+		LveRenderGraphResource createImage(const std::string& name, const ImageDesc& desc);
+		LveRenderGraphResource createBuffer(const std::string& name, const BufferDesc& desc);
+		// waitStage must cover the stage a semaphore guarding the image waits at (color output for swap chains)
+		LveRenderGraphResource importImage(
+			const std::string& name,
+			VkFormat format,
+			VkExtent2D extent,
+			VkImageLayout initialLayout,
+			VkImageLayout finalLayout,
+			VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		LveRenderGraphResource importBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size);
+		// imported images may change every frame, e.g. the acquired swap chain image
+		void setImportedImage(LveRenderGraphResource image, VkImage handle, VkImageView view);
+		// the views an imported image cycles through, e.g. those of a recreated swap chain; a different set or extent
+		// releases the framebuffers built on the old views. Passes that attach the image follow its new extent
+		void setImportedViews(LveRenderGraphResource image, const std::vector<VkImageView>& views, VkExtent2D extent);
+		// outputs survive the frame and are never aliased
+		void markOutput(LveRenderGraphResource resource);
+
+		PassBuilder addPass(const std::string& name, PassType type = PassType::Graphics);
+
+		// both default to on; switching them off gives the unoptimized baseline for comparisons
+		void setSubpassMerging(bool enabled) { subpassMerging = enabled; }
+		void setMemoryAliasing(bool enabled) { memoryAliasing = enabled; }
+
+		void compile();
+		void execute(VkCommandBuffer commandBuffer);
+
+		bool isCulled(const std::string& passName) const;
+		// for pipeline creation after compile(); culled passes have no render pass
+		VkRenderPass getRenderPass(const std::string& passName) const;
+		uint32_t getSubpass(const std::string& passName) const;
+		VkImageView getImageView(LveRenderGraphResource image) const;
+		VkBuffer getBuffer(LveRenderGraphResource buffer) const;
+		const Stats& getStats() const { return stats; }
+
+	private:
+		enum class AccessType { ColorAttachment, DepthAttachment, DepthRead, InputAttachment, Texture, BufferRead, BufferWrite };
+
+		struct Access {
+			LveRenderGraphResource resource;
+			AccessType type;
+			VkImageLayout layout;
+			VkPipelineStageFlags stages;
+			VkAccessFlags access;
+			bool write;
+			VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			VkClearValue clearValue{};
+		};
+
+		struct Resource {
+			std::string name;
+			bool isImage;
+			bool imported = false;
+			bool output = false;
+			ImageDesc imageDesc{};
+			BufferDesc bufferDesc{};
+			VkImageUsageFlags imageUsage = 0;
+			VkImageLayout importedInitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImageLayout importedFinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags importedWaitStage = 0;
+			std::vector<VkImageView> importedViews{};
+
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkMemoryRequirements requirements{};
+
+			// group range the resource is live in; memory blocks are only shared across disjoint ranges
+			int firstGroup = -1;
+			int lastGroup = -1;
+			int block = -1;
+			// previous occupant of the memory block, wrapping around to the last one of the previous frame
+			LveRenderGraphResource aliasPredecessor = 0;
+		};
+
+		struct Pass {
+			std::string name;
+			PassType type;
+			std::vector<Access> accesses{};
+			ExecuteFn execute{};
+			bool sideEffects = false;
+			bool culled = false;
+			int group = -1;
+			uint32_t subpass = 0;
+		};
+
+		struct Barrier {
+			LveRenderGraphResource resource;
+			VkImageLayout oldLayout;
+			VkImageLayout newLayout;
+			VkPipelineStageFlags srcStages;
+			VkPipelineStageFlags dstStages;
+			VkAccessFlags srcAccess;
+			VkAccessFlags dstAccess;
+		};
+
+		// a render pass (graphics, one subpass per merged pass) or a single compute pass
+		struct Group {
+			std::vector<uint32_t> passes{};
+			bool graphics;
+			VkExtent2D extent{};
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			std::vector<LveRenderGraphResource> attachments{};
+			std::vector<VkClearValue> clearValues{};
+			std::vector<Barrier> barriers{};
+			std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers{};
+		};
+
+		struct MemoryBlock {
+			uint32_t memoryTypeBits;
+			VkDeviceSize size;
+			bool exclusive;
+			std::vector<LveRenderGraphResource> occupants{};
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+		};
+
+		struct ResourceState {
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags writeStages = 0;
+			VkAccessFlags writeAccess = 0;
+			// stages that have already seen the last write
+			VkPipelineStageFlags readStages = 0;
+		};
+
+		static bool isAttachment(AccessType type);
+		static bool isDepthFormat(VkFormat format);
+
+		LveRenderGraphResource addResource(Resource resource);
+		void addAccess(uint32_t passIndex, Access access, VkImageUsageFlags usage);
+		VkExtent2D passExtent(const Pass& pass) const;
+		bool canMerge(const Group& group, const Pass& pass) const;
+		const Pass& findPass(const std::string& passName) const;
+
+		void cullPasses();
+		void buildGroups();
+		void computeLifetimes();
+		void createTransientResources();
+		void createRenderPasses();
+		std::vector<ResourceState> simulateBarriers(std::vector<ResourceState> states, bool record);
+		void buildBarriers();
+
+		VkFramebuffer getFramebuffer(Group& group);
+		void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier>& barriers) const;
+
+		LveDevice& lveDevice;
+		bool subpassMerging = true;
+		bool memoryAliasing = true;
+		bool compiled = false;
+
+		std::vector<Resource> resources{};
+		std::vector<Pass> passes{};
+		std::unordered_map<std::string, uint32_t> passIndices{};
+		std::vector<Group> groups{};
+		std::vector<MemoryBlock> blocks{};
+		std::vector<Barrier> finalBarriers{};
+		Stats stats{};
+	};
+}
@@ -1,12 +1,23 @@
 #pragma once
 
 #include "lve_renderer.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_profiler.hpp"
 
 #include <stdexcept>
 #include <array>
+#include <cassert>
 
 namespace lve {
-	LveRenderer::LveRenderer(LveWindow& window, LveDevice& device) : lveWindow(window), lveDevice(device) {
+	LveRenderer::LveRenderer(LveWindow& window, LveDevice& device, const LveRendererConfig& config)
+		: lveWindow(&window), lveDevice(device), config(config) {
+		recreateSwapChain();
+		createCommandBuffers();
+	}
+	LveRenderer::LveRenderer(LveDevice& device, VkExtent2D extent, const LveRendererConfig& config)
+		: lveWindow(nullptr), lveDevice(device), config(config), headlessExtent(extent) {
+		assert(device.isHeadless() && "Windowless renderer requires a headless device");
+		assert(extent.width > 0 && extent.height > 0 && "Headless extent must not be empty");
 		recreateSwapChain();
 		createCommandBuffers();
 	}
@@ -15,30 +26,88 @@ namespace lve {
 	}
 
 	void LveRenderer::recreateSwapChain() {
-		auto extent = lveWindow.getExtent();
+		auto extent = lveWindow != nullptr ? lveWindow->getExtent() : headlessExtent;
 		while (extent.width == 0 || extent.height == 0) {
-			extent = lveWindow.getExtent();
+			extent = lveWindow->getExtent();
 			glfwWaitEvents();
 		}
 
-		vkDeviceWaitIdle(lveDevice.device());
-
-		// if we already had a swap chain, get rid of all the old resources
+		// no device idle: the old swap chain goes to the deletion queue and is freed once the GPU is past its frames
 		if (lveSwapChain == nullptr) {
-			lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent);
+			lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent, config);
 		}
 		else {
 			std::shared_ptr<LveSwapChain> oldSwapChain = std::move(lveSwapChain);
-			lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent, oldSwapChain);
+			lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent, config, oldSwapChain);
 
 			if (!oldSwapChain->compareSwapFormats(*lveSwapChain.get())) {
 				throw std::runtime_error("Swap chain image(or depth) format has changed");
 			}
+			// released after the next frame's submission, which is queued behind the old swap chain's last present, so
+			// its completion also covers the present consuming the old semaphores (timelines cannot observe presents)
+			lveDevice.deferDestructionAfterNextFrame([oldSwapChain]() mutable { oldSwapChain.reset(); });
+		}
+	}
+
+	void LveRenderer::setConfig(const LveRendererConfig& newConfig) {
+		assert(!isFrameStarted && "Cannot change renderer config while frame is in progress");
+		bool swapChainChanged = newConfig.framesInFlight != config.framesInFlight ||
+			newConfig.presentMode != config.presentMode ||
+			newConfig.swapChainImageCount != config.swapChainImageCount;
+		config = newConfig;
+		latencyTracker.reset();
+		if (swapChainChanged) {
+			recreateSwapChain();
+		}
+	}
+
+	void LveRenderer::beginInputSampling() {
+		assert(!isFrameStarted && "Cannot sample input while frame is in progress");
+		if (config.lowLatency) {
+			// drain the queue now rather than in acquire, so the input read next is as fresh as possible
+			lveDevice.waitForTimeline(lveSwapChain->getLastSubmittedTimelineValue());
 		}
+		latencyTracker.collect(lveDevice);
+		latencyTracker.markInputSampled();
+	}
+
+	void LveRenderer::addFrameWait(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags stages) {
+		assert(isFrameStarted && "Cannot add a frame wait while frame is not in progress");
+		lveSwapChain->addSubmitWait(semaphore, value, stages);
+	}
+
+	LveLatencyTracker::Stats LveRenderer::getLatencyStats() const {
+		return latencyTracker.getStats();
+	}
+
+	VkFormat LveRenderer::getSwapChainImageFormat() const {
+		return lveSwapChain->getSwapChainImageFormat();
+	}
+
+	VkFormat LveRenderer::getSwapChainDepthFormat() const {
+		return lveSwapChain->findDepthFormat();
+	}
+
+	VkExtent2D LveRenderer::getSwapChainExtent() const {
+		return lveSwapChain->getSwapChainExtent();
+	}
+
+	VkImage LveRenderer::getCurrentSwapChainImage() const {
+		assert(isFrameStarted && "Cannot get swap chain image when frame not in progress");
+		return lveSwapChain->getImage(static_cast<int>(currentImageIndex));
+	}
+
+	bool LveRenderer::supportsSwapChainReadback() const {
+		return lveSwapChain->supportsReadback();
+	}
+
+	uint64_t LveRenderer::getLastSubmittedTimelineValue() const {
+		return lveSwapChain->getLastSubmittedTimelineValue();
 	}
 
 	void LveRenderer::createCommandBuffers() {
-		commandBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+		// sized for the largest config so switching frames in flight never reallocates
+		commandBuffers.resize(LveRendererConfig::MAX_FRAMES_IN_FLIGHT);
 
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -58,6 +127,8 @@ namespace lve {
 
 	VkCommandBuffer LveRenderer::beginFrame() {
 		assert(!isFrameStarted && "Cannot call beginFrame while in progress");
+		LVE_PROFILE_ZONE("LveRenderer::beginFrame");
+		LVE_MEMORY_SCOPE(LveMemoryTag::Rendering);
 
 		auto result = lveSwapChain->acquireNextImage(&currentImageIndex);
 
@@ -71,6 +142,11 @@ namespace lve {
 		}
 
 		isFrameStarted = true;
+		currentFrameIndex = static_cast<int>(lveSwapChain->getCurrentFrame());
+		latencyTracker.collect(lveDevice);
+		lveDevice.flushDeletionQueue();
+		// from here until endFrame, deferred destructions wait for this frame's timeline value
+		lveDevice.beginFrameSubmission();
 
 		auto commandBuffer = getCurrentCommandBuffer();	
 
@@ -88,6 +164,8 @@ namespace lve {
 
 	void LveRenderer::endFrame() {
 		assert(isFrameStarted && "Cannot call endFrame while frame is not in progress");
+		LVE_PROFILE_ZONE("LveRenderer::endFrame");
+		LVE_MEMORY_SCOPE(LveMemoryTag::Rendering);
 
 		auto commandBuffer = getCurrentCommandBuffer();
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
@@ -95,17 +173,17 @@ namespace lve {
 		}
 
 		auto result = lveSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
+		lveDevice.endFrameSubmission(lveSwapChain->getLastSubmittedTimelineValue());
+		latencyTracker.frameSubmitted(lveSwapChain->getLastSubmittedTimelineValue());
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || lveWindow.wasWindowResized()) {
-			lveWindow.resetWindowResizedFlag();
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || (lveWindow != nullptr && lveWindow->wasWindowResized())) {
+			if (lveWindow != nullptr) lveWindow->resetWindowResizedFlag();
 			recreateSwapChain();
 		} else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
 			throw std::runtime_error("failed to acquire swap chain image!");
 		}
 
 		isFrameStarted = false;
-
-		currentFrameIndex = (currentFrameIndex + 1) % LveSwapChain::MAX_FRAMES_IN_FLIGHT;
 	}
 
 	void LveRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
@@ -0,0 +1,56 @@
+#include "lve_renderer_config.hpp"
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace lve {
+	LveRendererConfig LveRendererConfig::fromEnvironment() {
+		LveRendererConfig config{};
+
+		if (const char* value = std::getenv("LVE_FRAMES_IN_FLIGHT")) {
+			long frames = std::strtol(value, nullptr, 10);
+			config.framesInFlight = static_cast<uint32_t>(std::clamp<long>(frames, MIN_FRAMES_IN_FLIGHT, MAX_FRAMES_IN_FLIGHT));
+		}
+
+		if (const char* value = std::getenv("LVE_PRESENT_MODE")) {
+			if (std::strcmp(value, "fifo") == 0) config.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+			else if (std::strcmp(value, "fifo_relaxed") == 0) config.presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+			else if (std::strcmp(value, "mailbox") == 0) config.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+			else if (std::strcmp(value, "immediate") == 0) config.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			else std::cerr << "Ignoring unknown LVE_PRESENT_MODE '" << value << "'" << std::endl;
+		}
+
+		if (const char* value = std::getenv("LVE_SWAPCHAIN_IMAGES")) {
+			config.swapChainImageCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		}
+
+		if (const char* value = std::getenv("LVE_LOW_LATENCY")) {
+			config.lowLatency = std::strcmp(value, "0") != 0;
+		}
+
+		return config;
+	}
+
+	const char* LveRendererConfig::presentModeName(VkPresentModeKHR presentMode) {
+		switch (presentMode) {
+		case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+		case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO relaxed";
+		case VK_PRESENT_MODE_MAILBOX_KHR: return "Mailbox";
+		case VK_PRESENT_MODE_IMMEDIATE_KHR: return "Immediate";
+		default: return "Unknown";
+		}
+	}
+
+	std::string LveRendererConfig::describe() const {
+		std::ostringstream description;
+		description << presentModeName(presentMode) << ", " << framesInFlight << " frames in flight, ";
+		if (swapChainImageCount == 0) description << "default image count";
+		else description << swapChainImageCount << " images";
+		description << ", low latency " << (lowLatency ? "on" : "off");
+		return description.str();
+	}
+}
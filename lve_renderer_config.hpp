@@ -0,0 +1,32 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+
+namespace lve {
+	// Presentation and pacing settings that trade throughput against latency. Applied at swap chain
+	// (re)creation, so LveRenderer::setConfig can switch them at runtime.
+	struct LveRendererConfig {
+		static constexpr uint32_t MIN_FRAMES_IN_FLIGHT = 1;
+		// upper bound for per-frame resources (command buffers, UBOs, descriptor pools) sized once at startup
+		static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+		uint32_t framesInFlight = 2;
+		// falls back to FIFO, which every device supports, when the surface does not offer this mode
+		VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+		// 0 requests minImageCount + 1; other values are clamped to the surface limits
+		uint32_t swapChainImageCount = 0;
+		// wait for the previous frame to finish before sampling input instead of inside acquire
+		bool lowLatency = false;
+
+		// reads LVE_FRAMES_IN_FLIGHT, LVE_PRESENT_MODE (fifo, fifo_relaxed, mailbox, immediate),
+		// LVE_SWAPCHAIN_IMAGES and LVE_LOW_LATENCY on top of the defaults
+		static LveRendererConfig fromEnvironment();
+
+		static const char* presentModeName(VkPresentModeKHR presentMode);
+		std::string describe() const;
+	};
+}
@@ -0,0 +1,37 @@
+#include "lve_shader_module.hpp"
+
+#include "lve_allocation_tracker.hpp"
+
+// std
+#include <atomic>
+#include <stdexcept>
+#include <string_view>
+
+namespace lve {
+	namespace {
+		uint64_t nextId() {
+			static std::atomic<uint64_t> counter{ 0 };
+			return ++counter;
+		}
+	}
+
+	LveShaderModule::LveShaderModule(LveDevice& device, const std::vector<char>& code)
+		: lveDevice{ device }, id{ nextId() }, code{ code } {
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = code.size();
+		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+		if (vkCreateShaderModule(lveDevice.device(), &createInfo, allocationCallbacks(LveMemoryTag::Pipelines), &shaderModule) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create shader module!");
+		}
+	}
+
+	LveShaderModule::~LveShaderModule() {
+		vkDestroyShaderModule(lveDevice.device(), shaderModule, allocationCallbacks(LveMemoryTag::Pipelines));
+	}
+
+	size_t LveShaderModule::hashCode(const std::vector<char>& code) {
+		return std::hash<std::string_view>{}(std::string_view(code.data(), code.size()));
+	}
+}
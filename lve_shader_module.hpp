@@ -0,0 +1,34 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+	// Owns one VkShaderModule built from a SPIR-V blob. Shared between pipelines via std::shared_ptr.
+	// Keeps the SPIR-V so deduplication can compare code rather than trust its hash.
+	class LveShaderModule {
+	public:
+		LveShaderModule(LveDevice& device, const std::vector<char>& code);
+		~LveShaderModule();
+
+		LveShaderModule(const LveShaderModule&) = delete;
+		LveShaderModule& operator=(const LveShaderModule&) = delete;
+
+		VkShaderModule getShaderModule() const { return shaderModule; }
+		// unique for the lifetime of the program, so unlike the address it is never reused by a later module
+		uint64_t getId() const { return id; }
+		const std::vector<char>& getCode() const { return code; }
+
+		static size_t hashCode(const std::vector<char>& code);
+
+	private:
+		LveDevice& lveDevice;
+		VkShaderModule shaderModule = VK_NULL_HANDLE;
+		uint64_t id;
+		std::vector<char> code;
+	};
+}
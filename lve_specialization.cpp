@@ -0,0 +1,19 @@
+#include "lve_specialization.hpp"
+
+namespace lve {
+	VkSpecializationInfo LveSpecializationConstants::getInfo() const {
+		VkSpecializationInfo info{};
+		info.mapEntryCount = static_cast<uint32_t>(entries.size());
+		info.pMapEntries = entries.data();
+		info.dataSize = data.size();
+		info.pData = data.data();
+		return info;
+	}
+
+	void LightingPermutation::apply(LveSpecializationConstants& constants) const {
+		constants
+			.set(SPEC_MAX_POINT_LIGHTS, static_cast<int32_t>(maxPointLights))
+			.set(SPEC_LIGHTING_MODEL, static_cast<int32_t>(lightingModel))
+			.set(SPEC_ALPHA_TEST, alphaTest);
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_frame_info.hpp"
+
+// std
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace lve {
+	// Typed specialization constants for one shader stage. Values are packed into a byte blob with one
+	// VkSpecializationMapEntry each; bools are widened to VkBool32 as SPIR-V requires.
+	class LveSpecializationConstants {
+	public:
+		template <typename T>
+		LveSpecializationConstants& set(uint32_t constantId, T value) {
+			static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+				"specialization constants must be scalars");
+			if constexpr (std::is_same<T, bool>::value) {
+				return setBytes(constantId, VkBool32{ value ? VK_TRUE : VK_FALSE });
+			}
+			else {
+				return setBytes(constantId, value);
+			}
+		}
+
+		bool empty() const { return entries.empty(); }
+		const std::vector<VkSpecializationMapEntry>& getEntries() const { return entries; }
+		const std::vector<uint8_t>& getData() const { return data; }
+
+		// The returned struct points into this object; it is only valid while this object is unchanged.
+		VkSpecializationInfo getInfo() const;
+
+	private:
+		template <typename T>
+		LveSpecializationConstants& setBytes(uint32_t constantId, const T& value) {
+			for (auto& entry : entries) {
+				if (entry.constantID == constantId) {
+					assert(entry.size == sizeof(T) && "Specialization constant redefined with a different size");
+					memcpy(data.data() + entry.offset, &value, sizeof(T));
+					return *this;
+				}
+			}
+			VkSpecializationMapEntry entry{};
+			entry.constantID = constantId;
+			entry.offset = static_cast<uint32_t>(data.size());
+			entry.size = sizeof(T);
+			entries.push_back(entry);
+			data.resize(data.size() + sizeof(T));
+			memcpy(data.data() + entry.offset, &value, sizeof(T));
+			return *this;
+		}
+
+		std::vector<VkSpecializationMapEntry> entries{};
+		std::vector<uint8_t> data{};
+	};
+
+	// constant_id values shared with the GLSL sources, e.g. in simple_shader.frag and bindless_shader.frag:
+	//   layout(constant_id = 0) const int MAX_POINT_LIGHTS = 10;
+	//   layout(constant_id = 1) const int LIGHTING_MODEL = 1;
+	//   layout(constant_id = 2) const bool ALPHA_TEST = false;
+	enum SpecializationConstantId : uint32_t {
+		SPEC_MAX_POINT_LIGHTS = 0,
+		SPEC_LIGHTING_MODEL = 1,
+		SPEC_ALPHA_TEST = 2,
+	};
+
+	enum class LightingModel : uint32_t {
+		Lambert = 0,
+		BlinnPhong = 1,
+	};
+
+	// One compile-time shader permutation. Each distinct value maps to its own cached pipeline, since
+	// the registry keys pipelines on the specialization data. The defaults match the shaders' own, so a
+	// default permutation behaves like the unspecialized shader but is still a separate pipeline.
+	struct LightingPermutation {
+		uint32_t maxPointLights = MAX_POINT_LIGHTS;
+		LightingModel lightingModel = LightingModel::BlinnPhong;
+		bool alphaTest = false;
+
+		void apply(LveSpecializationConstants& constants) const;
+	};
+}
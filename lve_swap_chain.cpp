@@ -1,7 +1,12 @@
 #include "lve_swap_chain.hpp"
 
+#include "lve_allocation_tracker.hpp"
+#include "lve_profiler.hpp"
+
 // std
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -11,19 +16,27 @@
 
 namespace lve {
 
-	LveSwapChain::LveSwapChain(LveDevice& deviceRef, VkExtent2D extent)
-		: device{ deviceRef }, windowExtent{ extent } {
+	LveSwapChain::LveSwapChain(LveDevice& deviceRef, VkExtent2D extent, const LveRendererConfig& config)
+		: device{ deviceRef }, windowExtent{ extent }, config{ config } {
 		init();
 	}
 
-	LveSwapChain::LveSwapChain(LveDevice& deviceRef, VkExtent2D extent, std::shared_ptr<LveSwapChain> previous)
-		: device{ deviceRef }, windowExtent{ extent }, oldSwapChain(previous) {
+	LveSwapChain::LveSwapChain(
+		LveDevice& deviceRef, VkExtent2D extent, const LveRendererConfig& config, std::shared_ptr<LveSwapChain> previous)
+		: device{ deviceRef }, windowExtent{ extent }, config{ config }, oldSwapChain(previous) {
 		init();
-		// clean up old swap chain as we are recreating it.
+		// frame slots index the renderer's command buffers and per-frame resources, which may still be in
+		// flight from the old swap chain, so keep waiting on the values it recorded instead of idling the device
+		frameTimelineValues = previous->frameTimelineValues;
+		lastSubmittedTimelineValue = previous->lastSubmittedTimelineValue;
+		currentFrame = previous->currentFrame % config.framesInFlight;
+		// drop our reference; the renderer keeps the old swap chain alive until the GPU is done with it
 		oldSwapChain = nullptr;
 	}
 
 	void LveSwapChain::init() {
+		assert(config.framesInFlight >= LveRendererConfig::MIN_FRAMES_IN_FLIGHT &&
+			config.framesInFlight <= LveRendererConfig::MAX_FRAMES_IN_FLIGHT && "Frames in flight out of range");
 		createSwapChain();
 		createImageViews();
 		createRenderPass();
@@ -34,42 +47,50 @@ namespace lve {
 
 	LveSwapChain::~LveSwapChain() {
 		for (auto imageView : swapChainImageViews) {
-			vkDestroyImageView(device.device(), imageView, nullptr);
+			vkDestroyImageView(device.device(), imageView, allocationCallbacks(LveMemoryTag::SwapChain));
 		}
 		swapChainImageViews.clear();
 
 		if (swapChain != nullptr) {
-			vkDestroySwapchainKHR(device.device(), swapChain, nullptr);
+			vkDestroySwapchainKHR(device.device(), swapChain, allocationCallbacks(LveMemoryTag::SwapChain));
 			swapChain = nullptr;
 		}
 
+		// headless images are owned by us rather than by a VkSwapchainKHR
+		for (size_t i = 0; i < offscreenImageMemorys.size(); i++) {
+			vkDestroyImage(device.device(), swapChainImages[i], allocationCallbacks(LveMemoryTag::SwapChain));
+			vkFreeMemory(device.device(), offscreenImageMemorys[i], allocationCallbacks(LveMemoryTag::SwapChain));
+		}
+
 		for (int i = 0; i < depthImages.size(); i++) {
-			vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-			vkDestroyImage(device.device(), depthImages[i], nullptr);
-			vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+			vkDestroyImageView(device.device(), depthImageViews[i], allocationCallbacks(LveMemoryTag::SwapChain));
+			vkDestroyImage(device.device(), depthImages[i], allocationCallbacks(LveMemoryTag::SwapChain));
+			vkFreeMemory(device.device(), depthImageMemorys[i], allocationCallbacks(LveMemoryTag::SwapChain));
 		}
 
 		for (auto framebuffer : swapChainFramebuffers) {
-			vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
+			vkDestroyFramebuffer(device.device(), framebuffer, allocationCallbacks(LveMemoryTag::SwapChain));
 		}
 
-		vkDestroyRenderPass(device.device(), renderPass, nullptr);
+		vkDestroyRenderPass(device.device(), renderPass, allocationCallbacks(LveMemoryTag::SwapChain));
 
 		// cleanup synchronization objects
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
-			vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(device.device(), inFlightFences[i], nullptr);
+		for (size_t i = 0; i < imageAvailableSemaphores.size(); i++) {
+			vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], allocationCallbacks(LveMemoryTag::SwapChain));
+			vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], allocationCallbacks(LveMemoryTag::SwapChain));
 		}
 	}
 
 	VkResult LveSwapChain::acquireNextImage(uint32_t* imageIndex) {
-		vkWaitForFences(
-			device.device(),
-			1,
-			&inFlightFences[currentFrame],
-			VK_TRUE,
-			std::numeric_limits<uint64_t>::max());
+		LVE_PROFILE_ZONE("LveSwapChain::acquireNextImage");
+		// wait for frame N - framesInFlight, the last submission that used this frame slot
+		device.waitForTimeline(frameTimelineValues[currentFrame]);
+
+		if (device.isHeadless()) {
+			// one offscreen image per frame in flight, so the timeline wait above already guards it
+			*imageIndex = static_cast<uint32_t>(currentFrame);
+			return VK_SUCCESS;
+		}
 
 		VkResult result = vkAcquireNextImageKHR(
 			device.device(),
@@ -82,40 +103,79 @@ namespace lve {
 		return result;
 	}
 
+	void LveSwapChain::addSubmitWait(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags stages) {
+		extraWaitSemaphores.push_back(semaphore);
+		extraWaitValues.push_back(value);
+		extraWaitStages.push_back(stages);
+	}
+
 	VkResult LveSwapChain::submitCommandBuffers(
 		const VkCommandBuffer* buffers, uint32_t* imageIndex) {
-		if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-			vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-		}
-		imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
-
+		// no per-image wait is needed: an image is only re-acquired after its present, which itself waited
+		// for the rendering that last wrote it (and headless images map 1:1 onto frame slots)
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-		VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = waitSemaphores;
-		submitInfo.pWaitDstStageMask = waitStages;
+		// headless frames have no acquire to wait on and no present to signal
+		uint32_t semaphoreCount = device.isHeadless() ? 0 : 1;
+
+		// the acquire first, then timeline waits added for this frame, e.g. async compute it consumes
+		std::vector<VkSemaphore> waitSemaphores{};
+		std::vector<VkPipelineStageFlags> waitStages{};
+		std::vector<uint64_t> waitValues{};
+		if (semaphoreCount > 0) {
+			waitSemaphores.push_back(imageAvailableSemaphores[currentFrame]);
+			waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+			waitValues.push_back(0);
+		}
+		waitSemaphores.insert(waitSemaphores.end(), extraWaitSemaphores.begin(), extraWaitSemaphores.end());
+		waitStages.insert(waitStages.end(), extraWaitStages.begin(), extraWaitStages.end());
+		waitValues.insert(waitValues.end(), extraWaitValues.begin(), extraWaitValues.end());
+		extraWaitSemaphores.clear();
+		extraWaitStages.clear();
+		extraWaitValues.clear();
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+		submitInfo.pWaitSemaphores = waitSemaphores.data();
+		submitInfo.pWaitDstStageMask = waitStages.data();
 
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = buffers;
 
-		VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-		submitInfo.signalSemaphoreCount = 1;
+		// the binary semaphore feeds the present; the timeline value marks the frame as done for everyone else
+		VkSemaphore signalSemaphores[] = { device.timeline(), renderFinishedSemaphores[currentFrame] };
+		uint64_t signalValues[] = { 0, 0 };
+		submitInfo.signalSemaphoreCount = 1 + semaphoreCount;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
-		if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) !=
-			VK_SUCCESS) {
+		VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
+		timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+		timelineInfo.pSignalSemaphoreValues = signalValues;
+		submitInfo.pNext = &timelineInfo;
+
+		// uploads on other threads share the queue and the timeline, so reserve the value and submit as one step
+		auto queueLock = device.lockGraphicsQueue();
+		uint64_t signalValue = device.nextTimelineValue();
+		signalValues[0] = signalValue;
+		if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
 			throw std::runtime_error("failed to submit draw command buffer!");
 		}
+		queueLock.unlock();
+		frameTimelineValues[currentFrame] = signalValue;
+		lastSubmittedTimelineValue = signalValue;
+
+		if (device.isHeadless()) {
+			currentFrame = (currentFrame + 1) % config.framesInFlight;
+			return VK_SUCCESS;
+		}
 
 		VkPresentInfoKHR presentInfo = {};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
 		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = signalSemaphores;
+		presentInfo.pWaitSemaphores = &renderFinishedSemaphores[currentFrame];
 
 		VkSwapchainKHR swapChains[] = { swapChain };
 		presentInfo.swapchainCount = 1;
@@ -123,21 +183,31 @@ namespace lve {
 
 		presentInfo.pImageIndices = imageIndex;
 
+		// the present queue is usually the graphics queue, which needs the same external synchronization
+		queueLock.lock();
 		auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+		queueLock.unlock();
 
-		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		currentFrame = (currentFrame + 1) % config.framesInFlight;
 
 		return result;
 	}
 
 	void LveSwapChain::createSwapChain() {
+		if (device.isHeadless()) {
+			createOffscreenImages();
+			return;
+		}
+
 		SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
 
 		VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
 		VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
 		VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
-		uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+		uint32_t imageCount = config.swapChainImageCount == 0
+			? swapChainSupport.capabilities.minImageCount + 1
+			: std::max(config.swapChainImageCount, swapChainSupport.capabilities.minImageCount);
 		if (swapChainSupport.capabilities.maxImageCount > 0 &&
 			imageCount > swapChainSupport.capabilities.maxImageCount) {
 			imageCount = swapChainSupport.capabilities.maxImageCount;
@@ -153,6 +223,11 @@ namespace lve {
 		createInfo.imageExtent = extent;
 		createInfo.imageArrayLayers = 1;
 		createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		// lets presented frames be read back when the surface allows it
+		readbackSupported = (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+		if (readbackSupported) {
+			createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		}
 
 		QueueFamilyIndices indices = device.findPhysicalQueueFamilies();
 		uint32_t queueFamilyIndices[] = { indices.graphicsFamily, indices.presentFamily };
@@ -176,7 +251,7 @@ namespace lve {
 
 		createInfo.oldSwapchain = oldSwapChain == nullptr ? VK_NULL_HANDLE : oldSwapChain->swapChain;
 
-		if (vkCreateSwapchainKHR(device.device(), &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
+		if (vkCreateSwapchainKHR(device.device(), &createInfo, allocationCallbacks(LveMemoryTag::SwapChain), &swapChain) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create swap chain!");
 		}
 
@@ -192,6 +267,42 @@ namespace lve {
 		swapChainExtent = extent;
 	}
 
+	void LveSwapChain::createOffscreenImages() {
+		swapChainImageFormat = device.findSupportedFormat(
+			{ VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM },
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT);
+		swapChainExtent = windowExtent;
+
+		swapChainImages.resize(config.framesInFlight);
+		offscreenImageMemorys.resize(config.framesInFlight);
+		readbackSupported = true;
+		for (size_t i = 0; i < swapChainImages.size(); i++) {
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent.width = swapChainExtent.width;
+			imageInfo.extent.height = swapChainExtent.height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = swapChainImageFormat;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			// transfer source so frames can be copied out for readback and image comparisons
+			imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.flags = 0;
+
+			device.createImageWithInfo(
+				imageInfo,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				swapChainImages[i],
+				offscreenImageMemorys[i]);
+		}
+	}
+
 	void LveSwapChain::createImageViews() {
 		swapChainImageViews.resize(swapChainImages.size());
 		for (size_t i = 0; i < swapChainImages.size(); i++) {
@@ -206,7 +317,7 @@ namespace lve {
 			viewInfo.subresourceRange.baseArrayLayer = 0;
 			viewInfo.subresourceRange.layerCount = 1;
 
-			if (vkCreateImageView(device.device(), &viewInfo, nullptr, &swapChainImageViews[i]) !=
+			if (vkCreateImageView(device.device(), &viewInfo, allocationCallbacks(LveMemoryTag::SwapChain), &swapChainImageViews[i]) !=
 				VK_SUCCESS) {
 				throw std::runtime_error("failed to create texture image view!");
 			}
@@ -236,7 +347,7 @@ namespace lve {
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		colorAttachment.finalLayout = device.isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 		VkAttachmentReference colorAttachmentRef = {};
 		colorAttachmentRef.attachment = 0;
@@ -259,6 +370,16 @@ namespace lve {
 		dependency.dstAccessMask =
 			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
+		// orders the final layout transition before transfers recorded after the pass, e.g. readback copies
+		VkSubpassDependency readbackDependency = {};
+		readbackDependency.srcSubpass = 0;
+		readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+		readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		std::array<VkSubpassDependency, 2> dependencies = { dependency, readbackDependency };
+
 		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
 		VkRenderPassCreateInfo renderPassInfo = {};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -266,18 +387,21 @@ namespace lve {
 		renderPassInfo.pAttachments = attachments.data();
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
 
-		if (vkCreateRenderPass(device.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+		if (vkCreateRenderPass(device.device(), &renderPassInfo, allocationCallbacks(LveMemoryTag::SwapChain), &renderPass) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create render pass!");
 		}
 	}
 
 	void LveSwapChain::createFramebuffers() {
-		swapChainFramebuffers.resize(imageCount());
-		for (size_t i = 0; i < imageCount(); i++) {
-			std::array<VkImageView, 2> attachments = { swapChainImageViews[i], depthImageViews[i] };
+		// depth belongs to the frame slot and color to the acquired image, so there is one framebuffer per pair
+		swapChainFramebuffers.resize(config.framesInFlight * imageCount());
+		for (size_t i = 0; i < swapChainFramebuffers.size(); i++) {
+			size_t frame = i / imageCount();
+			size_t image = i % imageCount();
+			std::array<VkImageView, 2> attachments = { swapChainImageViews[image], depthImageViews[frame] };
 
 			VkExtent2D swapChainExtent = getSwapChainExtent();
 			VkFramebufferCreateInfo framebufferInfo = {};
@@ -292,21 +416,38 @@ namespace lve {
 			if (vkCreateFramebuffer(
 				device.device(),
 				&framebufferInfo,
-				nullptr,
+				allocationCallbacks(LveMemoryTag::SwapChain),
 				&swapChainFramebuffers[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create framebuffer!");
 			}
 		}
 	}
 
+	VkImage LveSwapChain::getImage(int index) {
+		return swapChainImages[index];
+	}
+
+	bool LveSwapChain::supportsReadback() const {
+		return readbackSupported;
+	}
+
+	VkFramebuffer LveSwapChain::getFrameBuffer(int index) {
+		// only valid while recording: currentFrame advances at submit
+		return swapChainFramebuffers[currentFrame * imageCount() + index];
+	}
+
 	void LveSwapChain::createDepthResources() {
 		VkFormat depthFormat = findDepthFormat();
 		swapChainDepthFormat = depthFormat;
 		VkExtent2D swapChainExtent = getSwapChainExtent();
 
-		depthImages.resize(imageCount());
-		depthImageMemorys.resize(imageCount());
-		depthImageViews.resize(imageCount());
+		// depth is cleared on load and never stored, so it only has to outlive the frame that renders into it:
+		// one per frame in flight instead of one per swap chain image, and on tilers never backed by real memory
+		depthImages.resize(config.framesInFlight);
+		depthImageMemorys.resize(config.framesInFlight);
+		depthImageViews.resize(config.framesInFlight);
+		VkDeviceSize depthBytes = 0;
+		bool lazilyAllocated = false;
 
 		for (int i = 0; i < depthImages.size(); i++) {
 			VkImageCreateInfo imageInfo{};
@@ -320,16 +461,36 @@ namespace lve {
 			imageInfo.format = depthFormat;
 			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+			imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
 			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 			imageInfo.flags = 0;
 
-			device.createImageWithInfo(
-				imageInfo,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				depthImages[i],
-				depthImageMemorys[i]);
+			if (vkCreateImage(device.device(), &imageInfo, allocationCallbacks(LveMemoryTag::SwapChain), &depthImages[i]) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create image!");
+			}
+
+			VkMemoryRequirements memRequirements;
+			vkGetImageMemoryRequirements(device.device(), depthImages[i], &memRequirements);
+
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = memRequirements.size;
+			lazilyAllocated = device.tryFindMemoryType(
+				memRequirements.memoryTypeBits,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+				allocInfo.memoryTypeIndex);
+			if (!lazilyAllocated) {
+				allocInfo.memoryTypeIndex = device.findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			}
+
+			if (vkAllocateMemory(device.device(), &allocInfo, allocationCallbacks(LveMemoryTag::SwapChain), &depthImageMemorys[i]) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate image memory!");
+			}
+			if (vkBindImageMemory(device.device(), depthImages[i], depthImageMemorys[i], 0) != VK_SUCCESS) {
+				throw std::runtime_error("failed to bind image memory!");
+			}
+			depthBytes = memRequirements.size;
 
 			VkImageViewCreateInfo viewInfo{};
 			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -342,31 +503,32 @@ namespace lve {
 			viewInfo.subresourceRange.baseArrayLayer = 0;
 			viewInfo.subresourceRange.layerCount = 1;
 
-			if (vkCreateImageView(device.device(), &viewInfo, nullptr, &depthImageViews[i]) != VK_SUCCESS) {
+			if (vkCreateImageView(device.device(), &viewInfo, allocationCallbacks(LveMemoryTag::SwapChain), &depthImageViews[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create texture image view!");
 			}
 		}
+
+		constexpr double MIB = 1024.0 * 1024.0;
+		size_t savedImages = imageCount() > depthImages.size() ? imageCount() - depthImages.size() : 0;
+		std::cout << "Depth buffers: " << depthImages.size() << " x " << depthBytes / MIB << " MiB ("
+			<< (lazilyAllocated ? "lazily allocated" : "device local") << "), "
+			<< savedImages * depthBytes / MIB << " MiB saved over one per swap chain image" << std::endl;
 	}
 
 	void LveSwapChain::createSyncObjects() {
-		imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-		imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+		imageAvailableSemaphores.resize(config.framesInFlight);
+		renderFinishedSemaphores.resize(config.framesInFlight);
+		// one value per possible slot, so a later config with more frames in flight still sees older submissions
+		frameTimelineValues.assign(LveRendererConfig::MAX_FRAMES_IN_FLIGHT, 0);
 
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
-				VK_SUCCESS ||
-				vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) !=
+		for (size_t i = 0; i < config.framesInFlight; i++) {
+			if (vkCreateSemaphore(device.device(), &semaphoreInfo, allocationCallbacks(LveMemoryTag::SwapChain), &imageAvailableSemaphores[i]) !=
 				VK_SUCCESS ||
-				vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+				vkCreateSemaphore(device.device(), &semaphoreInfo, allocationCallbacks(LveMemoryTag::SwapChain), &renderFinishedSemaphores[i]) !=
+				VK_SUCCESS) {
 				throw std::runtime_error("failed to create synchronization objects for a frame!");
 			}
 		}
@@ -387,23 +549,29 @@ namespace lve {
 	VkPresentModeKHR LveSwapChain::chooseSwapPresentMode(
 		const std::vector<VkPresentModeKHR>& availablePresentModes) {
 		for (const auto& availablePresentMode : availablePresentModes) {
-			if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-				std::cout << "Present mode: Mailbox" << std::endl;
+			if (availablePresentMode == config.presentMode) {
+				std::cout << "Present mode: " << LveRendererConfig::presentModeName(availablePresentMode) << std::endl;
 				return availablePresentMode;
 			}
 		}
 
-		// for (const auto &availablePresentMode : availablePresentModes) { // faster but tearing
-		//   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-		//     std::cout << "Present mode: Immediate" << std::endl;
-		//     return availablePresentMode;
-		//   }
-		// }
-
-		std::cout << "Present mode: V-Sync" << std::endl;
+		std::cout << "Present mode: " << LveRendererConfig::presentModeName(config.presentMode)
+			<< " unavailable, using V-Sync" << std::endl;
 		return VK_PRESENT_MODE_FIFO_KHR;
 	}
 
+	uint32_t LveSwapChain::getFramesInFlight() const {
+		return config.framesInFlight;
+	}
+
+	size_t LveSwapChain::getCurrentFrame() const {
+		return currentFrame;
+	}
+
+	uint64_t LveSwapChain::getLastSubmittedTimelineValue() const {
+		return lastSubmittedTimelineValue;
+	}
+
 	VkExtent2D LveSwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
 		if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
 			return capabilities.currentExtent;
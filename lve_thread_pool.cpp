@@ -0,0 +1,48 @@
+#include "lve_thread_pool.hpp"
+
+#include "lve_profiler.hpp"
+
+// std
+#include <algorithm>
+
+namespace lve {
+	LveThreadPool::LveThreadPool(size_t threadCount) {
+		threadCount = std::max<size_t>(threadCount, 1);
+		workers.reserve(threadCount);
+		for (size_t i = 0; i < threadCount; i++) {
+			workers.emplace_back([this]() { workerLoop(); });
+		}
+	}
+
+	LveThreadPool::~LveThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		jobAvailable.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	size_t LveThreadPool::defaultThreadCount() {
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	void LveThreadPool::workerLoop() {
+		LVE_PROFILE_THREAD("LveThreadPool worker");
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+				if (jobs.empty()) {
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop();
+			}
+			job();
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// std
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lve {
+	// Fixed-size worker pool. Jobs run in submission order; the destructor drains the queue before joining.
+	class LveThreadPool {
+	public:
+		explicit LveThreadPool(size_t threadCount = defaultThreadCount());
+		~LveThreadPool();
+
+		LveThreadPool(const LveThreadPool&) = delete;
+		LveThreadPool& operator=(const LveThreadPool&) = delete;
+
+		template <typename F>
+		auto submit(F&& job) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+			using Result = std::invoke_result_t<std::decay_t<F>>;
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+			auto future = task->get_future();
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				jobs.emplace([task]() { (*task)(); });
+			}
+			jobAvailable.notify_one();
+			return future;
+		}
+
+		size_t threadCount() const { return workers.size(); }
+
+		static size_t defaultThreadCount();
+
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> workers{};
+		std::queue<std::function<void()>> jobs{};
+		std::mutex mutex;
+		std::condition_variable jobAvailable;
+		bool stopping = false;
+	};
+}
@@ -1,5 +1,7 @@
 #include "lve_window.hpp"
 
+#include "lve_allocation_tracker.hpp"
+
 namespace lve {
 	LveWindow::LveWindow(int w, int h, std::string t) : width(w), height(h), title(t){
 		initWindow();
@@ -30,7 +32,7 @@ namespace lve {
 	}
 
 	void LveWindow::createWindowSurface(VkInstance instance, VkSurfaceKHR* surface) {
-		if (glfwCreateWindowSurface(instance, window, nullptr, surface) != VK_SUCCESS) {
+		if (glfwCreateWindowSurface(instance, window, allocationCallbacks(LveMemoryTag::Device), surface) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create window surface!");
 		}
 	}
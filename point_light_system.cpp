@@ -1,6 +1,8 @@
 #pragma once
 
 #include "point_light_system.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_profiler.hpp"
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
@@ -18,12 +20,16 @@ namespace lve {
 		float radius;
 	};
 
-	PointLightSystem::PointLightSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice(device) {
+	PointLightSystem::PointLightSystem(LveDevice& device, LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice(device), pipelineRegistry(pipelineRegistry) {
 		createPipelineLayout(globalSetLayout);
-		createPipeline(renderPass);
+		createPipeline(pipelineRegistry, renderPass);
 	}
 	PointLightSystem::~PointLightSystem() {
-		vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr);
+		pipelineRegistry.releasePipelineLayout(pipelineLayout);
+		// a pipeline compile queued against the layout may not have run yet; the registry holds the queue until it has
+		lveDevice.deferDestruction([device = lveDevice.device(), layout = pipelineLayout]() {
+			vkDestroyPipelineLayout(device, layout, allocationCallbacks(LveMemoryTag::Pipelines));
+		});
 	}
 
 	void PointLightSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
@@ -40,12 +46,12 @@ namespace lve {
 		pipelineLayoutInfo.pSetLayouts = desciptorSetLayouts.data();
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, allocationCallbacks(LveMemoryTag::Pipelines), &pipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
 		}
 	}
 
-	void PointLightSystem::createPipeline(VkRenderPass renderPass) {
+	void PointLightSystem::createPipeline(LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass) {
 		assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 		PipelineConfigInfo pipelineConfig{};
 		LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
@@ -54,14 +60,14 @@ namespace lve {
       pipelineConfig.bindingDescriptions.clear();
 		pipelineConfig.renderPass = renderPass;
 		pipelineConfig.pipelineLayout = pipelineLayout;
-		lvePipeline = std::make_unique<LvePipeline>(
-			lveDevice,
+		lvePipeline = pipelineRegistry.requestPipeline(
 			"shaders/point_light.vert.spv",
 			"shaders/point_light.frag.spv",
 			pipelineConfig
 		);
 	}
 	void PointLightSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo) {
+		LVE_PROFILE_ZONE("PointLightSystem::update");
 		auto rotateLight = glm::rotate(glm::mat4(1.f), 0.5f * frameInfo.frameTime, { 0.f, -1.f, 0.f });
 		int lightIndex = 0;
 		for (auto& keyValue : frameInfo.gameObjects) {
@@ -77,14 +83,20 @@ namespace lve {
 		}
 		ubo.numPointLights = lightIndex;
 	}
-	void PointLightSystem::render(FrameInfo& frameInfo) {
+	std::map<float, LveGameObject::id_t> PointLightSystem::sortByDistance(const LveGameObject::Map& gameObjects, const glm::vec3& cameraPosition) {
 		std::map<float, LveGameObject::id_t> sortedPointLightsToCameraDistance;
-		for (auto& keyValue : frameInfo.gameObjects) {
+		for (auto& keyValue : gameObjects) {
 			auto& gameObject = keyValue.second;
 			if (gameObject.pointLight == nullptr) continue;
-			float distance = glm::dot(frameInfo.camera.getPosition() - gameObject.transform.translation, frameInfo.camera.getPosition() - gameObject.transform.translation);
+			float distance = glm::dot(cameraPosition - gameObject.transform.translation, cameraPosition - gameObject.transform.translation);
 			sortedPointLightsToCameraDistance[distance] = gameObject.getId();
 		}
+		return sortedPointLightsToCameraDistance;
+	}
+
+	void PointLightSystem::render(FrameInfo& frameInfo) {
+		LVE_PROFILE_ZONE("PointLightSystem::render");
+		auto sortedPointLightsToCameraDistance = sortByDistance(frameInfo.gameObjects, frameInfo.camera.getPosition());
 
 		lvePipeline->bind(frameInfo.commandBuffer);
 
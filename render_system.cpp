@@ -1,6 +1,8 @@
 #pragma once
 
 #include "render_system.hpp"
+#include "lve_allocation_tracker.hpp"
+#include "lve_profiler.hpp"
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
@@ -16,12 +18,20 @@ namespace lve {
 		glm::mat4 normalMatrix{1.0f};
 	};
 
-	RenderSystem::RenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice(device) {
+	RenderSystem::RenderSystem(LveDevice& device, LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, const LightingPermutation& permutation) : lveDevice(device), pipelineRegistry(pipelineRegistry) {
 		createPipelineLayout(globalSetLayout);
-		createPipeline(renderPass);
+		createPipeline(pipelineRegistry, renderPass, &permutation);
+	}
+	RenderSystem::RenderSystem(LveDevice& device, LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice(device), pipelineRegistry(pipelineRegistry) {
+		createPipelineLayout(globalSetLayout);
+		createPipeline(pipelineRegistry, renderPass, nullptr);
 	}
 	RenderSystem::~RenderSystem() {
-		vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr);
+		pipelineRegistry.releasePipelineLayout(pipelineLayout);
+		// a pipeline compile queued against the layout may not have run yet; the registry holds the queue until it has
+		lveDevice.deferDestruction([device = lveDevice.device(), layout = pipelineLayout]() {
+			vkDestroyPipelineLayout(device, layout, allocationCallbacks(LveMemoryTag::Pipelines));
+		});
 	}
 
 	void RenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
@@ -38,19 +48,20 @@ namespace lve {
 		pipelineLayoutInfo.pSetLayouts = desciptorSetLayouts.data();
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, allocationCallbacks(LveMemoryTag::Pipelines), &pipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
 		}
 	}
 
-	void RenderSystem::createPipeline(VkRenderPass renderPass) {
+	void RenderSystem::createPipeline(LvePipelineRegistry& pipelineRegistry, VkRenderPass renderPass, const LightingPermutation* permutation) {
 		assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 		PipelineConfigInfo pipelineConfig{};
 		LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
+		// without a permutation the shader runs with the constant defaults compiled into its SPIR-V
+		if (permutation != nullptr) permutation->apply(pipelineConfig.fragSpecialization);
 		pipelineConfig.renderPass = renderPass;
 		pipelineConfig.pipelineLayout = pipelineLayout;
-		lvePipeline = std::make_unique<LvePipeline>(
-			lveDevice,
+		lvePipeline = pipelineRegistry.requestPipeline(
 			"shaders/simple_shader.vert.spv",
 			"shaders/simple_shader.frag.spv",
 			pipelineConfig
@@ -58,6 +69,7 @@ namespace lve {
 	}
 
 	void RenderSystem::renderGameObjects(FrameInfo& frameInfo) {
+		LVE_PROFILE_ZONE("RenderSystem::renderGameObjects");
 		lvePipeline->bind(frameInfo.commandBuffer);
 
 		vkCmdBindDescriptorSets(
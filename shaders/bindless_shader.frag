@@ -0,0 +1,71 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec3 fragPosWorld;
+layout(location = 2) in vec3 fragNormalWorld;
+layout(location = 3) in vec2 fragUv;
+layout(location = 4) flat in uint fragTextureHandle;
+layout(location = 5) flat in uint fragSamplerHandle;
+
+layout(location = 0) out vec4 outColor;
+
+struct PointLight {
+	vec4 position;
+	vec4 color;
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+	mat4 projection;
+	mat4 view;
+	mat4 invView;
+	vec4 ambientLightColor;
+	PointLight pointLights[10];
+	int numLights;
+} ubo;
+
+layout(set = 1, binding = 1) uniform texture2D textures[];
+layout(set = 1, binding = 2) uniform sampler samplers[];
+
+// set from LightingPermutation (lve_specialization.hpp); the defaults give the unspecialized shader
+layout(constant_id = 0) const int MAX_POINT_LIGHTS = 10;
+layout(constant_id = 1) const int LIGHTING_MODEL = 1;  // 0 Lambert, 1 Blinn-Phong
+layout(constant_id = 2) const bool ALPHA_TEST = false;
+
+const uint INVALID_HANDLE = 0xFFFFFFFFu;
+
+void main() {
+	vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
+	vec3 specularLight = vec3(0.0);
+	vec3 surfaceNormal = normalize(fragNormalWorld);
+
+	vec3 cameraPosWorld = ubo.invView[3].xyz;
+	vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
+
+	// a constant trip count lets the compiler unroll the loop; the scene may still have fewer lights
+	for (int i = 0; i < MAX_POINT_LIGHTS; i++) {
+		if (i >= ubo.numLights) break;
+		PointLight light = ubo.pointLights[i];
+		vec3 directionToLight = light.position.xyz - fragPosWorld;
+		float attenuation = 1.0 / dot(directionToLight, directionToLight);
+		directionToLight = normalize(directionToLight);
+
+		float cosAngIncidence = max(dot(surfaceNormal, directionToLight), 0);
+		vec3 intensity = light.color.xyz * light.color.w * attenuation;
+		diffuseLight += intensity * cosAngIncidence;
+
+		if (LIGHTING_MODEL == 0) continue;
+		vec3 halfAngle = normalize(directionToLight + viewDirection);
+		float blinnTerm = pow(clamp(dot(surfaceNormal, halfAngle), 0, 1), 512.0);
+		specularLight += intensity * blinnTerm;
+	}
+
+	vec3 albedo = fragColor;
+	if (fragTextureHandle != INVALID_HANDLE && fragSamplerHandle != INVALID_HANDLE) {
+		// handles vary per object within a subgroup, so the index must be marked non-uniform
+		vec4 texel = texture(sampler2D(textures[nonuniformEXT(fragTextureHandle)], samplers[nonuniformEXT(fragSamplerHandle)]), fragUv);
+		if (ALPHA_TEST && texel.a < 0.5) discard;
+		albedo *= texel.rgb;
+	}
+	outColor = vec4(diffuseLight * albedo + specularLight * fragColor, 1.0);
+}
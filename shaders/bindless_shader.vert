@@ -0,0 +1,57 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+layout(location = 2) in vec3 normal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+layout(location = 3) out vec2 fragUv;
+layout(location = 4) flat out uint fragTextureHandle;
+layout(location = 5) flat out uint fragSamplerHandle;
+
+struct PointLight {
+	vec4 position;
+	vec4 color;
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+	mat4 projection;
+	mat4 view;
+	mat4 invView;
+	vec4 ambientLightColor;
+	PointLight pointLights[10];
+	int numLights;
+} ubo;
+
+struct ObjectData {
+	mat4 modelMatrix;
+	mat4 normalMatrix;
+	uint textureHandle;
+	uint samplerHandle;
+};
+
+layout(set = 1, binding = 0) readonly buffer ObjectBuffer {
+	ObjectData objects[];
+} objectBuffers[];
+
+layout(push_constant) uniform Push {
+	uint objectBufferHandle;
+} push;
+
+void main() {
+	// firstInstance carries the object's slot, and the buffer handle is uniform across the draw
+	ObjectData object = objectBuffers[push.objectBufferHandle].objects[gl_InstanceIndex];
+
+	vec4 positionWorld = object.modelMatrix * vec4(position, 1.0);
+	gl_Position = ubo.projection * ubo.view * positionWorld;
+	fragNormalWorld = normalize(mat3(object.normalMatrix) * normal);
+	fragPosWorld = positionWorld.xyz;
+	fragColor = color;
+	fragUv = uv;
+	fragTextureHandle = object.textureHandle;
+	fragSamplerHandle = object.samplerHandle;
+}
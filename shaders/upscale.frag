@@ -0,0 +1,36 @@
+#version 450
+
+layout(location = 0) in vec2 fragUv;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D sceneColor;
+
+layout(push_constant) uniform Push {
+	// rendered region of the target in uv, and the last bilinear-safe coordinate inside it
+	vec2 uvScale;
+	vec2 uvMax;
+	vec2 texelSize;
+	float sharpness;
+} push;
+
+vec3 sampleScene(vec2 uv) {
+	return texture(sceneColor, clamp(uv, 0.5 * push.texelSize, push.uvMax)).rgb;
+}
+
+void main() {
+	vec2 uv = fragUv * push.uvScale;
+	vec3 color = sampleScene(uv);
+
+	if (push.sharpness > 0.0) {
+		// unsharp mask over the four neighbours one source texel away
+		vec3 neighbours =
+			sampleScene(uv + vec2(push.texelSize.x, 0.0)) +
+			sampleScene(uv - vec2(push.texelSize.x, 0.0)) +
+			sampleScene(uv + vec2(0.0, push.texelSize.y)) +
+			sampleScene(uv - vec2(0.0, push.texelSize.y));
+		color = max(color + push.sharpness * (4.0 * color - neighbours), vec3(0.0));
+	}
+
+	outColor = vec4(color, 1.0);
+}